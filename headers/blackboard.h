@@ -0,0 +1,76 @@
+// blackboard.h
+// Blackboard state and event handling of the server (B), free of any drawing
+//   - Key handling (force accumulation, pause, reset, brake, quit)
+//   - State ticks from D (target hits, lifetime aging, force re-send)
+//   - Acceptance of obstacle / target batches from O and T
+// Used by both the ncurses UI and the headless mode.
+// ======================================================================
+
+#ifndef BLACKBOARD_H
+#define BLACKBOARD_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "messages.h"
+#include "params.h"
+#include "shm_ipc.h"   // ForceLink
+#include "obsgrid.h"   // ObsGrid
+#include "repfield.h"  // RepField
+
+// World model owned by B.
+typedef struct {
+    ForceStateMsg cur_force;          // accumulated user force
+    DroneStateMsg cur_state;          // newest drone state from D
+    char          last_key;           // last key received from I
+    bool          paused;
+
+    // Scoring
+    int score;
+    int targets_collected;
+    int last_hit_step;                // -1 until the first hit
+    int step_counter;                 // state updates while running
+    int swarm_hits;                   // targets collected by swarm drones (swarm=N)
+
+    // Active obstacles for the repulsion sum, rebuilt on each batch and expiry
+    ObsGrid obs_grid;
+    // Repulsion sampled from obs_grid, resampled after each rebuild
+    RepField rep_field;
+
+    // Watchdog banner
+    int wd_warning_active;            // warning state ON/OFF
+    int wd_blink_phase;               // 0 or 1 (visible / invisible)
+} Blackboard;
+
+// Resets the blackboard to its start-up state.
+void bb_init(Blackboard *bb);
+
+// Releases what the blackboard allocated (obstacle grid and field).
+void bb_free(Blackboard *bb);
+
+// Applies one key from I. Returns true if the key requests quit.
+bool bb_handle_key(Blackboard *bb, char key,
+                   const SimParams *params, const ForceLink *link, FILE *logfile);
+
+// Applies one state tick from D: hit detection, lifetime aging and force re-send.
+// Returns the number of targets collected by this tick.
+// Logging is binary only (blog.h): this runs on every tick.
+int  bb_handle_state(Blackboard *bb, const DroneStateMsg *s,
+                     const SimParams *params, const ForceLink *link);
+
+// Hit-tests n swarm drones (positions x[], y[]) against the active targets
+// (ignored while paused). Returns the number of targets collected.
+int  bb_handle_swarm(Blackboard *bb, const double *x, const double *y, int n,
+                     const SimParams *params);
+
+// Filters a new obstacle batch and stores the accepted ones in free slots of
+// g_obs_pool, next to the live ones (ignored while paused).
+void bb_accept_obstacles(Blackboard *bb, const ObstacleSetMsg *msg,
+                         const SimParams *params, FILE *logfile);
+
+// Filters a new target batch and stores the accepted ones in free slots of
+// g_tgt_pool, next to the live ones (ignored while paused).
+void bb_accept_targets(Blackboard *bb, const TargetSetMsg *msg,
+                       const SimParams *params, FILE *logfile);
+
+#endif // BLACKBOARD_H
@@ -0,0 +1,193 @@
+// blog.h
+// Asynchronous binary logger ("blog"), one instance per process
+//   - Hot paths append fixed-size binary records (timestamp, type, payload)
+//     to a lock-free single-producer ring: a memcpy and two atomic stores,
+//     no text formatting and no syscalls
+//   - A background writer thread drains the ring, encodes the records
+//     compactly and writes them to logs/<name>.blog with large write() calls
+//   - If the ring is full the record is dropped and counted, the hot path
+//     never waits for the disk
+// Cold-path messages (start-up, errors, pause, ...) stay in the text logs.
+// What is logged is set per process and per category by the log_* keys of
+// params.txt (blog_configure); text call sites test BLOG_ON() themselves.
+// `make logdecode` builds the offline decoder (text or CSV).
+//
+// ---------------- On-disk format (version 2) ----------------
+// All integers little-endian, doubles IEEE-754 binary64 (full precision).
+//
+//   BlogFileHeader                  fixed part, see below
+//   char params[params_len]         params snapshot, "key=value\n" lines
+//   record*                         until end of file
+//
+// Record:
+//   varint  dt_ns     ns since the previous record (first: since t0_ns),
+//                     LEB128 (7 bits per byte, high bit = more bytes)
+//   u8      type      BLOG_*
+//   u8      len       payload length in bytes (<= BLOG_PAYLOAD_MAX)
+//   u8      mask      bit w set = 8-byte word w of the payload is stored
+//   u8[8]*  words     the stored words, in increasing w
+// Words whose bit is clear are equal to the same word of the previous
+// record of the same type (all zero before the first one). Steady values
+// (force while no key is pressed, a parked drone) thus cost 4-6 bytes.
+// ======================================================================
+
+#ifndef BLOG_H
+#define BLOG_H
+
+#include <stdint.h>
+
+#include "messages.h"
+#include "params.h"
+
+#define BLOG_MAGIC          "DBLG"
+#define BLOG_FORMAT_VERSION 2
+
+// Record types
+enum {
+    BLOG_KEY       = 1,   // key applied by B             (BlogKeyRec)
+    BLOG_STATE     = 2,   // drone state (B: received, D: produced) (BlogStateRec)
+    BLOG_FORCE     = 3,   // force sent from B to D       (BlogForceRec)
+    BLOG_HIT       = 4,   // targets collected            (BlogHitRec)
+    BLOG_OBS_BATCH = 5,   // obstacle batch from O        (BlogBatchRec)
+    BLOG_OBS_ITEM  = 6,   // one accepted obstacle, follows its batch (BlogItemRec)
+    BLOG_TGT_BATCH = 7,   // target batch from T          (BlogBatchRec)
+    BLOG_TGT_ITEM  = 8,   // one accepted target, follows its batch   (BlogItemRec)
+    BLOG_WATCHDOG  = 9,   // watchdog event seen by B     (BlogWatchdogRec)
+    BLOG_TYPE_COUNT
+};
+
+// Why a force was sent (BlogForceRec.reason)
+enum {
+    BLOG_REASON_INIT  = 0,
+    BLOG_REASON_KEY   = 1,
+    BLOG_REASON_STATE = 2,
+};
+
+// Watchdog events (BlogWatchdogRec.event)
+enum {
+    BLOG_WD_WARNING = 1,   // SIGUSR2 received
+    BLOG_WD_RESUMED = 2,   // heartbeat back after a warning
+    BLOG_WD_STOP    = 3,   // SIGTERM received
+};
+
+// Largest payload a record can carry (bytes): 8 words, one mask byte.
+#define BLOG_PAYLOAD_MAX 64
+
+// One ring slot (in memory only; see the on-disk format above).
+typedef struct {
+    uint64_t t_ns;                      // CLOCK_MONOTONIC
+    uint16_t type;                      // BLOG_*
+    uint16_t len;                       // payload bytes used
+    uint32_t reserved;
+    uint8_t  payload[BLOG_PAYLOAD_MAX];
+} BlogRecord;
+
+// PIDs of the whole process tree (0 = unknown to the writer).
+typedef struct {
+    int32_t pid_B, pid_I, pid_D, pid_O, pid_T, pid_W;
+} BlogPids;
+
+// Fixed part of the file header.
+typedef struct {
+    char     magic[4];      // "DBLG"
+    uint16_t version;       // BLOG_FORMAT_VERSION
+    uint16_t reserved;
+    char     process[16];   // "server", "dynamics", ...
+    int32_t  pid;           // writing process
+    BlogPids pids;
+    uint64_t t0_ns;         // CLOCK_MONOTONIC at open (record time base)
+    int64_t  t0_unix_ns;    // CLOCK_REALTIME at open
+    uint32_t params_len;    // bytes of params text that follow
+    uint32_t reserved2;
+} BlogFileHeader;
+
+// Payloads (padding is zeroed by the helpers so unchanged words compare equal)
+typedef struct {
+    double  x, y;       // position
+    double  vx, vy;     // velocity (the stamp of DroneStateMsg is not logged)
+} BlogStateRec;
+
+typedef struct {
+    char    key;
+    uint8_t ignored;    // 1 = directional key dropped while paused
+    uint8_t pad[6];
+    double  Fx, Fy;     // accumulated user force after the key
+} BlogKeyRec;
+
+typedef struct {
+    double  user_Fx, user_Fy;   // user force
+    double  Px, Py;             // obstacle repulsion vector
+    double  Fx, Fy;             // force actually sent
+    uint8_t reason;             // BLOG_REASON_*
+    char    best_key;           // virtual key chosen for P ('-' if none)
+    int16_t n_steps;            // virtual key steps
+} BlogForceRec;
+
+typedef struct {
+    int32_t hits;
+    int32_t score;
+    int32_t step;
+} BlogHitRec;
+
+typedef struct {
+    int32_t requested;   // entities in the message
+    int32_t accepted;    // entities kept (as many *_ITEM records follow)
+    int32_t ignored;     // 1 = whole batch dropped (paused)
+} BlogBatchRec;
+
+typedef struct {
+    double  x, y;
+    int32_t life_steps;
+} BlogItemRec;
+
+typedef struct {
+    int32_t event;       // BLOG_WD_*
+    int32_t pad;
+    double  hb_age;      // seconds since the last state from D
+} BlogWatchdogRec;
+
+// ---------------- Log levels and sampling ----------------
+// Per-process copies of this process' row of LogParams (params.h), set by
+// blog_configure(). A disabled category costs one load and one compare.
+extern unsigned char g_blog_level[LOG_CAT_COUNT];
+extern int           g_blog_every[LOG_CAT_COUNT];
+extern int           g_blog_count[LOG_CAT_COUNT];
+
+// True if category cat is logged at level lvl (LOG_INFO / LOG_DEBUG) here.
+#define BLOG_ON(cat, lvl)  (g_blog_level[(cat)] >= (lvl))
+
+// True for one call in every log_sample_<cat> calls (always true when N = 1).
+static inline int blog_sample(int cat) {
+    if (++g_blog_count[cat] < g_blog_every[cat]) return 0;
+    g_blog_count[cat] = 0;
+    return 1;
+}
+
+// Selects the log levels of process proc (LOG_PROC_*). Call once, after fork().
+void blog_configure(int proc, const LogParams *lp);
+
+// Opens logs/<name>.blog, writes the header and starts the writer thread.
+// Call once per process, after fork(). Returns 0 or -1 (logging then stays off).
+int  blog_open(const char *name, const BlogPids *pids, const SimParams *params);
+
+// Drains the ring, writes the rest and joins the writer thread.
+void blog_close(void);
+
+// Appends one record (hot path). No-op when the logger is not open.
+void blog_record(uint16_t type, const void *payload, uint16_t len);
+
+// Records dropped because the ring was full.
+uint64_t blog_dropped(void);
+
+// Typed helpers for the hot paths. Each one returns at once when its
+// category is below LOG_INFO; states and forces are also sampled.
+void blog_state(const DroneStateMsg *s);
+void blog_key(char key, int ignored, double Fx, double Fy);
+void blog_force(int reason, const ForceStateMsg *user, double Px, double Py,
+                char best_key, int n_steps, const ForceStateMsg *out);
+void blog_hit(int hits, int score, int step);
+void blog_batch(int type, int requested, int accepted, int ignored);
+void blog_item(int type, double x, double y, int life_steps);
+void blog_watchdog(int event, double hb_age);
+
+#endif // BLOG_H
@@ -6,13 +6,26 @@
 #ifndef DYNAMICS_H
 #define DYNAMICS_H
 
+#include <stdbool.h>
+
 #include "params.h"
+#include "shm_ipc.h"
+#include "swarm.h"
+#include "heartbeat.h"
 
 // Runs the dynamics process:
 //   - Reads ForceStateMsg from force_fd (from B)
 //   - Integrates dynamics
 //   - Sends DroneStateMsg to state_fd (to B)
-void run_dynamics_process(int force_fd, int state_fd, SimParams params);
+//   - ipc != NULL: exchanges force/state through the shared mailbox instead
+//   - lockstep   : answers numbered StepRequestMsg with StepReplyMsg, one dt
+//                  each and no sleeping (pipes only, ipc must be NULL)
+//   - swarm != NULL: also integrates params.swarm drones and publishes their
+//                  positions in the shared buffer before each state
+//   - hb         : shared heartbeat counters, one beat per step (watched by W
+//                  in real time only: in lockstep B paces D)
+void run_dynamics_process(int force_fd, int state_fd, SimParams params, ShmIpc *ipc,
+                          bool lockstep, SwarmBuf *swarm, HeartbeatBoard *hb);
 
 #endif // DYNAMICS_H
 
@@ -0,0 +1,71 @@
+// heartbeat.h
+// Shared heartbeat counters of B, I, D, O and T, read by the watchdog (W)
+//   - One counter per process, each on its own cache line: a process only
+//     ever writes its own line, so beating is one relaxed store with no
+//     syscall, no signal and no false sharing with the others
+//   - W snapshots every counter on its own timer; a counter that stops
+//     moving is a process that stopped running
+//   - Processes that wait on input (I on stdin, O and T between batches)
+//     wake every HB_IDLE_BEAT_NS to beat, so a long wait does not look like
+//     a hang
+//   - `watched` says whether W should expect beats: a process sets it once
+//     it beats on its own clock and clears it before a normal exit (D in
+//     lockstep is paced by B and stays unwatched)
+//   - Anonymous shared mapping created by main before fork()
+// ======================================================================
+
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Period of the beats of a waiting process
+#define HB_IDLE_BEAT_NS 500000000ull   // 0.5 s
+
+// Owners of the counters
+enum {
+    HB_B,
+    HB_I,
+    HB_D,
+    HB_O,
+    HB_T,
+    HB_COUNT
+};
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t beats;     // written by the owner only
+    _Atomic uint32_t              watched;   // 1 = W checks this counter
+} HbSlot;
+
+typedef struct {
+    HbSlot slot[HB_COUNT];
+} HeartbeatBoard;
+
+_Static_assert(sizeof(HbSlot) == 64, "one heartbeat counter per cache line");
+
+// Creates the shared counters (all zero, unwatched). Returns NULL on failure.
+HeartbeatBoard *hb_create(void);
+
+// Unmaps them.
+void hb_destroy(HeartbeatBoard *hb);
+
+// One-letter name of an owner ("B", "I", ...).
+const char *hb_name(int who);
+
+// Bumps the owner's counter (hb may be NULL).
+static inline void hb_beat(HeartbeatBoard *hb, int who) {
+    if (!hb) return;
+    _Atomic uint64_t *c = &hb->slot[who].beats;
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+// Starts (on=true) or stops W's checks of the owner's counter.
+void hb_watch(HeartbeatBoard *hb, int who, bool on);
+
+// Sleeps sec seconds, beating every HB_IDLE_BEAT_NS.
+void hb_sleep(HeartbeatBoard *hb, int who, unsigned sec);
+
+#endif // HEARTBEAT_H
@@ -0,0 +1,46 @@
+// histogram.h
+// Log-linear latency histogram (HDR-style) for nanosecond values
+//   - Bucket = (power of two, one of HIST_SUB linear sub-buckets), so the
+//     relative error of a percentile is at most 1 / HIST_SUB (~3 %)
+//   - Recording is a few integer ops and one increment: no allocation,
+//     no floating point, safe on hot paths
+//   - Fixed size (HIST_BUCKETS counters), can live in a struct or on shm
+// ======================================================================
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define HIST_SUB_BITS 5                          // 32 sub-buckets per power of two
+#define HIST_SUB      (1u << HIST_SUB_BITS)
+#define HIST_BUCKETS  ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+typedef struct {
+    uint64_t count;
+    uint64_t min, max;
+    uint64_t sum;                       // for the mean (wraps after ~584 years of ns)
+    uint32_t bucket[HIST_BUCKETS];
+} Histogram;
+
+// Empties the histogram.
+void     hist_reset(Histogram *h);
+
+// Records one value (ns).
+void     hist_record(Histogram *h, uint64_t v);
+
+// Adds every sample of src into dst.
+void     hist_merge(Histogram *dst, const Histogram *src);
+
+// Returns the value at percentile p (0..100), 0 if empty. Upper bucket edge,
+// clamped to the recorded max.
+uint64_t hist_percentile(const Histogram *h, double p);
+
+// Mean value (ns), 0 if empty.
+double   hist_mean(const Histogram *h);
+
+// Prints "n=.. min=.. p50=.. p90=.. p99=.. p99.9=.. max=.." in microseconds.
+void     hist_print_us(FILE *out, const char *label, const Histogram *h);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,49 @@
+// integrator.h
+// Time integration of the drone dynamics (used by D)
+//   M * dv/dt = F_user + P_wall(x) - K * v,    dx/dt = v
+//   - The user force from B is held constant over one dt
+//   - The wall repulsion P_wall is re-evaluated at every sub-step
+//     (and at every RK stage): it is the stiff part near the walls
+//   - params->integrator selects the scheme, params->substeps splits dt
+//     into that many equal internal steps (one message per dt either way)
+//   - INTEG_ADAPTIVE picks its internal steps from an embedded error
+//     estimate instead: one step per dt in open space, short steps inside
+//     the wall clearance. Steps never cross a dt boundary, so the state is
+//     still produced exactly every dt.
+// ======================================================================
+
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "messages.h"
+#include "params.h"
+
+#include <stdint.h>
+
+// Per-process integrator state and counters (one per D).
+typedef struct {
+    double   h;           // next internal step of the adaptive scheme (carried across dt)
+
+    // First-same-as-last stage of the adaptive scheme: derivative at the
+    // end of the last step, reused when the next dt starts from that state
+    // under the same force
+    int           fsal_valid;
+    DroneStateMsg fsal_s;
+    DroneStateMsg fsal_k;
+    ForceStateMsg fsal_f;
+
+    uint64_t steps;       // accepted internal steps
+    uint64_t rejected;    // rejected internal steps (adaptive)
+    uint64_t evals;       // force evaluations
+    double   h_min_used;  // smallest accepted internal step (adaptive)
+} IntegState;
+
+// Resets st for params (first adaptive step = params->dt).
+void integ_init(IntegState *st, const SimParams *params);
+
+// Advances s by one params->dt under the user force f (f->reset is ignored).
+// st may be NULL (no counters, adaptive step restarts from dt).
+void integrate_step(DroneStateMsg *s, const ForceStateMsg *f, const SimParams *params,
+                    IntegState *st);
+
+#endif // INTEGRATOR_H
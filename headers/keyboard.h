@@ -5,9 +5,14 @@
 #ifndef KEYBOARD_H
 #define KEYBOARD_H
 
+#include "shm_ipc.h"
+#include "heartbeat.h"
+
 // Runs the keyboard process:
 //   - Reads from stdin
 //   - Sends KeyMsg to B via write_fd
-void run_keyboard_process(int write_fd);
+//   - ipc != NULL: pushes keys into the shared ring instead (write_fd then only signals EOF)
+//   - Beats its counter in hb at least every HB_IDLE_BEAT_NS while waiting
+void run_keyboard_process(int write_fd, ShmIpc *ipc, HeartbeatBoard *hb);
 
 #endif // KEYBOARD_H
@@ -0,0 +1,92 @@
+// latency.h
+// End-to-end latency and sequence checks of B, from the message stamps
+// (MsgStamp in messages.h)
+//   - Per hop, one HDR-style histogram (histogram.h):
+//       I->B        key read by I          -> key taken by B
+//       B->D        force sent by B        -> force first used by D
+//       D->B        state sent by D        -> state taken by B
+//       key->state  key read by I          -> first state B takes that was
+//                                             integrated with the force the
+//                                             key produced
+//   - Per stream (keys, forces as seen through state.stamp.ref, states), the
+//     sequence numbers are checked: a jump forward counts the skipped
+//     numbers as missed, a step backwards counts as reordered. On the
+//     latest-value links (shm mailbox, lockstep latch) a newer message
+//     overwrites an unread one by design, so missed forces / states there
+//     are superseded rather than lost
+//   - All times are CLOCK_MONOTONIC, which is the same clock in every process
+//   - Dumped to B's log on exit and on SIGUSR1
+// ======================================================================
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "histogram.h"
+#include "messages.h"
+
+// Keys applied by B whose first affected state has not arrived yet
+#define LAT_PENDING_CAP 64
+
+// Returns CLOCK_MONOTONIC in nanoseconds.
+static inline uint64_t lat_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Sequence check of one stream.
+typedef struct {
+    uint32_t last;        // highest seq seen (0 = none yet)
+    uint64_t received;    // stamped messages seen
+    uint64_t missed;      // seq numbers skipped over
+    uint64_t reordered;   // messages older than one already seen
+} SeqTrack;
+
+// One applied key waiting for its first affected state.
+typedef struct {
+    uint32_t force_seq;   // first force sent after the key
+    uint64_t key_t_ns;    // when I read the key
+} LatPending;
+
+typedef struct {
+    Histogram  i_to_b;
+    Histogram  b_to_d;
+    Histogram  d_to_b;
+    Histogram  key_to_state;
+
+    SeqTrack   keys;
+    SeqTrack   forces;    // from state.stamp.ref: forces D integrated with
+    SeqTrack   states;
+
+    LatPending pending[LAT_PENDING_CAP];   // FIFO, force_seq non-decreasing
+    int        pending_head, pending_count;
+    uint64_t   pending_dropped;            // keys not tracked (FIFO full)
+} LatencyStats;
+
+// Empties every histogram and counter.
+void lat_init(LatencyStats *ls);
+
+// Checks seq against the stream. Returns 1 if it is newer than all before,
+// 0 if it repeats or goes back (and 0 for an unstamped seq of 0).
+int  seq_track(SeqTrack *t, uint32_t seq);
+
+// Key km from I taken by B at now_ns (I->B and the key sequence).
+void lat_key_received(LatencyStats *ls, const KeyMsg *km, uint64_t now_ns);
+
+// Key km made B send a new force: force_seq is the first one sent for it.
+// The next state integrated with force_seq or a later force closes it.
+void lat_key_applied(LatencyStats *ls, const KeyMsg *km, uint32_t force_seq);
+
+// State s from D taken by B at now_ns (B->D once per new force, D->B,
+// key->state, and the force / state sequences).
+void lat_state_received(LatencyStats *ls, const DroneStateMsg *s, uint64_t now_ns);
+
+// Writes the histograms and sequence counters, one line each, prefixed
+// with tag.
+void lat_print(FILE *out, const char *tag, const LatencyStats *ls);
+
+#endif // LATENCY_H
@@ -6,15 +6,27 @@
 #ifndef MESSAGES_H
 #define MESSAGES_H
 
-// Defines max numbers (match NUM_OBSTACLES / NUM_TARGETS in util.h)
-#define MAX_OBSTACLES 8
-#define MAX_TARGETS   8
+#include <stdint.h>
+
+// Stamp carried by the I->B, B->D and D->B messages, for the latency
+// histograms and the sequence checks of B (see latency.h).
+//   seq  : 1, 2, 3, ... per sender and message type (0 = not stamped)
+//   ref  : D -> B only: seq of the force the state was integrated with
+//   t_ns : CLOCK_MONOTONIC of the sender when it sent the message (the
+//          clock is system-wide, so B can subtract it from its own)
+
+typedef struct {
+    uint32_t seq;
+    uint32_t ref;
+    uint64_t t_ns;
+} MsgStamp;
 
 // Defines message: Keyboard -> Server (I -> B)
 // Contains exactly one key pressed by the user.
 
 typedef struct {
-    char key;   // e.g. 'w', 'e', 'd', 'R', 'q', ...
+    char     key;     // e.g. 'w', 'e', 'd', 'R', 'q', ...
+    MsgStamp stamp;   // stamped by I when it read the key
 } KeyMsg;
 
 
@@ -22,42 +34,74 @@ typedef struct {
 // Contains the commanded force and a reset flag.
 
 typedef struct {
-    double Fx;   // total commanded force in x
-    double Fy;   // total commanded force in y
-    int    reset; // 0 = normal, 1 = reset state in D
+    double   Fx;    // total commanded force in x
+    double   Fy;    // total commanded force in y
+    int      reset; // 0 = normal, 1 = reset state in D
+    MsgStamp stamp; // stamped by force_link_send() (shm_ipc.c)
 } ForceStateMsg;
 
 
 // Defines message: Dynamics -> Server (D -> B)
-// Contains the current drone state.
+// Contains the current drone state. The integrators only touch the four
+// doubles in front of the stamp.
 
 typedef struct {
-    double x, y;    // position
-    double vx, vy;  // velocity
+    double   x, y;          // position
+    double   vx, vy;        // velocity
+    MsgStamp stamp;         // seq of the state, ref = seq of its force
+    uint64_t force_t_ns;    // stamp.t_ns of that force (B's send time)
+    uint64_t force_rx_ns;   // when D first picked that force up
 } DroneStateMsg;
 
-// Defines message: Obstacles -> Server (O -> B)
+// Defines messages of the lockstep mode (B <-> D, --lockstep)
+// B asks for exactly one dt with the force to apply; D integrates it at once
+// (no sleeping) and answers with the same step number.
+
+typedef struct {
+    uint64_t      step;    // 1, 2, 3, ...
+    ForceStateMsg force;   // force for this step (reset honoured before integrating)
+} StepRequestMsg;
+
+typedef struct {
+    uint64_t      step;    // step number of the request
+    DroneStateMsg state;   // state after integrating the step
+} StepReplyMsg;
+
+// Defines batch messages: Obstacles -> Server (O -> B), Targets -> Server (T -> B)
+// Variable length on the pipe: a BatchHeader, then `count` specs of
+// `spec_size` bytes each (batch_write() / batch_read() in util.h).
+// The batch size comes from params.txt (obs_batch / tgt_batch).
+
+typedef struct {
+    uint32_t count;       // specs that follow
+    uint32_t spec_size;   // sizeof(ObstacleSpec) or sizeof(TargetSpec), checked by B
+} BatchHeader;
+
+// Largest batch B accepts (a larger count means a corrupt stream)
+#define BATCH_MAX_COUNT (1u << 20)
+
 typedef struct {
     double x;
     double y;
     int    life_steps;  // defines how long the obstacle lives (in B's update steps)
 } ObstacleSpec;
 
+// Obstacle batch as B sees it after batch_read() (obs points into the read buffer).
 typedef struct {
-    int    count;       // how many obstacles in this message (≤ MAX_OBSTACLES)
-    ObstacleSpec obs[MAX_OBSTACLES];
+    int                 count;
+    const ObstacleSpec *obs;
 } ObstacleSetMsg;
 
-// Defines message: Targets -> Server (T -> B)
 typedef struct {
     double x;
     double y;
     int    life_steps;  // defines how long the target lives (in B's update steps)
 } TargetSpec;
 
+// Target batch as B sees it after batch_read() (tgt points into the read buffer).
 typedef struct {
-    int       count;         // how many targets in this message (≤ MAX_TARGETS)
-    TargetSpec tgt[MAX_TARGETS];
+    int               count;
+    const TargetSpec *tgt;
 } TargetSetMsg;
 
 #endif // MESSAGES_H
@@ -0,0 +1,60 @@
+// obsgrid.h
+// Obstacle store of the server (B) for the repulsion sum
+//   - Structure of arrays (ox[], oy[]) of the active obstacles only, grouped
+//     by the cells of a uniform grid. Cell size = obstacle clearance
+//     (world_half * OBS_CLEARANCE_FACTOR), so every obstacle that can push a
+//     point lies in the 3x3 cells around it
+//   - Rebuilt by B when an obstacle batch is accepted and when obstacles
+//     expire (counting sort, one pass)
+//   - Branch-free repulsion kernels: AVX2 (4 obstacles per instruction),
+//     SSE2 (2) or scalar, picked at run time (obs_simd in params.txt)
+// ======================================================================
+
+#ifndef OBSGRID_H
+#define OBSGRID_H
+
+#include "params.h"
+#include "obstacles.h"
+
+typedef struct {
+    double  x0;          // lower world edge (-world_half)
+    double  inv_cell;    // 1 / cell size
+    int     nx;          // cells per axis (0 until the first build)
+    int     n;           // obstacles stored
+    int     cap;         // allocated entries of ox / oy
+    int     cells_cap;   // allocated entries of start
+    int     kernel;      // SIMD_* used by obsgrid_repulsion()
+    unsigned long generation;   // bumped by every build (caches compare it)
+    int    *start;       // nx*nx + 1 offsets: cell c holds entries [start[c], start[c+1])
+    double *ox, *oy;     // active obstacle positions, grouped by cell
+} ObsGrid;
+
+// Empty grid (no allocation until the first build).
+void obsgrid_init(ObsGrid *g);
+
+// Releases the grid.
+void obsgrid_free(ObsGrid *g);
+
+// Stores the active obstacles among obs[idx[0..num_obs)] (the live slots of
+// the pool; obs[0..num_obs) when idx is NULL) and picks the kernel from
+// params->obs_simd. Returns 0, or -1 when out of memory (the grid is then
+// empty and the caller should scan obs[]).
+int  obsgrid_build(ObsGrid *g, const Obstacle *obs, const int *idx, int num_obs,
+                   const SimParams *params);
+
+// Adds the repulsion of the obstacles around (x, y) to *Px, *Py: same field as
+// compute_repulsive_P(), visiting only the 3x3 cells around the point.
+void obsgrid_repulsion(const ObsGrid *g, double x, double y,
+                       const SimParams *params, double *Px, double *Py);
+
+// Returns the kernel to use for want (SIMD_*): AUTO picks the widest the CPU
+// supports, an unsupported request falls back to the next narrower one.
+int  obsgrid_select_kernel(int want);
+
+// Adds the repulsion of the n obstacles (ox[i], oy[i]) on (x, y) to *Px, *Py
+// with the given kernel. Agrees with compute_repulsive_P() to rounding: the
+// kernels multiply by 1/rho instead of dividing and add in a different order.
+void obsgrid_sum(int kernel, const double *ox, const double *oy, int n,
+                 double x, double y, double clearance, double *Px, double *Py);
+
+#endif // OBSGRID_H
@@ -5,8 +5,9 @@
 #ifndef OBSTACLES_H
 #define OBSTACLES_H
 
-
-#define NUM_OBSTACLES 12 // Defines number of obstacles
+#include "pool.h"
+#include "pointgrid.h"
+#include "heartbeat.h"
 
 typedef struct {
     double x;
@@ -15,10 +16,30 @@ typedef struct {
     int    life_steps;  // Indicates how many state updates left before disappearing
 } Obstacle;
 
-extern Obstacle g_obstacles[NUM_OBSTACLES];
+// Obstacles of the server (B): obs_capacity slots, handed out by g_obs_pool.
+// Live slots are g_obs_pool.live[0..count); free slots have active = 0.
+extern Obstacle *g_obstacles;
+extern SlotPool  g_obs_pool;
+// Proximity index over the live slots, kept in step by obstacle_add / obstacle_remove
+extern PointGrid g_obs_index;
+
+// Allocates g_obstacles, g_obs_pool and g_obs_index (B, at start-up). Returns 0 or -1.
+int  obstacle_store_init(int capacity, double world_half);
+
+// Releases them.
+void obstacle_store_free(void);
+
+// Stores a live obstacle in a free slot and indexes it. Returns the slot, or -1
+// when the pool is full.
+int  obstacle_add(double x, double y, int life_steps);
+
+// Deactivates a live obstacle and returns its slot to the pool and the index.
+// Slots move in g_obs_pool.live[], so loops over it that remove must run backwards.
+void obstacle_remove(int slot);
 
 // Runs the obstacle process:
 //   - fd_write     : write-end of pipe O->B
 //   - fd_read   : read-end of pipe B->O
-void run_obstacle_process(int write_fd, SimParams params) ;
+//   - hb           : shared heartbeat counters (beats every HB_IDLE_BEAT_NS)
+void run_obstacle_process(int write_fd, SimParams params, HeartbeatBoard *hb);
 #endif // OBSTACLES_H
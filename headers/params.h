@@ -6,6 +6,61 @@
 #ifndef PARAMS_H
 #define PARAMS_H
 
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint64_t
+
+// Transport used between B and D (ipc_mode in params.txt)
+#define IPC_MODE_PIPE 0   // fixed-size messages over pipes (default, fallback)
+#define IPC_MODE_SHM  1   // shared-memory seqlock mailbox + eventfd doorbell
+
+// What D does after missing step deadlines (sched_policy in params.txt)
+#define SCHED_CATCHUP 0   // integrate the missed steps back-to-back (up to sched_max_catchup)
+#define SCHED_DROP    1   // skip the missed deadlines, one step per wake-up
+
+// Integrator of D (integrator in params.txt, see integrator.h)
+#define INTEG_SEMI_IMPLICIT 0   // v += a*h, then x += v*h (the original update)
+#define INTEG_RK4           1   // classic 4th-order Runge-Kutta on (x, v)
+#define INTEG_EXP           2   // exact update of the viscous term, force frozen per sub-step
+#define INTEG_ADAPTIVE      3   // embedded RK 3(2), step size chosen from a local error estimate
+
+// Vector kernels: swarm of D (swarm_simd, see swarm.h) and obstacle repulsion
+// of B (obs_simd, see obsgrid.h)
+#define SIMD_AUTO   0   // widest the CPU supports
+#define SIMD_SCALAR 1
+#define SIMD_SSE2   2
+#define SIMD_AVX2   3
+
+// Log categories (log_<category>=level in params.txt)
+enum {
+    LOG_CAT_KEYS,       // keys in I and B, pause / reset / quit
+    LOG_CAT_STATE,      // drone states (B received, D produced) and hits
+    LOG_CAT_FORCE,      // forces sent from B to D
+    LOG_CAT_SPAWN,      // obstacle / target batches in O, T and B
+    LOG_CAT_WATCHDOG,   // watchdog warnings, resumes and stops in W and B
+    LOG_CAT_COUNT
+};
+
+// Processes that own a log (log_<process>_<category>=level in params.txt)
+enum {
+    LOG_PROC_SERVER,
+    LOG_PROC_KEYBOARD,
+    LOG_PROC_DYNAMICS,
+    LOG_PROC_OBSTACLES,
+    LOG_PROC_TARGETS,
+    LOG_PROC_WATCHDOG,
+    LOG_PROC_COUNT
+};
+
+// Log levels
+#define LOG_OFF   0   // nothing
+#define LOG_INFO  1   // events: binary records and one text line per event
+#define LOG_DEBUG 2   // also per-entity text lines (each key in I, each rejected spawn)
+
+typedef struct {
+    unsigned char level[LOG_PROC_COUNT][LOG_CAT_COUNT];   // LOG_OFF .. LOG_DEBUG
+    int           sample[LOG_CAT_COUNT];                  // keep 1 record in N (1 = all)
+} LogParams;
+
 typedef struct {
     double mass;        // Mass of the drone
     double visc;        // Viscous friction coefficient
@@ -17,6 +72,32 @@ typedef struct {
     double wall_gain;      // Strength of repulsive force
     int   wd_warn_sec;    // Watchdog warning timeout (sec)
     int   wd_kill_sec;    // Watchdog kill timeout (sec)
+
+    int   ipc_mode;       // IPC_MODE_PIPE or IPC_MODE_SHM
+
+    double ui_fps;        // Render-thread frame rate of B (frames per second)
+
+    int   sched_policy;      // SCHED_CATCHUP or SCHED_DROP
+    int   sched_max_catchup; // most steps D integrates per wake-up (catchup policy)
+
+    int   integrator;     // INTEG_SEMI_IMPLICIT, INTEG_RK4, INTEG_EXP or INTEG_ADAPTIVE
+    int   substeps;       // internal sub-steps per dt (>= 1, fixed-step integrators)
+    double adapt_tol;     // local error tolerance per internal step (adaptive)
+    double adapt_h_min;   // smallest internal step in seconds (adaptive)
+
+    int   swarm;          // extra drones integrated by D (0 = single drone only)
+    int   swarm_simd;     // SIMD_*
+    int   obs_simd;       // SIMD_*, obstacle repulsion kernel of B
+    int   rep_field_res;  // samples per axis of B's cached repulsion field (0 = off)
+
+    int   obs_capacity;   // obstacle slots of B's pool
+    int   tgt_capacity;   // target slots of B's pool
+    int   obs_batch;      // obstacles per batch sent by O
+    int   tgt_batch;      // targets per batch sent by T
+
+    uint64_t seed;        // random seed of O and T (0 = from the clock, resolved by main)
+
+    LogParams log;        // Log levels and sampling (log_* keys)
 } SimParams;
 
 // Sets default values- just in case params.txt is not found
@@ -25,4 +106,18 @@ void init_default_params(SimParams *p);
 // Overrides default values with values from params.txt, if present.
 void load_params_from_file(const char *filename, SimParams *p);
 
+// Name of an INTEG_* value as written in params.txt ("rk4", ...).
+const char *integrator_name(int integrator);
+
+// Name of a SIMD_* value as written in params.txt ("avx2", ...).
+const char *simd_name(int simd);
+
+// Names used by the log_* keys ("server", "keys", ...).
+const char *log_proc_name(int proc);
+const char *log_cat_name(int cat);
+
+// Writes the parameters as "key=value" lines (params.txt syntax) into buf.
+// Returns the length snprintf() would produce.
+int  params_format(const SimParams *p, char *buf, size_t len);
+
 #endif // PARAMS_H
@@ -0,0 +1,52 @@
+// pointgrid.h
+// Proximity index of the server (B) over the live obstacles and targets
+//   - Uniform grid over the world with one doubly linked list of pool slots
+//     per cell: insert and remove are O(1), so the index follows every
+//     spawn, hit and expiry instead of being rebuilt
+//   - Answers "anything within r of (x, y)" by visiting only the cells that
+//     overlap the query square: target hit tests and spawn validation cost
+//     the neighbourhood, not the whole pool
+//   - Cell size from the caller (the spawn clearance), shrunk for large pools
+//     so that a cell holds a handful of points at full capacity
+// ======================================================================
+
+#ifndef POINTGRID_H
+#define POINTGRID_H
+
+#include <stdbool.h>
+
+typedef struct {
+    int     cap;        // slots (same as the pool)
+    int     nx;         // cells per axis
+    double  x0;         // lower world edge (-world_half)
+    double  inv_cell;   // 1 / cell size
+    int     count;      // indexed slots
+    int    *head;       // nx*nx: first slot of the cell, -1 when empty
+    int    *next;       // next[slot]: next slot of its cell, -1 at the end
+    int    *prev;       // prev[slot]: previous slot of its cell, -1 at the head
+    int    *cell;       // cell[slot]: its cell, -1 when not indexed
+    double *px, *py;    // indexed positions (no need to touch the item array)
+} PointGrid;
+
+// Allocates an empty index of cap slots over [-world_half, world_half]^2,
+// with cells of at most `cell` world units. Returns 0 or -1.
+int  pointgrid_init(PointGrid *g, int cap, double world_half, double cell);
+
+// Releases the index.
+void pointgrid_free(PointGrid *g);
+
+// Indexes slot at (x, y). Points outside the world go to the edge cells.
+void pointgrid_insert(PointGrid *g, int slot, double x, double y);
+
+// Removes slot (no-op if it is not indexed).
+void pointgrid_remove(PointGrid *g, int slot);
+
+// True if an indexed point lies within r of (x, y). Stops at the first one.
+bool pointgrid_any_within(const PointGrid *g, double x, double y, double r);
+
+// Writes up to max_out slots lying within r of (x, y) to out[]. Returns how
+// many were written (max_out means there may be more).
+int  pointgrid_within(const PointGrid *g, double x, double y, double r,
+                      int *out, int max_out);
+
+#endif // POINTGRID_H
@@ -0,0 +1,50 @@
+// poisson.h
+// Poisson-disk sampling of the generators (O and T), Bridson's algorithm
+//   - Fills the domain (a centred square or disk) with points at least
+//     min_dist apart: a background grid of cell min_dist / sqrt(2) holds at
+//     most one point per cell, so each candidate is checked against the
+//     5x5 cells around it only
+//   - Candidates are drawn in the annulus [min_dist, 2 * min_dist] around a
+//     random active point; a point with k failed candidates leaves the
+//     active list. Cost is linear in the number of points produced
+//   - The whole domain is filled, then a random subset of the requested size
+//     is kept, so a small batch is spread over the domain rather than
+//     clustered around the first point
+//   - Spacing is guaranteed: a batch larger than what fits at min_dist comes
+//     back short instead of overlapping
+// ======================================================================
+
+#ifndef POISSON_H
+#define POISSON_H
+
+#include "rng.h"
+
+#define POISSON_BOX  0   // [-half, half]^2
+#define POISSON_DISK 1   // x^2 + y^2 <= half^2
+#define POISSON_K    30  // candidates per active point (Bridson's value)
+
+// Work buffers, kept across batches (grown on demand).
+typedef struct {
+    double *x, *y;      // samples of the last run, x[0..count)
+    int    *active;     // samples that may still have room around them
+    int     cap;        // entries of x / y / active
+    int    *grid;       // nx*nx: sample in the cell, -1 when empty
+    int     grid_cap;   // entries of grid
+} PoissonSampler;
+
+// Empty sampler (no allocation until the first run).
+void poisson_init(PoissonSampler *s);
+
+// Releases the buffers.
+void poisson_free(PoissonSampler *s);
+
+// Samples up to max_n points at least min_dist apart in the domain of the
+// given shape (POISSON_BOX / POISSON_DISK) and half size, centred on the
+// origin, with k candidates per active point, drawing from rng. Points are
+// in s->x, s->y in random order. Returns their number (below max_n when the
+// domain is full), or -1 when out of memory or when min_dist is too small
+// for the domain.
+int  poisson_sample(PoissonSampler *s, Rng *rng, int shape, double half, double min_dist,
+                    int k, int max_n);
+
+#endif // POISSON_H
@@ -0,0 +1,42 @@
+// pool.h
+// Slot pool of the server (B) for obstacles and targets
+//   - Capacity fixed at start-up (obs_capacity / tgt_capacity in params.txt),
+//     one allocation for the index arrays; the caller owns the item array
+//   - Free slots form a singly linked free list: alloc and release are O(1)
+//     and a released slot is the next one handed out
+//   - Live slots are also kept dense in live[0..count), so loops over the
+//     items never visit an idle slot
+//   - gen changes whenever the set of live slots does, so copies of the live
+//     items can be refreshed only when they are stale
+// ======================================================================
+
+#ifndef POOL_H
+#define POOL_H
+
+typedef struct {
+    int  cap;         // slots
+    int  count;       // live slots
+    int  free_head;   // first free slot, -1 when full
+    int *next_free;   // next_free[slot]: next free slot (free slots only)
+    int *live;        // live slots, dense in [0, count), in no particular order
+    int *live_pos;    // live_pos[slot]: index in live[], -1 when free
+    unsigned gen;     // bumped by every alloc, release and clear (1 after init)
+} SlotPool;
+
+// Allocates the index arrays for cap slots, all free. Returns 0 or -1.
+int  pool_init(SlotPool *p, int cap);
+
+// Releases the index arrays.
+void pool_free(SlotPool *p);
+
+// Takes a free slot. Returns its index, or -1 when the pool is full.
+int  pool_alloc(SlotPool *p);
+
+// Returns a live slot to the free list. The last live slot moves into its
+// place in live[], so a loop over live[] that releases must run backwards.
+void pool_release(SlotPool *p, int slot);
+
+// Releases every live slot.
+void pool_clear(SlotPool *p);
+
+#endif // POOL_H
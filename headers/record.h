@@ -0,0 +1,137 @@
+// record.h
+// Session recording and replay of B (--record FILE / --replay FILE)
+//   - The recorder stores every input B applies: each key (from I, the key
+//     ring or --script) and each obstacle / target batch (from O and T),
+//     stamped with B's step counter at the moment it was applied
+//   - A replay loads the file and hands the records back to B in place of
+//     I, O and T, each at its recorded step: the run goes through the same
+//     states and ends with the same score, targets and drone state as the
+//     recorded one
+//   - A lockstep recording is replayed with D in lockstep: D is
+//     deterministic there, so its states are not stored. In real time,
+//     which step of D first sees a new force depends on wall-clock timing,
+//     so the recording also stores every state B handled and the replay
+//     takes them from the file instead of from D
+//
+// ---------------- On-disk format (version 2) ----------------
+// Native byte order, written and read by the same build (checked through
+// params_size).
+//
+//   RecFileHeader                   magic, version, params of the run
+//   { RecHeader, payload }*         one per applied input (and state), in order
+//   { RecHeader(REC_END), RecSummary }   written on a clean exit
+//
+// Payloads: REC_KEY none (the key is in `count`), REC_OBS count
+// ObstacleSpec, REC_TGT count TargetSpec, REC_STATE one DroneStateMsg,
+// REC_END one RecSummary. Every size is a multiple of 8, so payloads stay
+// aligned in the loaded buffer.
+// A file cut short (crash) replays up to its last whole record.
+// ======================================================================
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "messages.h"
+#include "params.h"
+
+#define REC_MAGIC   0x31435241u   // "ARC1"
+#define REC_VERSION 2   // 2: DroneStateMsg carries its stamp (messages.h)
+
+// Record types
+#define REC_KEY   1
+#define REC_OBS   2
+#define REC_TGT   3
+#define REC_END   4
+#define REC_STATE 5   // real-time recordings only
+
+typedef struct {
+    uint32_t  magic;         // REC_MAGIC
+    uint32_t  version;       // REC_VERSION
+    uint32_t  params_size;   // sizeof(SimParams) of the writer
+    uint32_t  lockstep;      // 1 = states come from D in lockstep, 0 = REC_STATE records
+    SimParams params;        // parameters of the run, seed resolved
+} RecFileHeader;
+
+typedef struct {
+    uint64_t step;    // states B had handled when it applied the input
+                      // (REC_STATE: the step of that state, from 1)
+    uint32_t type;    // REC_*
+    uint32_t count;   // REC_KEY: the key; REC_OBS / REC_TGT: specs that follow
+} RecHeader;
+
+// Outcome of the recorded run, compared at the end of a replay.
+typedef struct {
+    uint64_t      steps;     // states handled
+    int32_t       score;
+    int32_t       targets;   // targets collected
+    DroneStateMsg state;     // last drone state
+} RecSummary;
+
+// ---------------- Recorder ----------------
+
+typedef struct {
+    FILE    *fp;
+    uint64_t records;   // inputs written
+    bool     failed;    // a write failed (reported by recorder_close)
+} Recorder;
+
+// Creates the file and writes its header (lockstep: see RecFileHeader).
+// Returns 0, or -1 (errno set).
+int  recorder_open(Recorder *r, const char *path, const SimParams *params, bool lockstep);
+
+// Appends one applied input, stamped with step.
+void recorder_key(Recorder *r, uint64_t step, char key);
+void recorder_obstacles(Recorder *r, uint64_t step, const ObstacleSetMsg *msg);
+void recorder_targets(Recorder *r, uint64_t step, const TargetSetMsg *msg);
+
+// Appends the state B handled as step `step` (real-time recordings).
+void recorder_state(Recorder *r, uint64_t step, const DroneStateMsg *s);
+
+// Writes the summary (if not NULL) and closes the file. Returns 0, or -1
+// if any write failed.
+int  recorder_close(Recorder *r, const RecSummary *end);
+
+// ---------------- Replay ----------------
+
+// One input handed back by replay_next_due().
+typedef struct {
+    uint32_t       type;   // REC_KEY, REC_OBS or REC_TGT
+    char           key;
+    ObstacleSetMsg obs;    // points into the loaded file
+    TargetSetMsg   tgt;
+} RecEvent;
+
+typedef struct {
+    RecFileHeader  hdr;
+    unsigned char *data;       // the records, whole file after the header
+    size_t         size;       // bytes of whole records in data
+    size_t         pos;        // next record
+    size_t         inputs;     // REC_KEY / REC_OBS / REC_TGT records
+    size_t         states;     // REC_STATE records
+    uint64_t       last_step;  // step of the last input or state
+    bool           has_end;    // the run exited cleanly: `end` is valid
+    RecSummary     end;
+} Replay;
+
+// Loads and checks a recording. Returns 0, or -1 (message on stderr).
+int  replay_load(const char *path, Replay *rp);
+
+// Pops the next input applied at or before step into *ev. Returns 1 if one
+// was popped. Stops at a state record.
+int  replay_next_due(Replay *rp, uint64_t step, RecEvent *ev);
+
+// Pops the next record into *s if it is a state. Returns 1 if one was popped.
+int  replay_next_state(Replay *rp, DroneStateMsg *s);
+
+// Returns 1 once every input has been handed back.
+int  replay_done(const Replay *rp);
+
+// Releases the loaded records.
+void replay_free(Replay *rp);
+
+#endif // RECORD_H
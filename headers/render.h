@@ -0,0 +1,57 @@
+// render.h
+// Render thread of the server (B)
+//   - The event thread publishes immutable world snapshots into a
+//     lock-free triple buffer after every loop pass
+//   - The render thread draws the newest snapshot at a fixed frame rate
+//     (ui_fps in params.txt), so terminal writes never delay the control loop
+// Only the render thread calls curses while it runs.
+// ======================================================================
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+
+#include "params.h"
+#include "blackboard.h"
+#include "obstacles.h"
+#include "targets.h"
+#include "swarm.h"
+
+// Everything the UI needs to draw one frame.
+typedef struct {
+    Blackboard bb;                       // force, state, pause, score, banner
+    Obstacle  *obs;                      // live obstacles, dense
+    int        n_obs;
+    unsigned   obs_gen;                  // g_obs_pool.gen of obs[] (0 = unknown)
+    Target    *tgt;                      // live targets, dense
+    int        n_tgt;
+    unsigned   tgt_gen;                  // g_tgt_pool.gen of tgt[] (0 = unknown)
+    double     hb_stamp;                 // monotonic time (s) of the last state from D
+    uint64_t   seq;                      // publish counter
+} WorldSnapshot;
+
+// Starts the render thread (ui_init() must have been called). Returns 0 or -1.
+// Each snapshot slot holds up to obs_capacity / tgt_capacity items.
+// swarm (may be NULL): shared swarm positions, read by the render thread at
+// each frame so the snapshot stays small whatever the swarm size.
+int  render_start(const SimParams *params, const SwarmBuf *swarm);
+
+// Stops and joins the render thread. Safe to call when it never started.
+void render_stop(void);
+
+// Event thread: copies the snapshot, items included, into the triple buffer
+// (never blocks). Item arrays are copied only when the slot holds another
+// generation of them (obs_gen / tgt_gen).
+void render_publish(const WorldSnapshot *ws);
+
+// Event thread: asks the render thread to pick up a new terminal size.
+void render_request_resize(void);
+
+// Event thread: shows a one-line status message on the next frame.
+void render_status(int row, const char *msg);
+
+// Frames drawn so far (for the stats line).
+uint64_t render_frames(void);
+
+#endif // RENDER_H
@@ -0,0 +1,46 @@
+// repfield.h
+// Optional cached obstacle repulsion field of the server (B), rep_field_res in
+// params.txt (0 = off, the default: B sums the repulsion exactly every tick)
+//   - res x res samples of the obstacle repulsion vector over
+//     [-world_half, world_half]^2, read back with bilinear interpolation:
+//     O(1) per tick whatever the number of obstacles
+//   - Tagged with the generation of the obstacle grid it was sampled from;
+//     the grid is rebuilt on every accepted batch and every expiry, so a
+//     stale field is detected (and rebuilt) on the next lookup
+//   - Walls are not part of it: their repulsion is computed by D
+// ======================================================================
+
+#ifndef REPFIELD_H
+#define REPFIELD_H
+
+#include <stdbool.h>
+
+#include "obsgrid.h"
+#include "params.h"
+
+typedef struct {
+    int      res;            // samples per axis (0 = not allocated)
+    double   x0;             // lower world edge (-world_half)
+    double   inv_h;          // 1 / sample spacing
+    bool     valid;          // samples match grid generation
+    unsigned long generation;   // obstacle grid generation of the samples
+    double  *p;              // res*res (Px, Py) pairs, row-major
+    // Statistics
+    unsigned long builds;    // samplings of the grid
+    double   build_ms;       // duration of the last one
+} RepField;
+
+// Empty field (no allocation until the first lookup).
+void repfield_init(RepField *f);
+
+// Releases the samples.
+void repfield_free(RepField *f);
+
+// Obstacle repulsion at (x, y), interpolated from the samples. Resamples the
+// grid first if it was rebuilt since (or on the first call). Points outside
+// the world are clamped to its edge. Returns false (*Px, *Py untouched) when
+// the field is off (rep_field_res < 2) or cannot be allocated.
+bool repfield_lookup(RepField *f, const ObsGrid *grid, const SimParams *params,
+                     double x, double y, double *Px, double *Py);
+
+#endif // REPFIELD_H
@@ -0,0 +1,72 @@
+// rng.h
+// Random numbers of the generators (O, T) and the benches
+//   - xoshiro256** (Blackman & Vigna): 256 bits of state, period 2^256 - 1,
+//     a few shifts, rotations and multiplies per 64-bit draw, no shared state
+//   - One stream per process, all derived from the single `seed` of
+//     params.txt through splitmix64: a run with a fixed seed is bit-exact
+//     from one run to the next (seed=0 picks one from the clock at start-up,
+//     logged so it can be replayed)
+//   - Batch fills run four independent lanes side by side so the compiler
+//     can keep them in vector registers (rng.c is always optimised)
+// ======================================================================
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Stream ids of the processes that draw random numbers
+#define RNG_STREAM_OBSTACLES 1
+#define RNG_STREAM_TARGETS   2
+#define RNG_STREAM_BENCH     99
+
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+// Seeds rng with stream `stream` of `seed`: distinct streams of one seed are
+// unrelated sequences.
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Next 64 random bits.
+static inline uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t  r = rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t  t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3]  = rng_rotl(s[3], 45);
+    return r;
+}
+
+// Uniform double in [0, 1) (53 random bits).
+static inline double rng_uniform(Rng *rng) {
+    return (double)(rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+// Uniform double in [lo, hi).
+static inline double rng_range(Rng *rng, double lo, double hi) {
+    return lo + (hi - lo) * rng_uniform(rng);
+}
+
+// Uniform integer in [0, n), n > 0 (Lemire's multiply-shift, unbiased).
+uint32_t rng_below(Rng *rng, uint32_t n);
+
+// Fills out[0..n) with uniform doubles in [lo, hi).
+void rng_fill_uniform(Rng *rng, double *out, int n, double lo, double hi);
+
+// Fills (x[i], y[i]), i < n, with points uniform over the disk of the given
+// radius centred on the origin.
+void rng_fill_disk(Rng *rng, double *x, double *y, int n, double radius);
+
+// Seed for seed=0: mixes the clock and the pid (never returns 0).
+uint64_t rng_clock_seed(void);
+
+#endif // RNG_H
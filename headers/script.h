@@ -0,0 +1,38 @@
+// script.h
+// Scripted key input for B (--script FILE)
+//   - Each key is applied when the simulation reaches a given step, so a run
+//     replays the same inputs at the same simulated times, however fast it goes
+//   - File format, one entry per line ('#' starts a comment):
+//         <step> <keys>        e.g. "120 fff" = three 'f' keys at step 120
+// ======================================================================
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t step;   // applied before step `step` is requested
+    char     key;
+} ScriptKey;
+
+typedef struct {
+    ScriptKey *keys;    // sorted by step (file order kept within a step)
+    size_t     count;
+    size_t     next;    // first key not applied yet
+} KeyScript;
+
+// Loads a script file. Returns 0, or -1 on I/O or syntax error (message on stderr).
+int  script_load(const char *path, KeyScript *ks);
+
+// Pops the next key due at or before step into *key. Returns 1 if a key was popped.
+int  script_next_due(KeyScript *ks, uint64_t step, char *key);
+
+// Returns 1 once every key has been applied.
+int  script_done(const KeyScript *ks);
+
+// Releases the key array.
+void script_free(KeyScript *ks);
+
+#endif // SCRIPT_H
@@ -5,19 +5,40 @@
 #ifndef SERVER_H
 #define SERVER_H
 
-#include <sys/types.h>   // for pid_t
 #include "params.h"
+#include "shm_ipc.h"
+#include "swarm.h"
+#include "record.h"
+#include "heartbeat.h"
+
+// Command-line options of B (parsed in main)
+typedef struct {
+    int         headless;        // 1 = no ncurses, stats lines instead of drawing
+    const char *stats_path;      // stats output file, NULL = stderr (headless only)
+    double      stats_interval;  // seconds between stats lines
+    long        lockstep_steps;  // > 0: lockstep mode, run this many steps as fast as possible
+    const char *script_path;     // scripted keys by step number (script.h), NULL = none
+    const char *record_path;     // session recording to write (record.h), NULL = none
+    Replay     *replay;          // loaded recording fed in place of I, O and T, NULL = live run
+    int         replay_realtime; // 1 = replay at the recorded pace (one step per dt)
+} ServerOptions;
 
 // Runs the server process:
 //   - fd_kb     : read-end of pipe I->B
 //   - fd_to_d   : write-end of pipe B->D
 //   - fd_from_d : read-end of pipe D->B
-//   - fd_obs    : read-end of pipe O->B
-//   - fd_tgt    : read-end of pipe T->B
-//   - pid_W     : watchdog PID (heartbeat target)
+//   - fd_obs    : read-end of pipe O->B (-1 when replaying)
+//   - fd_tgt    : read-end of pipe T->B (-1 when replaying)
+//   - hb        : shared heartbeat counters read by W (B beats once per state)
 //   - params    : simulation parameters
+//   - ipc       : shared B<->D mailbox (shm mode), NULL in pipe mode
+//   - opts      : headless / stats / lockstep / record / replay options
+//   - swarm     : shared swarm positions written by D, NULL without a swarm
 void run_server_process(int fd_kb, int fd_to_d, int fd_from_d,
                         int fd_obs, int fd_tgt,
-                        pid_t pid_W,
-                        SimParams params);
+                        HeartbeatBoard *hb,
+                        SimParams params,
+                        ShmIpc *ipc,
+                        const ServerOptions *opts,
+                        const SwarmBuf *swarm);
 #endif // SERVER_H
@@ -0,0 +1,114 @@
+// shm_ipc.h
+// Shared-memory transport between the server (B) and the dynamics (D)
+//   - One POSIX shared-memory segment, created by main() before the forks
+//   - Seqlock-protected latest-value slots for drone state and commanded force
+//   - An eventfd "doorbell" rung by D whenever a new state is published
+//   - A lock-free SPSC ring carrying keyboard events from I to B
+// ======================================================================
+
+#ifndef SHM_IPC_H
+#define SHM_IPC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "messages.h"
+
+// Largest message (in 64-bit words) a seqlock slot can carry.
+#define SEQLOCK_MAX_WORDS 16
+
+// Seqlock slot: single writer, any number of readers, readers never block the writer.
+// seq is odd while the writer is inside; readers retry if seq moved under them.
+typedef struct {
+    _Atomic uint32_t seq;
+    uint32_t         pad;
+    _Atomic uint64_t words[SEQLOCK_MAX_WORDS];
+} SeqSlot;
+
+// Latest-value mailbox for the B<->D channel.
+typedef struct {
+    SeqSlot          state;      // D -> B : newest DroneStateMsg
+    SeqSlot          force;      // B -> D : newest ForceStateMsg (reset flag stripped)
+    _Atomic uint32_t reset_gen;  // B bumps it on every reset; D resets when it changes
+} ShmMailbox;
+
+// Capacity of the I->B key ring (power of two).
+#define KEY_RING_CAP 1024
+
+// One keyboard event as stored in the ring (I stamps msg: seq and time).
+typedef struct {
+    KeyMsg   msg;
+} KeyRingEntry;
+
+// Single-producer (I) / single-consumer (B) ring of keyboard events.
+// head and tail live on separate cache lines so I and B do not false-share.
+typedef struct {
+    _Alignas(64) _Atomic uint64_t tail;          // next slot I writes (producer-owned)
+    _Alignas(64) _Atomic uint64_t head;          // next slot B reads (consumer-owned)
+    _Alignas(64) _Atomic uint32_t consumer_idle; // 1 while B waits on the doorbell
+    _Atomic uint64_t overruns;                   // keys dropped because the ring was full
+    _Alignas(64) KeyRingEntry entries[KEY_RING_CAP];
+} KeyRing;
+
+// Layout of the whole shared segment.
+typedef struct {
+    ShmMailbox mbox;
+    KeyRing    keys;
+} ShmShared;
+
+// Per-process handle (fds and mapping are inherited across fork()).
+typedef struct {
+    ShmShared *shared;
+    int        state_doorbell_fd;   // eventfd: D writes 1 per published state, B waits on it
+    int        key_doorbell_fd;     // eventfd: I rings it only when B is idle
+} ShmIpc;
+
+// Where B delivers commanded forces: the B->D pipe or the shared mailbox.
+typedef struct {
+    int         fd;     // write-end of pipe B->D (pipe mode)
+    ShmMailbox *mbox;   // shared mailbox (shm mode), NULL in pipe mode
+    ForceStateMsg *latch; // lockstep mode: latest force kept for the next step request, else NULL
+} ForceLink;
+
+// Creates the shared segment and the doorbell. Must be called before fork().
+// Returns 0 on success, -1 on failure (errno set).
+int  shm_ipc_create(ShmIpc *ipc);
+
+// Unmaps the segment and closes the doorbell.
+void shm_ipc_destroy(ShmIpc *ipc);
+
+// Seqlock primitives (len must be <= SEQLOCK_MAX_WORDS * 8).
+void seqlock_write(SeqSlot *slot, const void *src, size_t len);
+void seqlock_read(SeqSlot *slot, void *dst, size_t len);
+
+// D side: publishes the newest state and rings the doorbell (never blocks).
+void mailbox_publish_state(ShmIpc *ipc, const DroneStateMsg *s);
+
+// B side: clears the doorbell and copies the newest state.
+// Returns the number of states published since the last call (0 = nothing new).
+uint64_t mailbox_take_state(ShmIpc *ipc, DroneStateMsg *s);
+
+// D side: copies the newest commanded force.
+// Sets f->reset = 1 if B requested a reset since *reset_seen (which is updated).
+void mailbox_read_force(ShmMailbox *mb, ForceStateMsg *f, uint32_t *reset_seen);
+
+// I side: appends one key. Rings the doorbell only if B went idle.
+// Returns 0, or -1 if the ring was full (the key is dropped and counted as an overrun).
+int keyring_push(ShmIpc *ipc, const KeyMsg *km);
+
+// B side: drains up to max pending keys into out[] in one pass, oldest first.
+// *overruns receives the total number of keys dropped so far by the producer.
+// Returns the number of entries copied.
+int keyring_drain(ShmIpc *ipc, KeyRingEntry *out, int max, uint64_t *overruns);
+
+// Sends one force command through the link (pipe write or mailbox publish),
+// stamped with the next force sequence number and the send time.
+// In lockstep mode it only updates the latch (a pending reset stays set).
+// Returns 0 on success, -1 on failure.
+int force_link_send(const ForceLink *link, const ForceStateMsg *f);
+
+// Sequence number of the last force sent (0 before the first one).
+uint32_t force_link_last_seq(void);
+
+#endif // SHM_IPC_H
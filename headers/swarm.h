@@ -0,0 +1,80 @@
+// swarm.h
+// Drone swarm of the dynamics process (D), swarm=N in params.txt
+//   - Structure-of-arrays state (x[], y[], vx[], vy[], Fx[], Fy[]), one entry
+//     per drone, 32-byte aligned and padded to a multiple of 4
+//   - Semi-implicit Euler + Khatib wall repulsion, vectorised: AVX2 (4 drones
+//     per instruction), SSE2 (2) or scalar, picked at run time. All kernels
+//     do the same operations in the same order, so they agree bit for bit
+//   - Positions reach B through a shared seqlock buffer (one per run,
+//     created by main() before the forks); B hit-tests and draws every drone
+// ======================================================================
+
+#ifndef SWARM_H
+#define SWARM_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "params.h"
+
+// Structure-of-arrays drone state. Entries [n, cap) are padding.
+typedef struct {
+    int     n;        // drones
+    int     cap;      // allocated entries (n rounded up to 4)
+    double *x, *y;    // position
+    double *vx, *vy;  // velocity
+    double *Fx, *Fy;  // commanded force per drone
+} SwarmSoA;
+
+// Allocates the arrays for n drones (all zero). Returns 0 or -1.
+int  swarm_alloc(SwarmSoA *sw, int n);
+
+// Releases the arrays.
+void swarm_free(SwarmSoA *sw);
+
+// Places the drones on an even grid inside the walls' clearance, at rest.
+void swarm_layout(SwarmSoA *sw, const SimParams *params);
+
+// Applies the same commanded force to every drone.
+void swarm_set_force(SwarmSoA *sw, double Fx, double Fy);
+
+// Returns the kernel to use for want (SIMD_*): AUTO picks the widest the
+// CPU supports, an unsupported request falls back to the next narrower one.
+int  swarm_select_kernel(int want);
+
+// Advances every drone by one params->dt (params->substeps internal steps).
+// Each axis feels only its nearer wall, which matches compute_repulsive_P()
+// as long as wall_clearance < world_half.
+void swarm_step(SwarmSoA *sw, const SimParams *params, int kernel);
+
+// ---------------- Shared position buffer (D -> B) ----------------
+// Single writer (D), any number of readers (B's event and render threads).
+// seq is odd while D writes; readers retry if it moved under them.
+typedef struct {
+    _Atomic uint32_t seq;
+    uint32_t         count;      // drones
+    _Atomic uint64_t step;       // D's step counter of the positions
+    _Atomic uint64_t xy[];       // x[0..count) then y[0..count), as double bits
+} SwarmShared;
+
+typedef struct {
+    SwarmShared *shared;
+    size_t       bytes;
+} SwarmBuf;
+
+// Creates the shared buffer for n drones. Must be called before fork().
+// Returns 0, or -1 (errno set).
+int  swarm_buf_create(SwarmBuf *buf, int n);
+
+// Unmaps the buffer.
+void swarm_buf_destroy(SwarmBuf *buf);
+
+// D side: publishes the positions of sw (never blocks).
+void swarm_buf_publish(SwarmBuf *buf, const SwarmSoA *sw, uint64_t step);
+
+// B side: copies the newest positions into x[] and y[] (count entries each).
+// Returns the number of drones copied; *step receives D's step counter.
+int  swarm_buf_read(const SwarmBuf *buf, double *x, double *y, uint64_t *step);
+
+#endif // SWARM_H
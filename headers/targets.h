@@ -6,8 +6,9 @@
 #define TARGETS_H
 #define _GNU_SOURCE
 
-
-#define NUM_TARGETS 12  // Defines number of targets
+#include "pool.h"
+#include "pointgrid.h"
+#include "heartbeat.h"
 
 typedef struct {
     double x;
@@ -16,10 +17,30 @@ typedef struct {
     int    life_steps;  // Lifetime in steps
 } Target;
 
-extern Target g_targets[NUM_TARGETS];
+// Targets of the server (B): tgt_capacity slots, handed out by g_tgt_pool.
+// Live slots are g_tgt_pool.live[0..count); free slots have active = 0.
+extern Target   *g_targets;
+extern SlotPool  g_tgt_pool;
+// Proximity index over the live slots, kept in step by target_add / target_remove
+extern PointGrid g_tgt_index;
+
+// Allocates g_targets, g_tgt_pool and g_tgt_index (B, at start-up). Returns 0 or -1.
+int  target_store_init(int capacity, double world_half);
+
+// Releases them.
+void target_store_free(void);
+
+// Stores a live target in a free slot and indexes it. Returns the slot, or -1
+// when the pool is full.
+int  target_add(double x, double y, int life_steps);
+
+// Deactivates a live target and returns its slot to the pool and the index.
+// Slots move in g_tgt_pool.live[], so loops over it that remove must run backwards.
+void target_remove(int slot);
 
 // Runs the target process:
 //   - fd_write     : write-end of pipe T->B
 //   - fd_read   : read-end of pipe B->T
-void run_target_process(int write_fd, SimParams params);
+//   - hb           : shared heartbeat counters (beats every HB_IDLE_BEAT_NS)
+void run_target_process(int write_fd, SimParams params, HeartbeatBoard *hb);
 #endif // TARGETS_H
\ No newline at end of file
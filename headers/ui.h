@@ -0,0 +1,36 @@
+// ui.h
+// ncurses User Interface of the server (B): drone world + inspection panel
+// All curses calls of B live behind this interface, so the headless mode
+// simply never calls ui_init(). While the render thread runs, only it may
+// call ui_draw / ui_resize / ui_status.
+// ======================================================================
+
+#ifndef UI_H
+#define UI_H
+
+#include "params.h"
+#include "render.h"   // WorldSnapshot
+
+// Initializes ncurses (screen, input mode, colors).
+void ui_init(void);
+
+// Restores the terminal. Safe to call when ui_init() was never called.
+void ui_shutdown(void);
+
+// Returns 1 if ui_init() has been called and ui_shutdown() has not.
+int  ui_active(void);
+
+// Picks up a new terminal size (SIGWINCH); the next ui_draw() rebuilds the static layer.
+void ui_resize(void);
+
+// Draws one frame from a world snapshot. Only cells / rows that changed since
+// the previous frame are written to the terminal.
+//   hb_age: seconds since the last state from D (for the watchdog countdown)
+//   swarm_x, swarm_y, swarm_n: swarm drone positions (swarm_n = 0 without a swarm)
+void ui_draw(const WorldSnapshot *ws, const SimParams *params, double hb_age,
+             const double *swarm_x, const double *swarm_y, int swarm_n);
+
+// Shows a one-line status message (e.g. "process ended") at the given row.
+void ui_status(int row, const char *msg);
+
+#endif // UI_H
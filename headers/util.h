@@ -10,6 +10,9 @@
 #include <stdbool.h>
 #include "obstacles.h"   
 #include "targets.h"   
+#include "shm_ipc.h"   // for ForceLink
+#include "obsgrid.h"   // for ObsGrid
+#include "repfield.h"  // for RepField
 
 #include <stdio.h>
 #include <unistd.h>
@@ -19,7 +22,7 @@
 // Prints error message (with errno) and exit.
 void die(const char *msg);
 
-// Returns the maximum of two integers (tiny helper for select()).
+// Returns the maximum of two integers.
 int  imax(int a, int b);
 
 // Maps the keys (w,e,r,s,d,f,x,c,v) to corresponding unit direction increments (dFx, dFy).
@@ -33,13 +36,6 @@ typedef struct {
     double uy;   // unit vector y-component
 } Dir8;
 
-// Any object with x, y, active : to be treated as PointLike for latter calculated distance b/n the pointLikes
-typedef struct {
-    double x;
-    double y;
-    int    active;
-} PointLike;
-
 
 // Normalization factor for diagonals: 1/sqrt(2).
 extern const double INV_SQRT2;
@@ -59,14 +55,29 @@ int best_dir8_for_vector(double Px, double Py);
 double dot2(double ax, double ay, double bx, double by);
 
 // Computes total force vector using a "virtual key" computed from obstacles or walls
+// and sends it to D. The send is logged as a binary BLOG_FORCE record.
+// The obstacle repulsion comes from the cached field if there is one (it is
+// resampled from the grid when stale), else from the grid (only the obstacles
+// near the drone; it must hold the active obstacles of obs[]), else from a
+// scan of obs[]. field and grid may be NULL.
 void send_total_force_to_d(const ForceStateMsg *user_force,
                                   const DroneStateMsg *cur_state,
                                   const SimParams     *params,
                                   const Obstacle      *obs,
                                   int                  num_obs,
-                                  int                  fd_to_d,
-                                  FILE                *logfile,
-                                  const char          *reason);
+                                  const ObsGrid       *grid,
+                                  RepField            *field,
+                                  const ForceLink     *link,
+                                  int                  reason);   // BLOG_REASON_*
+
+// Obstacle repulsion: Khatib field of gain OBS_GAIN inside a clearance of
+// world_half * OBS_CLEARANCE_FACTOR around each obstacle
+#define OBS_CLEARANCE_FACTOR 0.30
+#define OBS_GAIN             120.0   // 120 behaved well
+
+// Adds the push of one obstacle at offset (dx, dy) = drone - obstacle.
+void add_obstacle_repulsion(double dx, double dy, double obs_clearance,
+                            double *Px, double *Py);
 
 // Computes unified repulsive field from point obstacles
 void compute_repulsive_P(const DroneStateMsg *s,
@@ -84,17 +95,14 @@ int target_too_close_to_wall(double x,
                                     const SimParams *params,
                                     double wall_margin);
 
-// Checks if (x,y) is too close to any active obstacle.
-int too_close_to_any_pointlike(double px,
-                               double py,
-                               const PointLike *arr,
-                               int count,
-                               double min_dist);
+// Target hit radius, for the drone and the swarm drones
+#define HIT_RADIUS_FACTOR      0.08
+// Distance kept between a new obstacle and the live targets (and vice versa)
+#define SPAWN_CLEARANCE_FACTOR 0.15
 
-// Checks if the drone has "hit" any active target.
+// Checks if the drone has "hit" any live target, through g_tgt_index; hit
+// targets are removed (target_remove).
 int check_target_hits(const DroneStateMsg *cur_state,
-                      Target              *targets,
-                      int                  num_targets,
                       const SimParams     *params,
                       int                 *score,
                       int                 *targets_collected,
@@ -102,14 +110,26 @@ int check_target_hits(const DroneStateMsg *cur_state,
                       int                  current_step);
 
 
-// Helper to perform uniform random double in [min, max].
-double rand_in_range(double min, double max);
+// Reusable buffer of batch_read().
+typedef struct {
+    void  *data;
+    size_t cap;    // bytes
+} BatchBuf;
+
+// Writes one variable-length batch (BatchHeader + count specs) with a single
+// writev() when the pipe takes it whole. Returns 0, or -1 (errno set).
+int batch_write(int fd, const void *specs, uint32_t count, size_t spec_size);
+
+// Reads one batch written by batch_write() into buf (grown as needed).
+// Returns the number of specs (buf->data), 0 on EOF, -1 on error or on a
+// corrupt header (wrong spec_size, count above BATCH_MAX_COUNT).
+int batch_read(int fd, size_t spec_size, BatchBuf *buf);
 
 // Logging utilities:
 // Ensure logs/ directory exists (mkdir -p logs).
 void ensure_logs_dir(void);
 
-// Open a process log file under logs/<name>.log with line buffering.
+// Open a process log file under logs/<name>.log (cold-path text messages).
 FILE* open_process_log(const char *name, const char *role_tag);
 
 #endif // UTIL_H
@@ -4,6 +4,8 @@
 
 #include <sys/types.h> // pid_t
 
+#include "heartbeat.h"
+
 // PIDs that Watchdog will supervise.
 // We send this struct from master to W *once* at startup.
 typedef struct {
@@ -18,6 +20,7 @@ typedef struct {
 // - cfg_read_fd: W reads WatchPids from here at startup
 // - warn_sec: seconds without heartbeat before sending warning to B
 // - kill_sec: seconds without heartbeat before terminating everyone
-void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec);
+// - hb: shared heartbeat counters, polled every WD_POLL_NS
+void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec, HeartbeatBoard *hb);
 
 #endif
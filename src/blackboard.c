@@ -0,0 +1,421 @@
+// blackboard.c
+// Blackboard logic of the server (B), shared by the ncurses and headless modes
+//   - Owns force / drone state, pause flag and scoring
+//   - Applies keys, state ticks and obstacle / target batches
+//   - Never draws: the caller decides how (and whether) to render
+// ======================================================================
+
+#include "headers/blackboard.h"
+#include "headers/messages.h"
+#include "headers/util.h"
+#include "headers/obstacles.h"
+#include "headers/targets.h"
+#include "headers/blog.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// Initializes the blackboard: zero force, drone at origin, no score.
+// ----------------------------------------------------------------------
+void bb_init(Blackboard *bb) {
+    bb->cur_force.Fx    = 0.0;
+    bb->cur_force.Fy    = 0.0;
+    bb->cur_force.reset = 0;
+
+    bb->cur_state = (DroneStateMsg){ .x = 0.0, .y = 0.0, .vx = 0.0, .vy = 0.0 };
+    bb->last_key  = '?';
+    bb->paused    = false;
+
+    bb->score             = 0;
+    bb->targets_collected = 0;
+    bb->last_hit_step     = -1;
+    bb->step_counter      = 0;
+    bb->swarm_hits        = 0;
+
+    obsgrid_init(&bb->obs_grid);
+    repfield_init(&bb->rep_field);
+
+    bb->wd_warning_active = 0;
+    bb->wd_blink_phase    = 0;
+}
+
+// Releases the obstacle grid and the repulsion field.
+// ----------------------------------------------------------------------
+void bb_free(Blackboard *bb) {
+    obsgrid_free(&bb->obs_grid);
+    repfield_free(&bb->rep_field);
+}
+
+// Applies one key: quit, pause toggle, reset, brake or directional force.
+// ----------------------------------------------------------------------
+bool bb_handle_key(Blackboard *bb, char key,
+                   const SimParams *params, const ForceLink *link, FILE *logfile)
+{
+    bb->last_key = key;
+
+    // Handles Quit request
+    if (key == 'q') {
+        if (BLOG_ON(LOG_CAT_KEYS, LOG_INFO)) {
+            fprintf(logfile, "QUIT requested by 'q'\n");
+            fflush(logfile);
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------
+    // Handles Pause toggle
+    // ------------------------------------------------------------------
+    if (key == 'p') {
+        bb->paused = !bb->paused;
+
+        if (bb->paused) {
+            // Zeroes the force when entering pause.
+            bb->cur_force.Fx = 0.0;
+            bb->cur_force.Fy = 0.0;
+            bb->cur_force.reset = 0;
+            send_total_force_to_d(&bb->cur_force,
+                                  &bb->cur_state,
+                                  params,
+                                  g_obstacles,
+                                  g_obs_pool.cap,
+                                  &bb->obs_grid,
+                                  &bb->rep_field,
+                                  link,
+                                  BLOG_REASON_KEY);
+        }
+        if (BLOG_ON(LOG_CAT_KEYS, LOG_INFO)) {
+            fprintf(logfile, bb->paused ? "PAUSE: ON\n" : "PAUSE: OFF\n");
+            fflush(logfile);
+        }
+    }
+    // ------------------------------------------------------------------
+    // Handles Reset (uppercase O)
+    // ------------------------------------------------------------------
+    else if (key == 'O') {
+        // Resets server-side state
+        bb->cur_state.x  = 0.0;
+        bb->cur_state.y  = 0.0;
+        bb->cur_state.vx = 0.0;
+        bb->cur_state.vy = 0.0;
+
+        // Resets forces
+        bb->cur_force.Fx = 0.0;
+        bb->cur_force.Fy = 0.0;
+        bb->cur_force.reset = 1; // Signals D to reset its state
+
+        send_total_force_to_d(&bb->cur_force,
+                              &bb->cur_state,
+                              params,
+                              g_obstacles,
+                              g_obs_pool.cap,
+                              &bb->obs_grid,
+                              &bb->rep_field,
+                              link,
+                              BLOG_REASON_KEY);
+
+        bb->cur_force.reset = 0; // Clears locally
+        bb->paused = false;      // Unpauses
+
+        if (BLOG_ON(LOG_CAT_KEYS, LOG_INFO)) {
+            fprintf(logfile, "RESET requested (O)\n");
+            fflush(logfile);
+        }
+    }
+    // ------------------------------------------------------------------
+    // Handles Directional keys and the break 'd'
+    // ------------------------------------------------------------------
+    else {
+        double dFx, dFy;
+        direction_from_key(key, &dFx, &dFy);
+
+        if (!bb->paused) {
+            if (key == 'd') {
+                // Brake: Zeroes forces
+                bb->cur_force.Fx = 0.0;
+                bb->cur_force.Fy = 0.0;
+            } else {
+                // Accumulates new force
+                bb->cur_force.Fx += dFx * params->force_step;
+                bb->cur_force.Fy += dFy * params->force_step;
+            }
+
+            bb->cur_force.reset = 0;
+
+            send_total_force_to_d(&bb->cur_force,
+                                  &bb->cur_state,
+                                  params,
+                                  g_obstacles,
+                                  g_obs_pool.cap,
+                                  &bb->obs_grid,
+                                  &bb->rep_field,
+                                  link,
+                                  BLOG_REASON_KEY);
+
+            blog_key(key, 0, bb->cur_force.Fx, bb->cur_force.Fy);
+        } else {
+            // Paused: Ignores directional changes (but still log)
+            blog_key(key, 1, bb->cur_force.Fx, bb->cur_force.Fy);
+        }
+    }
+    return false;
+}
+
+// Applies one state tick from D.
+// ----------------------------------------------------------------------
+int bb_handle_state(Blackboard *bb, const DroneStateMsg *s,
+                    const SimParams *params, const ForceLink *link)
+{
+    int hits = 0;
+
+    // Updates current state
+    bb->cur_state = *s;
+
+    // Increments global step counter (one more state update)
+    if (!bb->paused) {
+        bb->step_counter++;
+    }
+
+    // Logs state (binary record, no formatting on this path)
+    blog_state(s);
+
+    // Checks for target hits (only when not paused)
+    if (!bb->paused) {
+        hits = check_target_hits(&bb->cur_state,
+                                 params,
+                                 &bb->score,
+                                 &bb->targets_collected,
+                                 &bb->last_hit_step,
+                                 bb->step_counter);
+        if (hits > 0) {
+            blog_hit(hits, bb->score, bb->step_counter);
+        }
+    }
+    // Decrements obstacles and targets lifetimes
+    // Considers each time input is received from D, 1 sim time had elapsed
+    // Only age obstacles & targets when simulation is running
+    if (!bb->paused) {
+        // Visits live slots only, backwards since expiry removes the slot
+        int expired = 0;
+        for (int k = g_obs_pool.count - 1; k >= 0; --k) {
+            int i = g_obs_pool.live[k];
+            if (g_obstacles[i].life_steps > 0) {
+                g_obstacles[i].life_steps--;   // Decreases 1 step from its lifetime
+                if (g_obstacles[i].life_steps == 0) {
+                    obstacle_remove(i);
+                    expired++;
+                }
+            }
+        }
+        // The grid holds active obstacles only
+        if (expired > 0) {
+            obsgrid_build(&bb->obs_grid, g_obstacles, g_obs_pool.live, g_obs_pool.count, params);
+        }
+        for (int k = g_tgt_pool.count - 1; k >= 0; --k) {
+            int i = g_tgt_pool.live[k];
+            if (g_targets[i].life_steps > 0) {
+                g_targets[i].life_steps--;
+                if (g_targets[i].life_steps == 0) {
+                    target_remove(i);
+                }
+            }
+        }
+    }
+    // Then, sends updated total force (evenif user doesn't send cmd) (user + obstacles)
+    send_total_force_to_d(&bb->cur_force,
+                          &bb->cur_state,
+                          params,
+                          g_obstacles,
+                          g_obs_pool.cap,
+                          &bb->obs_grid,
+                          &bb->rep_field,
+                          link,
+                          BLOG_REASON_STATE);
+    return hits;
+}
+
+// Hit-tests the swarm: same radius as check_target_hits(), one target is
+// collected by at most one drone. Targets outside, drones inside: the inner
+// loop is a plain scan over the SoA arrays.
+// ----------------------------------------------------------------------
+int bb_handle_swarm(Blackboard *bb, const double *x, const double *y, int n,
+                    const SimParams *params)
+{
+    if (bb->paused || n <= 0) return 0;
+
+    double R_hit  = params->world_half * HIT_RADIUS_FACTOR;
+    double R_hit2 = R_hit * R_hit;
+    int    hits   = 0;
+
+    for (int k = g_tgt_pool.count - 1; k >= 0; --k) {
+        int t = g_tgt_pool.live[k];
+
+        double tx = g_targets[t].x, ty = g_targets[t].y;
+        int    hit = 0;
+        for (int i = 0; i < n; ++i) {
+            double dx = x[i] - tx, dy = y[i] - ty;
+            hit |= (dx*dx + dy*dy <= R_hit2);
+        }
+        if (hit) {
+            target_remove(t);
+            hits++;
+        }
+    }
+
+    if (hits > 0) {
+        bb->score             += hits;
+        bb->targets_collected += hits;
+        bb->swarm_hits        += hits;
+        bb->last_hit_step      = bb->step_counter;
+        blog_hit(hits, bb->score, bb->step_counter);
+    }
+    return hits;
+}
+
+// Filters and stores an obstacle batch from O.
+// ----------------------------------------------------------------------
+void bb_accept_obstacles(Blackboard *bb, const ObstacleSetMsg *msg,
+                         const SimParams *params, FILE *logfile)
+{
+    if (bb->paused) {
+        // Reads but ignores new obstacles while paused
+        blog_batch(BLOG_OBS_BATCH, msg->count, 0, 1);
+        if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(logfile,
+                    "[B] Received obstacle set but PAUSED -> ignored.\n");
+            fflush(logfile);
+        }
+        return;
+    }
+
+    int requested = msg->count;
+
+    // Uses a clearance similar to what we used for targets
+    double tgt_clearance = params->world_half * SPAWN_CLEARANCE_FACTOR;
+
+    int accepted = 0;
+    int full     = 0;   // rejected for lack of a free slot
+    int first    = g_obs_pool.count;   // accepted slots are live[first..]
+
+    for (int i = 0; i < requested; ++i) {
+        double x = msg->obs[i].x;
+        double y = msg->obs[i].y;
+
+        // Rejects if too close to any live target
+        if (pointgrid_any_within(&g_tgt_index, x, y, tgt_clearance)) {
+            if (BLOG_ON(LOG_CAT_SPAWN, LOG_DEBUG)) {
+                fprintf(logfile,
+                        "[B] Obstacle (%.2f, %.2f) rejected: too close to target.\n",
+                        x, y);
+            }
+            continue;
+        }
+
+        // Stores it in a free slot; older obstacles stay until they expire
+        if (obstacle_add(x, y, msg->obs[i].life_steps) < 0) {
+            full++;
+            continue;
+        }
+        accepted++;
+    }
+
+    // Stores the live obstacles for the repulsion sum (full scan if this fails)
+    if (accepted > 0 &&
+        obsgrid_build(&bb->obs_grid, g_obstacles, g_obs_pool.live, g_obs_pool.count,
+                      params) == -1 && logfile) {
+        fprintf(logfile, "[B] Obstacle grid build failed, scanning all obstacles.\n");
+        fflush(logfile);
+    }
+
+    blog_batch(BLOG_OBS_BATCH, requested, accepted, 0);
+    for (int k = first; k < g_obs_pool.count; ++k) {
+        int i = g_obs_pool.live[k];
+        blog_item(BLOG_OBS_ITEM, g_obstacles[i].x, g_obstacles[i].y, g_obstacles[i].life_steps);
+    }
+
+    if (full > 0 && BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+        fprintf(logfile,
+                "[B] Obstacle pool full (%d slots): %d obstacles dropped.\n",
+                g_obs_pool.cap, full);
+    }
+    if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+        fprintf(logfile,
+                "[B] Accepted %d obstacles (requested %d).\n",
+                accepted, requested);
+        fflush(logfile);
+    }
+}
+
+// Filters and stores a target batch from T.
+// ----------------------------------------------------------------------
+void bb_accept_targets(Blackboard *bb, const TargetSetMsg *msg,
+                       const SimParams *params, FILE *logfile)
+{
+    if (bb->paused) {
+        blog_batch(BLOG_TGT_BATCH, msg->count, 0, 1);
+        if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(logfile,
+                    "[B] Received target set but PAUSED -> ignored.\n");
+            fflush(logfile);
+        }
+        return;
+    }
+
+    int requested = msg->count;
+
+    // Tuning for filtering:
+    double wall_margin     = params->world_half * 0.20; // keep away from walls
+    double obs_clearance   = params->world_half * SPAWN_CLEARANCE_FACTOR; // away from obstacles
+
+    int accepted = 0;
+    int full     = 0;   // rejected for lack of a free slot
+    int first    = g_tgt_pool.count;   // accepted slots are live[first..]
+
+    for (int i = 0; i < requested; ++i) {
+        double x = msg->tgt[i].x;
+        double y = msg->tgt[i].y;
+
+        // Rejects if too close to walls
+        if (target_too_close_to_wall(x, y, params, wall_margin)) {
+            if (BLOG_ON(LOG_CAT_SPAWN, LOG_DEBUG)) {
+                fprintf(logfile,
+                        "[B] Target (%.2f,%.2f) rejected: too close to walls.\n",
+                        x, y);
+            }
+            continue;
+        }
+
+        // Rejects if too close to obstacles
+        if (pointgrid_any_within(&g_obs_index, x, y, obs_clearance)) {
+            if (BLOG_ON(LOG_CAT_SPAWN, LOG_DEBUG)) {
+                fprintf(logfile,
+                        "[B] Target (%.2f,%.2f) rejected: too close to obstacles.\n",
+                        x, y);
+            }
+            continue;
+        }
+
+        // Accepts target into a free slot if it passed the above checks
+        if (target_add(x, y, msg->tgt[i].life_steps) < 0) {
+            full++;
+            continue;
+        }
+        accepted++;
+    }
+
+    blog_batch(BLOG_TGT_BATCH, requested, accepted, 0);
+    for (int k = first; k < g_tgt_pool.count; ++k) {
+        int i = g_tgt_pool.live[k];
+        blog_item(BLOG_TGT_ITEM, g_targets[i].x, g_targets[i].y, g_targets[i].life_steps);
+    }
+
+    if (full > 0 && BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+        fprintf(logfile,
+                "[B] Target pool full (%d slots): %d targets dropped.\n",
+                g_tgt_pool.cap, full);
+    }
+    if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+        fprintf(logfile,
+                "[B] Accepted %d targets (requested %d).\n",
+                accepted, requested);
+        fflush(logfile);
+    }
+}
@@ -0,0 +1,314 @@
+// blog.c
+// Asynchronous binary logger (see headers/blog.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+
+#include "headers/blog.h"
+#include "headers/util.h"   // ensure_logs_dir
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(BlogKeyRec)    <= BLOG_PAYLOAD_MAX, "BlogKeyRec too large");
+_Static_assert(sizeof(BlogForceRec)  <= BLOG_PAYLOAD_MAX, "BlogForceRec too large");
+_Static_assert(sizeof(BlogHitRec)    <= BLOG_PAYLOAD_MAX, "BlogHitRec too large");
+_Static_assert(sizeof(BlogStateRec)  <= BLOG_PAYLOAD_MAX, "BlogStateRec too large");
+_Static_assert(BLOG_PAYLOAD_MAX / 8 <= 8, "word mask must fit in one byte");
+
+// Ring capacity in records (power of two): 8192 * 80 B = 640 KiB,
+// several seconds of B's worst-case record rate.
+#define BLOG_RING_CAP   8192u
+// Records written per write() call at most
+#define BLOG_BATCH      512u
+// Writer sleep when the ring is empty
+#define BLOG_IDLE_NS    20000000L   // 20 ms
+// Worst-case encoded record: 10-byte varint + type + len + mask + payload
+#define BLOG_ENC_MAX    (10 + 3 + BLOG_PAYLOAD_MAX)
+
+// Single-producer (the logging thread) / single-consumer (writer thread) ring.
+typedef struct {
+    _Alignas(64) _Atomic uint64_t tail;    // producer-owned
+    _Alignas(64) _Atomic uint64_t head;    // writer-owned
+    _Alignas(64) _Atomic uint64_t dropped;
+    BlogRecord slots[BLOG_RING_CAP];
+} BlogRing;
+
+static BlogRing    g_ring;
+static int         g_fd = -1;
+static bool        g_open = false;
+static atomic_bool g_stop = false;
+static pthread_t   g_writer;
+
+// Log gate of this process (see blog.h); everything on until configured
+unsigned char g_blog_level[LOG_CAT_COUNT] = { LOG_DEBUG, LOG_DEBUG, LOG_DEBUG, LOG_DEBUG, LOG_DEBUG };
+int           g_blog_every[LOG_CAT_COUNT] = { 1, 1, 1, 1, 1 };
+int           g_blog_count[LOG_CAT_COUNT];
+
+// Encoder state (writer thread only)
+static uint64_t    g_last_t;
+static uint8_t     g_prev[BLOG_TYPE_COUNT][BLOG_PAYLOAD_MAX];
+
+static uint64_t now_ns(void) {
+    // CLOCK_MONOTONIC is served by the vDSO: no kernel entry
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Writes a whole buffer, retrying on short writes / EINTR.
+static void write_all(const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(g_fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;   // disk error: drop the batch
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+}
+
+// Encodes one record (format in blog.h). Returns the encoded size.
+static size_t encode_record(const BlogRecord *r, uint8_t *out) {
+    uint8_t *p = out;
+
+    uint64_t dt = r->t_ns > g_last_t ? r->t_ns - g_last_t : 0;
+    g_last_t += dt;
+    do {
+        uint8_t b = dt & 0x7f;
+        dt >>= 7;
+        *p++ = b | (dt ? 0x80 : 0);
+    } while (dt);
+
+    uint16_t type = r->type < BLOG_TYPE_COUNT ? r->type : 0;
+    uint8_t  cur[BLOG_PAYLOAD_MAX] = {0};
+    memcpy(cur, r->payload, r->len);
+
+    *p++ = (uint8_t)type;
+    *p++ = (uint8_t)r->len;
+    uint8_t *mask = p++;
+    *mask = 0;
+
+    unsigned nwords = (r->len + 7u) / 8u;
+    for (unsigned w = 0; w < nwords; ++w) {
+        if (memcmp(cur + 8 * w, g_prev[type] + 8 * w, 8) != 0) {
+            *mask |= (uint8_t)(1u << w);
+            memcpy(p, cur + 8 * w, 8);
+            p += 8;
+        }
+    }
+    memcpy(g_prev[type], cur, sizeof(cur));
+    return (size_t)(p - out);
+}
+
+// Moves up to BLOG_BATCH records to disk. Returns how many were written.
+static unsigned drain_once(void) {
+    static uint8_t buf[BLOG_BATCH * BLOG_ENC_MAX];
+
+    uint64_t h = atomic_load_explicit(&g_ring.head, memory_order_relaxed);
+    uint64_t t = atomic_load_explicit(&g_ring.tail, memory_order_acquire);
+    unsigned n   = 0;
+    size_t   len = 0;
+
+    while (h != t && n < BLOG_BATCH) {
+        len += encode_record(&g_ring.slots[h & (BLOG_RING_CAP - 1)], buf + len);
+        h++;
+        n++;
+    }
+    atomic_store_explicit(&g_ring.head, h, memory_order_release);
+
+    if (len > 0) write_all(buf, len);
+    return n;
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    while (!atomic_load(&g_stop)) {
+        if (drain_once() == BLOG_BATCH) continue;   // more pending: no sleep
+
+        struct timespec ts = { 0, BLOG_IDLE_NS };
+        nanosleep(&ts, NULL);
+    }
+    while (drain_once() > 0) {
+        // final flush
+    }
+    return NULL;
+}
+
+void blog_configure(int proc, const LogParams *lp) {
+    if (proc < 0 || proc >= LOG_PROC_COUNT) return;
+    for (int c = 0; c < LOG_CAT_COUNT; ++c) {
+        g_blog_level[c] = lp->level[proc][c];
+        g_blog_every[c] = lp->sample[c] < 1 ? 1 : lp->sample[c];
+        g_blog_count[c] = g_blog_every[c] - 1;   // the first record is always kept
+    }
+}
+
+int blog_open(const char *name, const BlogPids *pids, const SimParams *params) {
+    ensure_logs_dir();
+
+    char path[256];
+    snprintf(path, sizeof(path), "logs/%s.blog", name);
+
+    g_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (g_fd == -1) return -1;
+
+    char ptext[4096];
+    int  plen = params_format(params, ptext, sizeof(ptext));
+    if (plen < 0) plen = 0;
+
+    struct timespec mono, wall;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME,  &wall);
+
+    BlogFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, BLOG_MAGIC, 4);
+    hdr.version    = BLOG_FORMAT_VERSION;
+    snprintf(hdr.process, sizeof(hdr.process), "%s", name);
+    hdr.pid        = (int32_t)getpid();
+    if (pids) hdr.pids = *pids;
+    hdr.t0_ns      = (uint64_t)mono.tv_sec * 1000000000ull + (uint64_t)mono.tv_nsec;
+    hdr.t0_unix_ns = (int64_t)wall.tv_sec * 1000000000ll + (int64_t)wall.tv_nsec;
+    hdr.params_len = (uint32_t)plen;
+    write_all(&hdr, sizeof(hdr));
+    write_all(ptext, (size_t)plen);
+
+    g_last_t = hdr.t0_ns;
+    memset(g_prev, 0, sizeof(g_prev));
+
+    atomic_store(&g_ring.head, 0);
+    atomic_store(&g_ring.tail, 0);
+    atomic_store(&g_ring.dropped, 0);
+    atomic_store(&g_stop, false);
+
+    // The writer runs with every signal blocked, so process-directed signals
+    // (watchdog SIGUSR2/SIGTERM, SIGINT, ...) keep reaching the main thread.
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int rc = pthread_create(&g_writer, NULL, writer_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (rc != 0) {
+        close(g_fd);
+        g_fd = -1;
+        return -1;
+    }
+    g_open = true;
+    return 0;
+}
+
+void blog_close(void) {
+    if (!g_open) return;
+    atomic_store(&g_stop, true);
+    pthread_join(g_writer, NULL);
+    close(g_fd);
+    g_fd   = -1;
+    g_open = false;
+}
+
+uint64_t blog_dropped(void) {
+    return atomic_load_explicit(&g_ring.dropped, memory_order_relaxed);
+}
+
+// Producer side: claims the next slot, copies the payload, publishes it.
+// ----------------------------------------------------------------------
+void blog_record(uint16_t type, const void *payload, uint16_t len) {
+    if (!g_open) return;
+    if (len > BLOG_PAYLOAD_MAX) len = BLOG_PAYLOAD_MAX;
+
+    uint64_t t = atomic_load_explicit(&g_ring.tail, memory_order_relaxed);
+    uint64_t h = atomic_load_explicit(&g_ring.head, memory_order_acquire);
+    if (t - h >= BLOG_RING_CAP) {
+        atomic_fetch_add_explicit(&g_ring.dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    BlogRecord *r = &g_ring.slots[t & (BLOG_RING_CAP - 1)];
+    r->t_ns     = now_ns();
+    r->type     = type;
+    r->len      = len;
+    r->reserved = 0;
+    memcpy(r->payload, payload, len);
+
+    atomic_store_explicit(&g_ring.tail, t + 1, memory_order_release);
+}
+
+// Typed helpers
+// ----------------------------------------------------------------------
+void blog_state(const DroneStateMsg *s) {
+    if (!BLOG_ON(LOG_CAT_STATE, LOG_INFO) || !blog_sample(LOG_CAT_STATE)) return;
+    BlogStateRec r = { s->x, s->y, s->vx, s->vy };
+    blog_record(BLOG_STATE, &r, sizeof(r));
+}
+
+void blog_key(char key, int ignored, double Fx, double Fy) {
+    if (!BLOG_ON(LOG_CAT_KEYS, LOG_INFO)) return;
+    BlogKeyRec k;
+    memset(&k, 0, sizeof(k));
+    k.key     = key;
+    k.ignored = (uint8_t)(ignored ? 1 : 0);
+    k.Fx      = Fx;
+    k.Fy      = Fy;
+    blog_record(BLOG_KEY, &k, sizeof(k));
+}
+
+void blog_force(int reason, const ForceStateMsg *user, double Px, double Py,
+                char best_key, int n_steps, const ForceStateMsg *out)
+{
+    if (!BLOG_ON(LOG_CAT_FORCE, LOG_INFO) || !blog_sample(LOG_CAT_FORCE)) return;
+    BlogForceRec f;
+    memset(&f, 0, sizeof(f));
+    f.user_Fx  = user->Fx;
+    f.user_Fy  = user->Fy;
+    f.Px       = Px;
+    f.Py       = Py;
+    f.Fx       = out->Fx;
+    f.Fy       = out->Fy;
+    f.reason   = (uint8_t)reason;
+    f.best_key = best_key;
+    f.n_steps  = (int16_t)n_steps;
+    blog_record(BLOG_FORCE, &f, sizeof(f));
+}
+
+void blog_hit(int hits, int score, int step) {
+    if (!BLOG_ON(LOG_CAT_STATE, LOG_INFO)) return;
+    BlogHitRec h = { hits, score, step };
+    blog_record(BLOG_HIT, &h, sizeof(h));
+}
+
+void blog_batch(int type, int requested, int accepted, int ignored) {
+    if (!BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) return;
+    BlogBatchRec b = { requested, accepted, ignored };
+    blog_record((uint16_t)type, &b, sizeof(b));
+}
+
+void blog_item(int type, double x, double y, int life_steps) {
+    if (!BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) return;
+    BlogItemRec it;
+    memset(&it, 0, sizeof(it));
+    it.x          = x;
+    it.y          = y;
+    it.life_steps = life_steps;
+    blog_record((uint16_t)type, &it, sizeof(it));
+}
+
+void blog_watchdog(int event, double hb_age) {
+    if (!BLOG_ON(LOG_CAT_WATCHDOG, LOG_INFO)) return;
+    BlogWatchdogRec w;
+    memset(&w, 0, sizeof(w));
+    w.event  = event;
+    w.hb_age = hb_age;
+    blog_record(BLOG_WATCHDOG, &w, sizeof(w));
+}
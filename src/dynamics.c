@@ -6,12 +6,227 @@
 #include "headers/dynamics.h"
 #include "headers/messages.h"
 #include "headers/util.h"
+#include "headers/blog.h"
+#include "headers/histogram.h"
+#include "headers/integrator.h"
+#include "headers/swarm.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>     // exit, strtod
 #include <errno.h>
 #include <time.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <math.h>       // llround
+#include <stdint.h>
+#include <string.h>     // memset
+
+// Scheduler statistics are written to the log every SCHED_REPORT_NS
+#define SCHED_REPORT_NS 10000000000ull   // 10 s
+
+// Step scheduler statistics (absolute deadlines t0 + k*dt)
+typedef struct {
+    uint64_t  steps;        // steps integrated
+    uint64_t  wakeups;      // loop passes
+    uint64_t  overruns;     // wake-ups that found at least one deadline already missed
+    uint64_t  missed;       // deadlines missed in total
+    uint64_t  dropped;      // missed steps that were not integrated (policy / cap)
+    Histogram jitter;       // |time between consecutive wake-ups - dt| (ns)
+    Histogram late;         // wake-up time minus deadline (ns)
+} SchedStats;
+
+// Returns CLOCK_MONOTONIC in nanoseconds.
+// ----------------------------------------------------------------------
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Sleeps until the absolute CLOCK_MONOTONIC time t_ns (returns at once if it passed).
+// ----------------------------------------------------------------------
+static void sleep_until_ns(uint64_t t_ns) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(t_ns / 1000000000ull);
+    ts.tv_nsec = (long)(t_ns % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        // interrupted: sleep again until the same deadline
+    }
+}
+
+// Stamps a state before it goes to B: its own sequence number and send
+// time, the force it was integrated with and when D picked that force up.
+// ----------------------------------------------------------------------
+static void stamp_state(DroneStateMsg *s, uint32_t *seq, const ForceStateMsg *f,
+                        uint64_t force_rx_ns)
+{
+    s->stamp.seq   = ++*seq;
+    s->stamp.ref   = f->stamp.seq;
+    s->stamp.t_ns  = mono_ns();
+    s->force_t_ns  = f->stamp.t_ns;
+    s->force_rx_ns = force_rx_ns;
+}
+
+// Adds the window statistics to the run totals and empties the window.
+// ----------------------------------------------------------------------
+static void sched_fold(SchedStats *total, SchedStats *window) {
+    total->steps    += window->steps;
+    total->wakeups  += window->wakeups;
+    total->overruns += window->overruns;
+    total->missed   += window->missed;
+    total->dropped  += window->dropped;
+    hist_merge(&total->jitter, &window->jitter);
+    hist_merge(&total->late,   &window->late);
+    memset(window, 0, sizeof(*window));
+}
+
+// Swarm of D: SoA state, kernel and throughput counters.
+typedef struct {
+    SwarmSoA  soa;
+    SwarmBuf *buf;         // shared with B, NULL = no swarm
+    int       kernel;      // SIMD_* in use
+    uint64_t  steps;       // swarm steps integrated
+    uint64_t  ns;          // time spent in swarm_step()
+} SwarmRun;
+
+// Allocates and lays out the swarm (no-op without a buffer). Returns 0 or -1.
+// ----------------------------------------------------------------------
+static int swarm_run_init(SwarmRun *sr, SwarmBuf *buf, const SimParams *params, FILE *log) {
+    memset(sr, 0, sizeof(*sr));
+    if (!buf || params->swarm <= 0) return 0;
+
+    if (swarm_alloc(&sr->soa, params->swarm) == -1) {
+        fprintf(log, "[D] swarm: cannot allocate %d drones, swarm off\n", params->swarm);
+        fflush(log);
+        return -1;
+    }
+    swarm_layout(&sr->soa, params);
+    sr->buf    = buf;
+    sr->kernel = swarm_select_kernel(params->swarm_simd);
+    swarm_buf_publish(buf, &sr->soa, 0);
+
+    fprintf(log, "[D] swarm: %d drones, kernel=%s (asked %s)\n",
+            params->swarm, simd_name(sr->kernel), simd_name(params->swarm_simd));
+    fflush(log);
+    return 0;
+}
+
+// Integrates the swarm for one dt under the commanded force and publishes it.
+// ----------------------------------------------------------------------
+static void swarm_run_step(SwarmRun *sr, const ForceStateMsg *f, const SimParams *params,
+                           uint64_t step)
+{
+    if (!sr->buf) return;
+
+    uint64_t t0 = mono_ns();
+    swarm_set_force(&sr->soa, f->Fx, f->Fy);
+    swarm_step(&sr->soa, params, sr->kernel);
+    sr->ns += mono_ns() - t0;
+    sr->steps++;
+
+    swarm_buf_publish(sr->buf, &sr->soa, step);
+}
+
+// Writes the swarm throughput since start: time per step and drones x steps per second.
+// ----------------------------------------------------------------------
+static void swarm_run_report(FILE *log, const SwarmRun *sr) {
+    if (!log || !sr->buf || sr->steps == 0) return;
+    double ns_step = (double)sr->ns / (double)sr->steps;
+    fprintf(log, "[D] swarm since start: %d drones x %llu steps, %.1f us/step, "
+            "%.3g drone-steps/s (kernel %s)\n",
+            sr->soa.n, (unsigned long long)sr->steps, ns_step * 1e-3,
+            ns_step > 0.0 ? 1e9 * (double)sr->soa.n / ns_step : 0.0,
+            simd_name(sr->kernel));
+    fflush(log);
+}
+
+// Writes the integrator counters since start (internal steps per dt, force evaluations).
+// ----------------------------------------------------------------------
+static void integ_report(FILE *log, const IntegState *st, uint64_t dts) {
+    if (!log || dts == 0) return;
+    fprintf(log, "[D] integ since start: dt=%llu steps=%llu (%.2f/dt) rejected=%llu evals=%llu (%.2f/dt)",
+            (unsigned long long)dts,
+            (unsigned long long)st->steps, (double)st->steps / (double)dts,
+            (unsigned long long)st->rejected,
+            (unsigned long long)st->evals, (double)st->evals / (double)dts);
+    if (st->rejected > 0 || st->h_min_used < st->h) {
+        fprintf(log, " h_min=%.3g ms", st->h_min_used * 1e3);
+    }
+    fprintf(log, "\n");
+    fflush(log);
+}
+
+// Lockstep mode: integrates exactly one dt per StepRequestMsg from B and
+// answers with the same step number, without sleeping. Returns at EOF.
+// ----------------------------------------------------------------------
+static void run_lockstep(int force_fd, int state_fd, const SimParams *params, FILE *log,
+                         SwarmRun *swarm, HeartbeatBoard *hb)
+{
+    DroneStateMsg s = (DroneStateMsg){ .x = 0.0, .y = 0.0, .vx = 0.0, .vy = 0.0 };
+    uint64_t steps = 0;
+    uint64_t t0    = mono_ns();
+    uint32_t seq   = 0;   // stamp of the last state
+
+    IntegState integ;
+    integ_init(&integ, params);
+
+    while (1) {
+        StepRequestMsg req;
+        ssize_t n = read(force_fd, &req, sizeof(req));
+        if (n == 0) {
+            fprintf(log, "[D] EOF on force pipe, exiting.\n");
+            break;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n != (ssize_t)sizeof(req)) {
+            fprintf(log, "[D] lockstep: bad request (%zd bytes), exiting.\n", n);
+            break;
+        }
+        uint64_t rx = mono_ns();
+
+        if (req.force.reset != 0) {
+            s = (DroneStateMsg){ .x = 0.0, .y = 0.0, .vx = 0.0, .vy = 0.0 };
+            if (swarm->buf) swarm_layout(&swarm->soa, params);
+        }
+        integrate_step(&s, &req.force, params, &integ);
+        swarm_run_step(swarm, &req.force, params, req.step);
+        stamp_state(&s, &seq, &req.force, rx);
+        blog_state(&s);
+        hb_beat(hb, HB_D);
+
+        StepReplyMsg rep;
+        rep.step  = req.step;
+        rep.state = s;
+        if (write(state_fd, &rep, sizeof(rep)) != (ssize_t)sizeof(rep)) {
+            if (errno != EPIPE) perror("[D] write step reply");
+            break;
+        }
+        steps++;
+    }
+
+    double wall = (double)(mono_ns() - t0) * 1e-9;
+    fprintf(log, "[D] lockstep: %llu steps in %.3f s (%.0f steps/s)\n",
+            (unsigned long long)steps, wall, wall > 0.0 ? (double)steps / wall : 0.0);
+    integ_report(log, &integ, steps);
+    swarm_run_report(log, swarm);
+}
+
+// Writes the scheduler counters and the jitter / lateness percentiles.
+// ----------------------------------------------------------------------
+static void sched_report(FILE *log, const char *what, const SchedStats *st) {
+    if (!log) return;
+    fprintf(log,
+            "[D] sched %s: steps=%llu wakeups=%llu overruns=%llu missed=%llu dropped=%llu\n",
+            what,
+            (unsigned long long)st->steps,
+            (unsigned long long)st->wakeups,
+            (unsigned long long)st->overruns,
+            (unsigned long long)st->missed,
+            (unsigned long long)st->dropped);
+    hist_print_us(log, "[D]   jitter", &st->jitter);
+    hist_print_us(log, "[D]   late  ", &st->late);
+    fflush(log);
+}
 
 /**
  * @brief Main loop for the Dynamics (D) process.
@@ -19,14 +234,32 @@
  * @details
  * Performs the physics simulation of the drone.
  * - **Architecture**: Receives force commands (user + obstacles) from Server (B) and sends back updated state (pos, vel).
- * - **Timing**: Runs at a fixed time step defined by params.dt (e.g., 0.01s).
- * - **Integration**: Uses simple Euler integration for velocity and position updates.
+ * - **Timing**: Runs at a fixed time step defined by params.dt (e.g., 0.01s). Step k is
+ *   due at the absolute time t0 + k*dt (clock_nanosleep TIMER_ABSTIME), so work time
+ *   does not accumulate as drift. Missed deadlines are caught up or dropped
+ *   (params.sched_policy); counts and jitter / lateness percentiles go to the log.
+ * - **Integration**: integrate_step() (integrator.c): semi-implicit Euler (default), RK4 or an
+ *   exact exponential update of the viscous term, with params.substeps internal steps per dt,
+ *   or the adaptive scheme, whose internal steps shrink only inside the wall clearance.
+ * 
+ * - **Transport**: In shm mode (ipc_mode=shm) forces and states go through the shared
+ *   seqlock mailbox instead; the pipes then only carry EOF (shutdown) information,
+ *   and D never blocks on B.
+ * - **Swarm**: with swarm=N, N more drones are integrated in a structure of arrays by the
+ *   SIMD kernels of swarm.c (same commanded force, own wall repulsion), and their positions
+ *   are published in the shared buffer before each state, so B sees them with that state.
  * 
  * @param force_fd File descriptor for reading ForceStateMsg from Server (B).
  * @param state_fd File descriptor for writing DroneStateMsg to Server (B).
  * @param params   Simulation parameters (Mass, Viscosity, Time step).
+ * @param ipc      Shared mailbox (shm mode), NULL in pipe mode.
+ * @param lockstep Lockstep mode (--lockstep): one step per request from B, no pacing.
+ * @param swarm_buf Shared swarm position buffer, NULL when params.swarm is 0.
+ * @param hb       Shared heartbeat counters: D beats once per wake-up (real time) or step.
  */
-void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
+void run_dynamics_process(int force_fd, int state_fd, SimParams params, ShmIpc *ipc,
+                          bool lockstep, SwarmBuf *swarm_buf, HeartbeatBoard *hb)
+{
     FILE *log = open_process_log("dynamics", "D");
     if (!log) {
         // If log fails, still run; or exit. I recommend exit for assignment clarity:
@@ -36,19 +269,45 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
 
     setbuf(stdout, NULL);
     fprintf(log,
-            "[D] Dynamics process started | PID = %d\n, M=%.3f, K=%.3f, dt=%.3f\n",
-            getpid(), params.mass, params.visc, params.dt);
+            "[D] Dynamics process started | PID = %d\n, M=%.3f, K=%.3f, dt=%.3f, "
+            "integrator=%s x%d\n",
+            getpid(), params.mass, params.visc, params.dt,
+            integrator_name(params.integrator), params.substeps);
+    fflush(log);
+
+    // Binary telemetry: one state record per step in logs/dynamics.blog
+    BlogPids bp = { (int32_t)getppid(), 0, (int32_t)getpid(), 0, 0, 0 };
+    if (blog_open("dynamics", &bp, &params) == -1) {
+        fprintf(log, "[D] cannot open logs/dynamics.blog, binary logging off\n");
+        fflush(log);
+    }
+
+    // B may exit with forces still queued in the pipe: the state write then
+    // fails with EPIPE (handled below) instead of killing D before its report.
+    signal(SIGPIPE, SIG_IGN);
+
+    SwarmRun swarm;
+    swarm_run_init(&swarm, swarm_buf, &params, log);
+
+    if (lockstep) {
+        fprintf(log, "[D] lockstep mode: stepping on request from B\n");
+        run_lockstep(force_fd, state_fd, &params, log, &swarm, hb);
+
+        swarm_free(&swarm.soa);
+        blog_close();
+        if (log) fclose(log);
+        close(force_fd);
+        close(state_fd);
+        exit(EXIT_SUCCESS);
+    }
 
-    double M = params.mass;
-    double K = params.visc;
     double T = params.dt;
 
-    ForceStateMsg f;
-    f.Fx = 0.0;
-    f.Fy = 0.0;
-    f.reset = 0;
+    ForceStateMsg f = { .Fx = 0.0, .Fy = 0.0, .reset = 0 };
+    uint64_t      f_rx_ns   = 0;   // when D picked f up
+    uint32_t      state_seq = 0;   // stamp of the last state
 
-    DroneStateMsg s = (DroneStateMsg){0.0, 0.0, 0.0, 0.0};
+    DroneStateMsg s = (DroneStateMsg){ .x = 0.0, .y = 0.0, .vx = 0.0, .vy = 0.0 };
 
     int flags = fcntl(force_fd, F_GETFL, 0);
     if (flags == -1) flags = 0;
@@ -57,18 +316,76 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
         perror("[D] fcntl O_NONBLOCK");
     }
 
-    while (1) {
+    uint32_t reset_seen = 0;   // shm mode: last reset generation handled
+
+    // Absolute-deadline schedule: the first step is due one period from now
+    static SchedStats total, window;   // whole run / since the last report (zeroed)
+
+    IntegState integ;
+    integ_init(&integ, &params);
+
+    uint64_t period_ns   = (uint64_t)llround(T * 1e9);
+    if (period_ns == 0) period_ns = 1;
+    uint64_t deadline    = mono_ns() + period_ns;
+    uint64_t last_wake   = 0;
+    uint64_t next_report = deadline + SCHED_REPORT_NS;
+    int      max_steps   = params.sched_policy == SCHED_DROP ? 1 : params.sched_max_catchup;
+    if (max_steps < 1) max_steps = 1;
+
+    fprintf(log, "[D] scheduler: period=%.3f ms policy=%s max_catchup=%d\n",
+            (double)period_ns * 1e-6,
+            params.sched_policy == SCHED_DROP ? "drop" : "catchup", max_steps);
+    fflush(log);
+
+    hb_watch(hb, HB_D, true);
+    bool running = true;
+    while (running) {
+        // Waits for the next deadline, then measures how late the wake-up is
+        sleep_until_ns(deadline);
+        hb_beat(hb, HB_D);
+        uint64_t now  = mono_ns();
+        uint64_t late = now > deadline ? now - deadline : 0;
+
+        if (last_wake != 0) {
+            uint64_t gap = now - last_wake;
+            hist_record(&window.jitter, gap > period_ns ? gap - period_ns : period_ns - gap);
+        }
+        hist_record(&window.late, late);
+        last_wake = now;
+        window.wakeups++;
+
+        // Whole periods already past the deadline = further deadlines missed
+        uint64_t missed = late / period_ns;
+        int      steps  = 1;
+        if (missed > 0) {
+            window.overruns++;
+            window.missed += missed;
+            steps = missed + 1 < (uint64_t)max_steps ? (int)(missed + 1) : max_steps;
+            window.dropped += missed + 1 - (uint64_t)steps;
+        }
+        deadline += (missed + 1) * period_ns;
+
         // Reads any new force command from B (non-blocking).
+        // In shm mode the pipe carries no data: it only reports EOF when B exits.
         ForceStateMsg new_f;
         int n = read(force_fd, &new_f, sizeof(new_f));
 
+        if (ipc && n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            mailbox_read_force(&ipc->shared->mbox, &new_f, &reset_seen);
+            n = (int)sizeof(new_f);
+        }
+
         if (n == (int)sizeof(new_f)) {
             if (new_f.reset != 0) {
                 s.x  = 0.0;
                 s.y  = 0.0;
                 s.vx = 0.0;
                 s.vy = 0.0;
+                if (swarm.buf) swarm_layout(&swarm.soa, &params);
             }
+            // shm mode reads the same force on every wake-up: a new one is
+            // told by its stamp
+            if (new_f.stamp.seq != f.stamp.seq) f_rx_ns = mono_ns();
             f = new_f;
             f.reset = 0;
         } else if (n == 0) {
@@ -84,52 +401,51 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
             fprintf(log, "[D] Partial read (%d bytes) on force pipe.\n", n);
         }
 
-        // Computes wall repulsive force from current state
-        double Pwx = 0.0, Pwy = 0.0;
-        compute_repulsive_P(&s, 
-                    &params, 
-                    0,
-                    0,
-                    true,   // calculate wall repulsion here
-                    false,   // obstactles treated in server side
-                    &Pwx, 
-                    &Pwy);
-        // Calculates total force = user force from B + wall repulsive force
-        double Fx_total = f.Fx + Pwx;
-        double Fy_total = f.Fy + Pwy;
-
-        // --------------------------------------------------------------
-        // Physics Model: Newton's Second Law with Viscous Damping
-        // F_net = F_user + F_repulsion - K * v
-        // a = F_net / M
-        // --------------------------------------------------------------
-        double ax = (Fx_total - K * s.vx) / M;
-        double ay = (Fy_total - K * s.vy) / M;
-
-        // --------------------------------------------------------------
-        // Numerical Integration: Standard Euler Method
-        // v(t+dt) = v(t) + a * dt
-        // x(t+dt) = x(t) + v(t+dt) * dt
-        // --------------------------------------------------------------
-        s.vx += ax * T;
-        s.vy += ay * T;
-
-        s.x  += s.vx * T;
-        s.y  += s.vy * T;
-
-        // Sends state back to B
-        if (write(state_fd, &s, sizeof(s)) == -1) {
-            perror("[D] write state");
-            break;
+        // Integrates the due steps (more than one only when catching up)
+        for (int k = 0; k < steps; ++k) {
+            integrate_step(&s, &f, &params, &integ);
+            swarm_run_step(&swarm, &f, &params, total.steps + window.steps + (uint64_t)k + 1);
+            stamp_state(&s, &state_seq, &f, f_rx_ns);
+
+            blog_state(&s);
+
+            // Sends state back to B
+            if (ipc) {
+                mailbox_publish_state(ipc, &s);
+            } else if (write(state_fd, &s, sizeof(s)) == -1) {
+                if (errno == EPIPE) {
+                    fprintf(log, "[D] B closed the state pipe, exiting.\n");
+                } else {
+                    perror("[D] write state");
+                }
+                running = false;
+                break;
+            }
         }
+        window.steps += (uint64_t)steps;
 
-        // Sleeps until next time step
-        struct timespec ts;
-        ts.tv_sec  = 0;
-        ts.tv_nsec = (long)(T * 1e9);
-        nanosleep(&ts, NULL);
+        // Periodic scheduler report (window), folded into the run totals
+        if (now >= next_report) {
+            if (BLOG_ON(LOG_CAT_STATE, LOG_INFO)) {
+                sched_report(log, "last 10 s", &window);
+                integ_report(log, &integ, total.steps + window.steps);
+                swarm_run_report(log, &swarm);
+            }
+            sched_fold(&total, &window);
+            next_report += SCHED_REPORT_NS;
+        }
     }
 
+    // Run totals
+    hb_watch(hb, HB_D, false);
+    sched_fold(&total, &window);
+    sched_report(log, "total", &total);
+    integ_report(log, &integ, total.steps);
+    swarm_run_report(log, &swarm);
+    swarm_free(&swarm.soa);
+
+    blog_close();
+    if (log) fclose(log);
     close(force_fd);
     close(state_fd);
     exit(EXIT_SUCCESS);
@@ -0,0 +1,53 @@
+// heartbeat.c
+// Shared heartbeat counters (see headers/heartbeat.h)
+// ======================================================================
+
+#include "headers/heartbeat.h"
+
+#include <errno.h>
+#include <sys/mman.h>     // mmap (anonymous shared mapping)
+#include <time.h>
+
+HeartbeatBoard *hb_create(void) {
+    // Anonymous shared mapping: inherited by fork(), zero-filled, nothing to unlink
+    void *p = mmap(NULL, sizeof(HeartbeatBoard), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : (HeartbeatBoard *)p;
+}
+
+void hb_destroy(HeartbeatBoard *hb) {
+    if (hb) munmap(hb, sizeof(*hb));
+}
+
+const char *hb_name(int who) {
+    static const char *const names[HB_COUNT] = { "B", "I", "D", "O", "T" };
+    return who >= 0 && who < HB_COUNT ? names[who] : "?";
+}
+
+void hb_watch(HeartbeatBoard *hb, int who, bool on) {
+    if (!hb) return;
+    hb_beat(hb, who);   // W restarts its stall clock from this beat
+    atomic_store_explicit(&hb->slot[who].watched, on ? 1u : 0u, memory_order_release);
+}
+
+// Absolute CLOCK_MONOTONIC deadlines, so the beats do not drift and the
+// whole sleep lasts sec seconds whatever the wake-up delays.
+// ----------------------------------------------------------------------
+void hb_sleep(HeartbeatBoard *hb, int who, unsigned sec) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t t   = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+    uint64_t end = t + (uint64_t)sec * 1000000000ull;
+
+    while (t < end) {
+        t += HB_IDLE_BEAT_NS;
+        if (t > end) t = end;
+
+        struct timespec ts;
+        ts.tv_sec  = (time_t)(t / 1000000000ull);
+        ts.tv_nsec = (long)(t % 1000000000ull);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+        hb_beat(hb, who);
+    }
+}
@@ -0,0 +1,90 @@
+// histogram.c
+// Log-linear latency histogram (see headers/histogram.h)
+// ======================================================================
+
+#include "headers/histogram.h"
+
+#include <string.h>
+
+// Maps a value to its bucket: values below HIST_SUB get one bucket each,
+// above that each power of two [2^k, 2^(k+1)) is split into HIST_SUB parts.
+// ----------------------------------------------------------------------
+static unsigned bucket_of(uint64_t v) {
+    if (v < HIST_SUB) return (unsigned)v;
+
+    unsigned msb   = 63u - (unsigned)__builtin_clzll(v);      // >= HIST_SUB_BITS
+    unsigned shift = msb - HIST_SUB_BITS;
+    unsigned sub   = (unsigned)(v >> shift) & (HIST_SUB - 1);
+    return (shift + 1) * HIST_SUB + sub;
+}
+
+// Largest value that falls into bucket b.
+static uint64_t bucket_upper(unsigned b) {
+    if (b < HIST_SUB) return b;
+
+    unsigned shift = b / HIST_SUB - 1;
+    uint64_t sub   = b % HIST_SUB;
+    uint64_t lo    = (HIST_SUB + sub) << shift;
+    return lo + ((1ull << shift) - 1);
+}
+
+void hist_reset(Histogram *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void hist_record(Histogram *h, uint64_t v) {
+    if (h->count == 0 || v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+    h->count++;
+    h->sum += v;
+    h->bucket[bucket_of(v)]++;
+}
+
+void hist_merge(Histogram *dst, const Histogram *src) {
+    if (src->count == 0) return;
+    if (dst->count == 0 || src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    dst->count += src->count;
+    dst->sum   += src->sum;
+    for (unsigned b = 0; b < HIST_BUCKETS; ++b) {
+        dst->bucket[b] += src->bucket[b];
+    }
+}
+
+uint64_t hist_percentile(const Histogram *h, double p) {
+    if (h->count == 0) return 0;
+    if (p <= 0.0)   return h->min;
+    if (p >= 100.0) return h->max;
+
+    // Rank of the wanted sample (1-based, rounded up)
+    uint64_t rank = (uint64_t)((p / 100.0) * (double)h->count);
+    if ((double)rank < (p / 100.0) * (double)h->count) rank++;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < HIST_BUCKETS; ++b) {
+        seen += h->bucket[b];
+        if (seen >= rank) {
+            uint64_t v = bucket_upper(b);
+            return v > h->max ? h->max : v;
+        }
+    }
+    return h->max;
+}
+
+double hist_mean(const Histogram *h) {
+    return h->count ? (double)h->sum / (double)h->count : 0.0;
+}
+
+void hist_print_us(FILE *out, const char *label, const Histogram *h) {
+    fprintf(out,
+            "%s n=%llu min=%.1f p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f (us)\n",
+            label,
+            (unsigned long long)h->count,
+            (double)h->min * 1e-3,
+            (double)hist_percentile(h, 50.0)  * 1e-3,
+            (double)hist_percentile(h, 90.0)  * 1e-3,
+            (double)hist_percentile(h, 99.0)  * 1e-3,
+            (double)hist_percentile(h, 99.9)  * 1e-3,
+            (double)h->max * 1e-3);
+}
@@ -0,0 +1,182 @@
+// integ_bench.c
+// Accuracy-versus-cost table of D's integrators (make integ-table)
+//   - Runs each integrator / dt / substeps combination on fixed scenarios
+//     and compares it with a high-resolution reference (RK4, h = 1e-5 s)
+//   - Error = position distance to the reference at common sample times
+//   - Cost  = force evaluations and wall-clock ns per dt (= per B<->D message)
+//   - out   = samples found outside the world (a blow-up at the walls)
+// Usage: ./integ_bench [--csv]
+// ======================================================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "headers/integrator.h"
+#include "headers/params.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_SECONDS   20.0    // simulated time per scenario
+#define SAMPLE_DT     0.2     // error sample period (multiple of every dt below)
+#define REF_DT        1e-5    // reference step
+#define TIMING_REPS   20      // repetitions for the ns/dt figure
+
+typedef struct {
+    const char   *name;
+    DroneStateMsg s0;
+    ForceStateMsg f;      // constant user force
+} Scenario;
+
+typedef struct {
+    int    integrator;
+    double dt;
+    int    substeps;
+    double tol;           // adapt_tol (adaptive only)
+} Config;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// Integrates a scenario with cfg and records the position at each sample time.
+// Returns the force evaluations done.
+static uint64_t run(const SimParams *base, const Scenario *sc, const Config *cfg,
+                    double *xs, double *ys, int nsamples)
+{
+    SimParams p = *base;
+    p.integrator = cfg->integrator;
+    p.dt         = cfg->dt;
+    p.substeps   = cfg->substeps;
+    if (cfg->tol > 0.0) p.adapt_tol = cfg->tol;
+
+    IntegState st;
+    integ_init(&st, &p);
+
+    int per_sample = (int)lround(SAMPLE_DT / cfg->dt);
+    DroneStateMsg s = sc->s0;
+    for (int k = 0; k < nsamples; ++k) {
+        for (int i = 0; i < per_sample; ++i) {
+            integrate_step(&s, &sc->f, &p, &st);
+        }
+        xs[k] = s.x;
+        ys[k] = s.y;
+    }
+    return st.evals;
+}
+
+// Short label of a configuration ("rk4", "adaptive 1e-4", ...).
+static const char *config_label(const Config *cfg, char *buf, size_t len) {
+    if (cfg->integrator == INTEG_ADAPTIVE) {
+        snprintf(buf, len, "adaptive %.0e", cfg->tol);
+    } else {
+        snprintf(buf, len, "%s", integrator_name(cfg->integrator));
+    }
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    int csv = (argc > 1 && strcmp(argv[1], "--csv") == 0);
+
+    SimParams base;
+    init_default_params(&base);
+    base.wall_gain = 100.0;   // params.txt value: stiff near the walls
+
+    // Free flight (viscous term only), wall approach (stiff repulsion),
+    // corner dive (both walls, large force), ram (fast hit into a wall)
+    const Scenario scenarios[] = {
+        { "free",   { .x = 0.0,  .y = 0.0,  .vx = 0.0,  .vy = 0.0  }, { .Fx = 3.0,  .Fy = 2.0 } },
+        { "wall",   { .x = 40.0, .y = 0.0,  .vx = 15.0, .vy = 2.0  }, { .Fx = 4.0,  .Fy = 0.0 } },
+        { "corner", { .x = 38.0, .y = 38.0, .vx = 20.0, .vy = 20.0 }, { .Fx = 8.0,  .Fy = 8.0 } },
+        { "ram",    { .x = 30.0, .y = 0.0,  .vx = 40.0, .vy = 0.0  }, { .Fx = 20.0, .Fy = 0.0 } },
+    };
+    const int nsc = (int)(sizeof(scenarios) / sizeof(scenarios[0]));
+
+    const Config configs[] = {
+        { INTEG_SEMI_IMPLICIT, 0.05, 1, 0 },   // today's default
+        { INTEG_SEMI_IMPLICIT, 0.05, 4, 0 },
+        { INTEG_SEMI_IMPLICIT, 0.10, 1, 0 },
+        { INTEG_SEMI_IMPLICIT, 0.20, 1, 0 },
+        { INTEG_SEMI_IMPLICIT, 0.20, 4, 0 },
+        { INTEG_EXP,           0.05, 1, 0 },
+        { INTEG_EXP,           0.10, 1, 0 },
+        { INTEG_EXP,           0.20, 1, 0 },
+        { INTEG_EXP,           0.20, 4, 0 },
+        { INTEG_RK4,           0.05, 1, 0 },
+        { INTEG_RK4,           0.10, 1, 0 },
+        { INTEG_RK4,           0.20, 1, 0 },
+        { INTEG_RK4,           0.20, 4, 0 },
+        { INTEG_ADAPTIVE,      0.05, 1, 1e-4 },
+        { INTEG_ADAPTIVE,      0.20, 1, 1e-3 },
+        { INTEG_ADAPTIVE,      0.20, 1, 1e-4 },
+        { INTEG_ADAPTIVE,      0.20, 1, 1e-6 },
+    };
+    const int ncfg = (int)(sizeof(configs) / sizeof(configs[0]));
+
+    enum { NSAMPLES = (int)(SIM_SECONDS / SAMPLE_DT) };
+    static double rx[NSAMPLES], ry[NSAMPLES], xs[NSAMPLES], ys[NSAMPLES];
+
+    if (csv) {
+        printf("scenario,integrator,dt,substeps,msgs_per_s,evals_per_s,ns_per_dt,us_per_sim_s,max_err,final_err,out\n");
+    } else {
+        printf("Reference: rk4, h=%g s, %g s simulated, error sampled every %g s\n\n",
+               REF_DT, SIM_SECONDS, SAMPLE_DT);
+        printf("%-8s %-14s %5s %4s %7s %8s %8s %9s %11s %11s %4s\n",
+               "scenario", "integrator", "dt", "sub", "msgs/s", "evals/s", "ns/dt",
+               "us/sim_s", "max_err", "final_err", "out");
+    }
+
+    for (int si = 0; si < nsc; ++si) {
+        const Scenario *sc = &scenarios[si];
+
+        Config ref = { INTEG_RK4, SAMPLE_DT, (int)lround(SAMPLE_DT / REF_DT), 0 };
+        run(&base, sc, &ref, rx, ry, NSAMPLES);
+
+        for (int ci = 0; ci < ncfg; ++ci) {
+            const Config *cfg = &configs[ci];
+            uint64_t nevals = run(&base, sc, cfg, xs, ys, NSAMPLES);
+
+            double max_err = 0.0;
+            int    out     = 0;
+            for (int k = 0; k < NSAMPLES; ++k) {
+                double e = hypot(xs[k] - rx[k], ys[k] - ry[k]);
+                if (e > max_err) max_err = e;
+                if (fabs(xs[k]) > base.world_half || fabs(ys[k]) > base.world_half) out++;
+            }
+            double final_err = hypot(xs[NSAMPLES - 1] - rx[NSAMPLES - 1],
+                                     ys[NSAMPLES - 1] - ry[NSAMPLES - 1]);
+
+            // Cost: wall-clock per dt, best of TIMING_REPS runs
+            double best = 1e30;
+            for (int r = 0; r < TIMING_REPS; ++r) {
+                double t0 = now_sec();
+                run(&base, sc, cfg, xs, ys, NSAMPLES);
+                double t = now_sec() - t0;
+                if (t < best) best = t;
+            }
+            double msgs_per_s = 1.0 / cfg->dt;
+            double ns_per_dt  = 1e9 * best / (SIM_SECONDS * msgs_per_s);
+            double evals      = (double)nevals / SIM_SECONDS;
+            char   label[32];
+            config_label(cfg, label, sizeof(label));
+
+            if (csv) {
+                printf("%s,%s,%g,%d,%g,%g,%.1f,%.3f,%.3e,%.3e,%d\n",
+                       sc->name, label, cfg->dt, cfg->substeps,
+                       msgs_per_s, evals, ns_per_dt, ns_per_dt * msgs_per_s * 1e-3,
+                       max_err, final_err, out);
+            } else {
+                printf("%-8s %-14s %5.2f %4d %7.0f %8.0f %8.1f %9.3f %11.3e %11.3e %4d\n",
+                       sc->name, label, cfg->dt, cfg->substeps,
+                       msgs_per_s, evals, ns_per_dt, ns_per_dt * msgs_per_s * 1e-3,
+                       max_err, final_err, out);
+            }
+        }
+        if (!csv) printf("\n");
+    }
+    return 0;
+}
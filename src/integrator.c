@@ -0,0 +1,271 @@
+// integrator.c
+// Time integration of the drone dynamics (see headers/integrator.h)
+// ======================================================================
+
+#include "headers/integrator.h"
+#include "headers/util.h"   // compute_repulsive_P
+
+#include <math.h>
+#include <stddef.h>   // offsetof
+#include <string.h>
+
+// Total external force at state s: user force + wall repulsion (no viscous term).
+// ----------------------------------------------------------------------
+static void external_force(const DroneStateMsg *s, const ForceStateMsg *f,
+                           const SimParams *params, double *Fx, double *Fy)
+{
+    double Pwx = 0.0, Pwy = 0.0;
+    compute_repulsive_P(s,
+                        params,
+                        0,
+                        0,
+                        true,    // wall repulsion is computed in D
+                        false,   // obstacles are handled on the server side
+                        &Pwx,
+                        &Pwy);
+    *Fx = f->Fx + Pwx;
+    *Fy = f->Fy + Pwy;
+}
+
+// Semi-implicit (symplectic) Euler: the original update of D.
+//   v(t+h) = v(t) + a(x, v) * h
+//   x(t+h) = x(t) + v(t+h) * h
+// ----------------------------------------------------------------------
+static void step_semi_implicit(DroneStateMsg *s, const ForceStateMsg *f,
+                               const SimParams *params, double h)
+{
+    double Fx, Fy;
+    external_force(s, f, params, &Fx, &Fy);
+
+    double ax = (Fx - params->visc * s->vx) / params->mass;
+    double ay = (Fy - params->visc * s->vy) / params->mass;
+
+    s->vx += ax * h;
+    s->vy += ay * h;
+    s->x  += s->vx * h;
+    s->y  += s->vy * h;
+}
+
+// Derivative of the state (dx/dt = v, dv/dt = a) for RK4.
+static DroneStateMsg deriv(const DroneStateMsg *s, const ForceStateMsg *f,
+                           const SimParams *params)
+{
+    double Fx, Fy;
+    external_force(s, f, params, &Fx, &Fy);
+
+    DroneStateMsg d;
+    d.x  = s->vx;
+    d.y  = s->vy;
+    d.vx = (Fx - params->visc * s->vx) / params->mass;
+    d.vy = (Fy - params->visc * s->vy) / params->mass;
+    return d;
+}
+
+// Returns s + k * h (component-wise).
+static DroneStateMsg add_scaled(const DroneStateMsg *s, const DroneStateMsg *k, double h) {
+    DroneStateMsg r;
+    r.x  = s->x  + k->x  * h;
+    r.y  = s->y  + k->y  * h;
+    r.vx = s->vx + k->vx * h;
+    r.vy = s->vy + k->vy * h;
+    return r;
+}
+
+// Classic 4th-order Runge-Kutta on (x, y, vx, vy): four force evaluations.
+// ----------------------------------------------------------------------
+static void step_rk4(DroneStateMsg *s, const ForceStateMsg *f,
+                     const SimParams *params, double h)
+{
+    DroneStateMsg k1 = deriv(s, f, params);
+    DroneStateMsg s2 = add_scaled(s, &k1, 0.5 * h);
+    DroneStateMsg k2 = deriv(&s2, f, params);
+    DroneStateMsg s3 = add_scaled(s, &k2, 0.5 * h);
+    DroneStateMsg k3 = deriv(&s3, f, params);
+    DroneStateMsg s4 = add_scaled(s, &k3, h);
+    DroneStateMsg k4 = deriv(&s4, f, params);
+
+    s->x  += h / 6.0 * (k1.x  + 2.0 * k2.x  + 2.0 * k3.x  + k4.x);
+    s->y  += h / 6.0 * (k1.y  + 2.0 * k2.y  + 2.0 * k3.y  + k4.y);
+    s->vx += h / 6.0 * (k1.vx + 2.0 * k2.vx + 2.0 * k3.vx + k4.vx);
+    s->vy += h / 6.0 * (k1.vy + 2.0 * k2.vy + 2.0 * k3.vy + k4.vy);
+}
+
+// Exponential update: exact for M*dv/dt = F - K*v with F frozen over h,
+// so the viscous term never limits the step. F is evaluated at the
+// predicted midpoint x + v*h/2 (one evaluation, second order in the wall
+// force). With c = K/M, e = exp(-c*h) and the terminal velocity v_inf = F/K:
+//   v(t+h) = v_inf + (v - v_inf) * e
+//   x(t+h) = x + v_inf * h + (v - v_inf) * (1 - e) / c
+// ----------------------------------------------------------------------
+static void step_exp(DroneStateMsg *s, const ForceStateMsg *f,
+                     const SimParams *params, double h)
+{
+    DroneStateMsg mid = *s;
+    mid.x += 0.5 * h * s->vx;
+    mid.y += 0.5 * h * s->vy;
+
+    double Fx, Fy;
+    external_force(&mid, f, params, &Fx, &Fy);
+
+    double M = params->mass;
+    double K = params->visc;
+
+    if (K <= 0.0) {
+        // No damping: constant acceleration over h (also exact)
+        double ax = Fx / M, ay = Fy / M;
+        s->x  += s->vx * h + 0.5 * ax * h * h;
+        s->y  += s->vy * h + 0.5 * ay * h * h;
+        s->vx += ax * h;
+        s->vy += ay * h;
+        return;
+    }
+
+    double c     = K / M;
+    double e     = exp(-c * h);
+    double g     = -expm1(-c * h) / c;   // (1 - e) / c, accurate for small c*h
+    double vinfx = Fx / K, vinfy = Fy / K;
+
+    s->x  += vinfx * h + (s->vx - vinfx) * g;
+    s->y  += vinfy * h + (s->vy - vinfy) * g;
+    s->vx  = vinfx + (s->vx - vinfx) * e;
+    s->vy  = vinfy + (s->vy - vinfy) * e;
+}
+
+// Bogacki-Shampine 3(2) step of size h from s (k1 = derivative at s).
+// Writes the 3rd-order solution to *out, its derivative to *k4 (the next
+// k1) and returns the scaled error norm (<= 1 means within tolerance).
+// ----------------------------------------------------------------------
+static double step_bs23(const DroneStateMsg *s, const DroneStateMsg *k1,
+                        const ForceStateMsg *f, const SimParams *params, double h,
+                        DroneStateMsg *out, DroneStateMsg *k4)
+{
+    DroneStateMsg s2 = add_scaled(s, k1, 0.5 * h);
+    DroneStateMsg k2 = deriv(&s2, f, params);
+    DroneStateMsg s3 = add_scaled(s, &k2, 0.75 * h);
+    DroneStateMsg k3 = deriv(&s3, f, params);
+
+    out->x  = s->x  + h * (2.0 / 9.0 * k1->x  + 1.0 / 3.0 * k2.x  + 4.0 / 9.0 * k3.x);
+    out->y  = s->y  + h * (2.0 / 9.0 * k1->y  + 1.0 / 3.0 * k2.y  + 4.0 / 9.0 * k3.y);
+    out->vx = s->vx + h * (2.0 / 9.0 * k1->vx + 1.0 / 3.0 * k2.vx + 4.0 / 9.0 * k3.vx);
+    out->vy = s->vy + h * (2.0 / 9.0 * k1->vy + 1.0 / 3.0 * k2.vy + 4.0 / 9.0 * k3.vy);
+    *k4 = deriv(out, f, params);
+
+    // Difference with the embedded 2nd-order solution
+    //   e = h * (-5/72 k1 + 1/12 k2 + 1/9 k3 - 1/8 k4)
+    double e[4] = {
+        h * (-5.0 / 72.0 * k1->x  + 1.0 / 12.0 * k2.x  + 1.0 / 9.0 * k3.x  - 0.125 * k4->x),
+        h * (-5.0 / 72.0 * k1->y  + 1.0 / 12.0 * k2.y  + 1.0 / 9.0 * k3.y  - 0.125 * k4->y),
+        h * (-5.0 / 72.0 * k1->vx + 1.0 / 12.0 * k2.vx + 1.0 / 9.0 * k3.vx - 0.125 * k4->vx),
+        h * (-5.0 / 72.0 * k1->vy + 1.0 / 12.0 * k2.vy + 1.0 / 9.0 * k3.vy - 0.125 * k4->vy),
+    };
+    double y[4] = { out->x, out->y, out->vx, out->vy };
+
+    // Mixed absolute / relative tolerance, max norm
+    double tol = params->adapt_tol;
+    double err = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        double r = fabs(e[i]) / (tol * (1.0 + fabs(y[i])));
+        if (r > err) err = r;
+    }
+    return err;
+}
+
+// Adaptive integration over one dt: BS23 steps with the standard controller
+//   h_new = h * clamp(0.9 * err^(-1/3), 0.2, 5)
+// A step is clipped to end on the dt boundary, but the controller's h is
+// kept for the next dt, so clipping does not shrink the following steps.
+// ----------------------------------------------------------------------
+static void integrate_adaptive(DroneStateMsg *s, const ForceStateMsg *f,
+                               const SimParams *params, IntegState *st)
+{
+    IntegState local;
+    if (!st) {
+        integ_init(&local, params);
+        st = &local;
+    }
+
+    double dt    = params->dt;
+    double h_min = params->adapt_h_min < dt ? params->adapt_h_min : dt;
+    double h     = st->h > 0.0 ? st->h : dt;
+    if (h > dt) h = dt;
+
+    // Reuses the last derivative when nothing changed since the previous dt
+    // (position and velocity only: the stamp changes every step)
+    DroneStateMsg k1;
+    if (st->fsal_valid &&
+        memcmp(&st->fsal_s, s, offsetof(DroneStateMsg, stamp)) == 0 &&
+        st->fsal_f.Fx == f->Fx && st->fsal_f.Fy == f->Fy) {
+        k1 = st->fsal_k;
+    } else {
+        k1 = deriv(s, f, params);
+        st->evals++;
+    }
+
+    double t = 0.0;
+    while (dt - t > 1e-12 * dt) {
+        double rem  = dt - t;
+        double step = h < rem ? h : rem;
+
+        DroneStateMsg out, k4;
+        double err = step_bs23(s, &k1, f, params, step, &out, &k4);
+        st->evals += 3;
+
+        double fac = err > 0.0 ? 0.9 / cbrt(err) : 5.0;
+        if (fac < 0.2) fac = 0.2;
+        if (fac > 5.0) fac = 5.0;
+
+        if (err <= 1.0 || step <= h_min) {
+            // Accepted (a step at h_min is always accepted, so a dt always ends)
+            *s = out;
+            k1 = k4;
+            t += step;
+            st->steps++;
+            if (step < st->h_min_used) st->h_min_used = step;
+
+            // A clipped step that passed says nothing about a longer h
+            if (step == h) h = step * fac;
+        } else {
+            st->rejected++;
+            h = step * fac;
+        }
+        if (h < h_min) h = h_min;
+        if (h > dt)    h = dt;
+    }
+
+    st->h          = h;
+    st->fsal_valid = 1;
+    st->fsal_s     = *s;
+    st->fsal_k     = k1;
+    st->fsal_f     = *f;
+}
+
+void integ_init(IntegState *st, const SimParams *params) {
+    memset(st, 0, sizeof(*st));
+    st->h          = params->dt;
+    st->h_min_used = params->dt;
+}
+
+void integrate_step(DroneStateMsg *s, const ForceStateMsg *f, const SimParams *params,
+                    IntegState *st)
+{
+    if (params->integrator == INTEG_ADAPTIVE) {
+        integrate_adaptive(s, f, params, st);
+        return;
+    }
+
+    int    n = params->substeps > 1 ? params->substeps : 1;
+    double h = params->dt / (double)n;
+
+    for (int i = 0; i < n; ++i) {
+        switch (params->integrator) {
+            case INTEG_RK4: step_rk4(s, f, params, h);           break;
+            case INTEG_EXP: step_exp(s, f, params, h);           break;
+            default:        step_semi_implicit(s, f, params, h); break;
+        }
+    }
+
+    if (st) {
+        st->steps += (uint64_t)n;
+        st->evals += (uint64_t)n * (params->integrator == INTEG_RK4 ? 4u : 1u);
+    }
+}
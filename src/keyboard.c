@@ -5,18 +5,29 @@
 
 #include "headers/messages.h"
 #include "headers/util.h"
+#include "headers/keyboard.h"
+#include "headers/blog.h"   // BLOG_ON
+#include "headers/latency.h"   // lat_now_ns
 
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
 
 // ----------------------------------------------------------------------
 // Defines keyboard process:
-//   - Reads characters from stdin 
-//   - Wraps each into KeyMsg and writes to the pipe to B.
+//   - Reads characters from stdin: one read() takes every byte that is
+//     ready (bypassing stdio), so piped or scripted input costs one syscall
+//     per burst, not per key
+//   - Wraps each into KeyMsg, stamped with a sequence number and the time
+//     it was read, and writes it to the pipe to B, or pushes it into the
+//     shared key ring in shm mode (no syscall per key).
+//   - Waits for stdin in poll() slices of HB_IDLE_BEAT_NS and beats its
+//     heartbeat counter after each, so W sees I alive while nobody types.
 //   - Exits on EOF or 'q'.
 // ----------------------------------------------------------------------
-void run_keyboard_process(int write_fd) {
+void run_keyboard_process(int write_fd, ShmIpc *ipc, HeartbeatBoard *hb) {
     // Opens log file
     FILE *log = open_process_log("keyboard", "I");
     if (!log) log = stderr;   // <-- don't die, just log to stderr
@@ -29,34 +40,58 @@ void run_keyboard_process(int write_fd) {
     // Unbuffers stdout so debug messages appear immediately.
     setbuf(stdout, NULL);
 
+    uint32_t      seq  = 0;   // stamp of the last key (a dropped key leaves a gap)
+    struct pollfd in   = { STDIN_FILENO, POLLIN, 0 };
+    char          buf[256];   // keys taken by one read()
+    int           done = 0;
 
-    while (1) {
-        // reads one character from stdin
-        int c = getchar(); // blocking read 
+    hb_watch(hb, HB_I, true);
+    while (!done) {
+        hb_beat(hb, HB_I);
+        int ready = poll(&in, 1, (int)(HB_IDLE_BEAT_NS / 1000000ull));
+        if (ready == 0 || (ready < 0 && errno == EINTR)) continue;
 
-        if (c == EOF) {
+        // reads every ready character from stdin (ready, or EOF / error)
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+
+        if (n <= 0) {
             fprintf(log, "[I] EOF on stdin, exiting keyboard process.\n");
             break;
         }
 
-        KeyMsg km;
-        km.key = (char)c;
-        fprintf(log, "[I] key='%c' (%d)\n", km.key, (int)km.key);
+        // The keys of one read share its time stamp
+        uint64_t t_ns = lat_now_ns();
+        for (ssize_t i = 0; i < n && !done; ++i) {
+            KeyMsg km;
+            km.key        = buf[i];
+            km.stamp.seq  = ++seq;
+            km.stamp.ref  = 0;
+            km.stamp.t_ns = t_ns;
+            if (BLOG_ON(LOG_CAT_KEYS, LOG_DEBUG)) {
+                fprintf(log, "[I] key='%c' (%d)\n", km.key, (int)km.key);
+            }
 
 
-        // Sends key to B through pipe.
-        if (write(write_fd, &km, sizeof(km)) == -1) {
-            fprintf(log, "[I] write to B failed");
+            // Sends key to B through the ring (shm mode) or the pipe.
+            if (ipc) {
+                if (keyring_push(ipc, &km) == -1) {
+                    fprintf(log, "[I] key ring full, key '%c' dropped\n", km.key);
+                }
+            } else if (write(write_fd, &km, sizeof(km)) == -1) {
+                fprintf(log, "[I] write to B failed");
 
-            break;
-        }
+                done = 1;
+            }
 
-        if (km.key == 'q') {
-            fprintf(log, "[I] 'q' pressed, exiting keyboard process.\n");
-            break;
+            if (!done && km.key == 'q') {
+                fprintf(log, "[I] 'q' pressed, exiting keyboard process.\n");
+                done = 1;
+            }
         }
     }
     // Final cleanup
+    hb_watch(hb, HB_I, false);
     if (log) {
         fprintf(log, "[I] Exiting.\n");
         fclose(log);
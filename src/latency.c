@@ -0,0 +1,104 @@
+// latency.c
+// End-to-end latency histograms and sequence checks of B (see headers/latency.h)
+// ======================================================================
+
+#include "headers/latency.h"
+
+#include <string.h>
+
+void lat_init(LatencyStats *ls) {
+    memset(ls, 0, sizeof(*ls));
+    hist_reset(&ls->i_to_b);
+    hist_reset(&ls->b_to_d);
+    hist_reset(&ls->d_to_b);
+    hist_reset(&ls->key_to_state);
+}
+
+int seq_track(SeqTrack *t, uint32_t seq) {
+    if (seq == 0 || seq == t->last) return 0;
+
+    t->received++;
+    if (seq < t->last) {
+        t->reordered++;
+        return 0;
+    }
+    t->missed += (uint64_t)(seq - t->last - 1);
+    t->last    = seq;
+    return 1;
+}
+
+// Difference of two monotonic times, 0 if b is not after a (unstamped
+// message, or a clock read on another CPU a few ns behind).
+static uint64_t since(uint64_t a, uint64_t b) {
+    return b > a ? b - a : 0;
+}
+
+void lat_key_received(LatencyStats *ls, const KeyMsg *km, uint64_t now_ns) {
+    if (km->stamp.seq == 0) return;
+    seq_track(&ls->keys, km->stamp.seq);
+    hist_record(&ls->i_to_b, since(km->stamp.t_ns, now_ns));
+}
+
+void lat_key_applied(LatencyStats *ls, const KeyMsg *km, uint32_t force_seq) {
+    if (km->stamp.seq == 0) return;
+    if (ls->pending_count == LAT_PENDING_CAP) {
+        ls->pending_dropped++;
+        return;
+    }
+    int i = (ls->pending_head + ls->pending_count) % LAT_PENDING_CAP;
+    ls->pending[i].force_seq = force_seq;
+    ls->pending[i].key_t_ns  = km->stamp.t_ns;
+    ls->pending_count++;
+}
+
+void lat_state_received(LatencyStats *ls, const DroneStateMsg *s, uint64_t now_ns) {
+    if (s->stamp.seq == 0) return;
+    seq_track(&ls->states, s->stamp.seq);
+    hist_record(&ls->d_to_b, since(s->stamp.t_ns, now_ns));
+
+    // A force is counted once, with the first state that used it
+    if (!seq_track(&ls->forces, s->stamp.ref)) return;
+    hist_record(&ls->b_to_d, since(s->force_t_ns, s->force_rx_ns));
+
+    // Every pending key whose force (or a later one) is in this state
+    while (ls->pending_count > 0 &&
+           ls->pending[ls->pending_head].force_seq <= s->stamp.ref) {
+        hist_record(&ls->key_to_state, since(ls->pending[ls->pending_head].key_t_ns, now_ns));
+        ls->pending_head = (ls->pending_head + 1) % LAT_PENDING_CAP;
+        ls->pending_count--;
+    }
+}
+
+// One "received / missed / reordered" line of a stream.
+static void seq_print(FILE *out, const char *tag, const char *label, const SeqTrack *t) {
+    fprintf(out, "%s   seq %-10s received=%llu missed=%llu reordered=%llu last=%u\n",
+            tag, label,
+            (unsigned long long)t->received,
+            (unsigned long long)t->missed,
+            (unsigned long long)t->reordered,
+            t->last);
+}
+
+void lat_print(FILE *out, const char *tag, const LatencyStats *ls) {
+    if (!out) return;
+    char label[64];
+
+    fprintf(out, "%s latency since start:\n", tag);
+    snprintf(label, sizeof(label), "%s   I->B      ", tag);
+    hist_print_us(out, label, &ls->i_to_b);
+    snprintf(label, sizeof(label), "%s   B->D      ", tag);
+    hist_print_us(out, label, &ls->b_to_d);
+    snprintf(label, sizeof(label), "%s   D->B      ", tag);
+    hist_print_us(out, label, &ls->d_to_b);
+    snprintf(label, sizeof(label), "%s   key->state", tag);
+    hist_print_us(out, label, &ls->key_to_state);
+
+    seq_print(out, tag, "keys",   &ls->keys);
+    seq_print(out, tag, "forces", &ls->forces);
+    seq_print(out, tag, "states", &ls->states);
+    if (ls->pending_count > 0 || ls->pending_dropped > 0) {
+        fprintf(out, "%s   keys waiting for a state=%d, not tracked=%llu\n",
+                tag, ls->pending_count, (unsigned long long)ls->pending_dropped);
+    }
+    fflush(out);
+}
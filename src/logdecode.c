@@ -0,0 +1,298 @@
+// logdecode.c
+// Offline decoder for the binary logs (logs/*.blog) written by blog.c
+//   ./logdecode [--csv] FILE.blog [FILE.blog ...]
+//   - default: one readable line per record, file header as '#' comments
+//   - --csv  : one wide CSV table (t_s,type,... columns; unused cells empty),
+//              doubles printed with 17 significant digits (lossless)
+// The on-disk format is documented in headers/blog.h.
+// ======================================================================
+
+#include "headers/blog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *type_name(int type) {
+    switch (type) {
+        case BLOG_KEY:       return "KEY";
+        case BLOG_STATE:     return "STATE";
+        case BLOG_FORCE:     return "FORCE";
+        case BLOG_HIT:       return "HIT";
+        case BLOG_OBS_BATCH: return "OBS_BATCH";
+        case BLOG_OBS_ITEM:  return "OBS";
+        case BLOG_TGT_BATCH: return "TGT_BATCH";
+        case BLOG_TGT_ITEM:  return "TGT";
+        case BLOG_WATCHDOG:  return "WATCHDOG";
+        default:             return "UNKNOWN";
+    }
+}
+
+static const char *reason_name(int r) {
+    switch (r) {
+        case BLOG_REASON_INIT:  return "init";
+        case BLOG_REASON_KEY:   return "key";
+        case BLOG_REASON_STATE: return "state";
+        default:                return "?";
+    }
+}
+
+static const char *wd_name(int e) {
+    switch (e) {
+        case BLOG_WD_WARNING: return "warning";
+        case BLOG_WD_RESUMED: return "resumed";
+        case BLOG_WD_STOP:    return "stop";
+        default:              return "?";
+    }
+}
+
+// Reads the whole file into memory.
+static unsigned char *slurp(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    size_t cap = 1 << 16, n = 0;
+    unsigned char *buf = malloc(cap);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n, fp)) > 0) {
+        n += got;
+        if (n == cap) {
+            cap *= 2;
+            unsigned char *nb = realloc(buf, cap);
+            if (!nb) { free(buf); buf = NULL; }
+            buf = nb;
+        }
+    }
+    fclose(fp);
+    *len = n;
+    return buf;
+}
+
+static const char CSV_HEADER[] =
+    "file,t_s,type,key,ignored,x,y,vx,vy,user_Fx,user_Fy,Px,Py,Fx,Fy,"
+    "reason,best_key,n_steps,hits,score,step,requested,accepted,life_steps,event,hb_age";
+
+// Prints one decoded record.
+static void print_record(const char *file, int csv, double t, int type, const uint8_t *pl) {
+    if (!csv) {
+        printf("%14.9f %-9s ", t, type_name(type));
+        switch (type) {
+        case BLOG_KEY: {
+            BlogKeyRec k; memcpy(&k, pl, sizeof(k));
+            printf("key=%c%s Fx=%.9g Fy=%.9g\n", k.key, k.ignored ? " (ignored, paused)" : "", k.Fx, k.Fy);
+            break; }
+        case BLOG_STATE: {
+            BlogStateRec s; memcpy(&s, pl, sizeof(s));
+            printf("x=%.9g y=%.9g vx=%.9g vy=%.9g\n", s.x, s.y, s.vx, s.vy);
+            break; }
+        case BLOG_FORCE: {
+            BlogForceRec f; memcpy(&f, pl, sizeof(f));
+            printf("(%s) user=(%.9g,%.9g) P=(%.9g,%.9g) key=%c n=%d -> F=(%.9g,%.9g)\n",
+                   reason_name(f.reason), f.user_Fx, f.user_Fy, f.Px, f.Py,
+                   f.best_key ? f.best_key : '-', f.n_steps, f.Fx, f.Fy);
+            break; }
+        case BLOG_HIT: {
+            BlogHitRec h; memcpy(&h, pl, sizeof(h));
+            printf("hits=%d score=%d step=%d\n", h.hits, h.score, h.step);
+            break; }
+        case BLOG_OBS_BATCH:
+        case BLOG_TGT_BATCH: {
+            BlogBatchRec b; memcpy(&b, pl, sizeof(b));
+            printf("requested=%d accepted=%d%s\n", b.requested, b.accepted, b.ignored ? " (ignored, paused)" : "");
+            break; }
+        case BLOG_OBS_ITEM:
+        case BLOG_TGT_ITEM: {
+            BlogItemRec it; memcpy(&it, pl, sizeof(it));
+            printf("x=%.9g y=%.9g life=%d\n", it.x, it.y, it.life_steps);
+            break; }
+        case BLOG_WATCHDOG: {
+            BlogWatchdogRec w; memcpy(&w, pl, sizeof(w));
+            printf("%s hb_age=%.6f\n", wd_name(w.event), w.hb_age);
+            break; }
+        default:
+            printf("\n");
+        }
+        return;
+    }
+
+    // CSV: 26 columns, see CSV_HEADER
+    const char *c[26];
+    char cell[26][40];
+    for (int i = 0; i < 26; ++i) { c[i] = ""; cell[i][0] = '\0'; }
+#define SETD(i, v) (snprintf(cell[i], sizeof(cell[i]), "%.17g", (double)(v)), c[i] = cell[i])
+#define SETI(i, v) (snprintf(cell[i], sizeof(cell[i]), "%d", (int)(v)), c[i] = cell[i])
+#define SETC(i, v) (snprintf(cell[i], sizeof(cell[i]), "%c", (v)), c[i] = cell[i])
+
+    c[0] = file;
+    snprintf(cell[1], sizeof(cell[1]), "%.9f", t); c[1] = cell[1];
+    c[2] = type_name(type);
+
+    switch (type) {
+    case BLOG_KEY: {
+        BlogKeyRec k; memcpy(&k, pl, sizeof(k));
+        SETC(3, k.key); SETI(4, k.ignored); SETD(13, k.Fx); SETD(14, k.Fy);
+        break; }
+    case BLOG_STATE: {
+        BlogStateRec s; memcpy(&s, pl, sizeof(s));
+        SETD(5, s.x); SETD(6, s.y); SETD(7, s.vx); SETD(8, s.vy);
+        break; }
+    case BLOG_FORCE: {
+        BlogForceRec f; memcpy(&f, pl, sizeof(f));
+        SETD(9, f.user_Fx); SETD(10, f.user_Fy); SETD(11, f.Px); SETD(12, f.Py);
+        SETD(13, f.Fx); SETD(14, f.Fy);
+        c[15] = reason_name(f.reason); SETC(16, f.best_key ? f.best_key : '-'); SETI(17, f.n_steps);
+        break; }
+    case BLOG_HIT: {
+        BlogHitRec h; memcpy(&h, pl, sizeof(h));
+        SETI(18, h.hits); SETI(19, h.score); SETI(20, h.step);
+        break; }
+    case BLOG_OBS_BATCH:
+    case BLOG_TGT_BATCH: {
+        BlogBatchRec b; memcpy(&b, pl, sizeof(b));
+        SETI(21, b.requested); SETI(22, b.accepted); SETI(4, b.ignored);
+        break; }
+    case BLOG_OBS_ITEM:
+    case BLOG_TGT_ITEM: {
+        BlogItemRec it; memcpy(&it, pl, sizeof(it));
+        SETD(5, it.x); SETD(6, it.y); SETI(23, it.life_steps);
+        break; }
+    case BLOG_WATCHDOG: {
+        BlogWatchdogRec w; memcpy(&w, pl, sizeof(w));
+        c[24] = wd_name(w.event); SETD(25, w.hb_age);
+        break; }
+    }
+#undef SETD
+#undef SETI
+#undef SETC
+
+    for (int i = 0; i < 26; ++i) {
+        fputs(c[i], stdout);
+        fputc(i == 25 ? '\n' : ',', stdout);
+    }
+}
+
+// Decodes one file. Returns 0 on success.
+static int decode_file(const char *path, int csv) {
+    size_t len = 0;
+    unsigned char *buf = slurp(path, &len);
+    if (!buf) {
+        perror(path);
+        return 1;
+    }
+
+    BlogFileHeader hdr;
+    if (len < sizeof(hdr)) {
+        fprintf(stderr, "%s: too short for a blog header\n", path);
+        free(buf);
+        return 1;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (memcmp(hdr.magic, BLOG_MAGIC, 4) != 0 || hdr.version != BLOG_FORMAT_VERSION) {
+        fprintf(stderr, "%s: not a version %d blog file\n", path, BLOG_FORMAT_VERSION);
+        free(buf);
+        return 1;
+    }
+
+    size_t pos = sizeof(hdr);
+    if (pos + hdr.params_len > len) {
+        fprintf(stderr, "%s: truncated params block\n", path);
+        free(buf);
+        return 1;
+    }
+
+    if (!csv) {
+        char proc[sizeof(hdr.process) + 1];
+        memcpy(proc, hdr.process, sizeof(hdr.process));
+        proc[sizeof(hdr.process)] = '\0';
+
+        time_t secs = (time_t)(hdr.t0_unix_ns / 1000000000ll);
+        struct tm tm;
+        localtime_r(&secs, &tm);
+        char when[64];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+
+        printf("# file: %s\n", path);
+        printf("# format v%u, process=%s pid=%d\n", hdr.version, proc, hdr.pid);
+        printf("# pids: B=%d I=%d D=%d O=%d T=%d W=%d\n",
+               hdr.pids.pid_B, hdr.pids.pid_I, hdr.pids.pid_D,
+               hdr.pids.pid_O, hdr.pids.pid_T, hdr.pids.pid_W);
+        printf("# started: %s (t=0 below)\n", when);
+        printf("# params:\n");
+
+        const char *p = (const char *)buf + pos, *end = p + hdr.params_len;
+        while (p < end) {
+            const char *nl = memchr(p, '\n', (size_t)(end - p));
+            if (!nl) nl = end;
+            printf("#   %.*s\n", (int)(nl - p), p);
+            p = nl + 1;
+        }
+    }
+    pos += hdr.params_len;
+
+    uint8_t  prev[BLOG_TYPE_COUNT][BLOG_PAYLOAD_MAX];
+    memset(prev, 0, sizeof(prev));
+    uint64_t t = hdr.t0_ns;
+    long     nrec = 0;
+
+    while (pos < len) {
+        // varint dt
+        uint64_t dt = 0;
+        int shift = 0;
+        while (pos < len) {
+            uint8_t b = buf[pos++];
+            dt |= (uint64_t)(b & 0x7f) << shift;
+            shift += 7;
+            if (!(b & 0x80)) break;
+        }
+        if (pos + 3 > len) break;   // truncated tail (writer killed mid-batch)
+
+        uint8_t type = buf[pos++];
+        uint8_t plen = buf[pos++];
+        uint8_t mask = buf[pos++];
+        if (type >= BLOG_TYPE_COUNT || plen > BLOG_PAYLOAD_MAX) {
+            fprintf(stderr, "%s: corrupt record at offset %zu\n", path, pos - 3);
+            break;
+        }
+
+        unsigned nwords = (plen + 7u) / 8u;
+        int truncated = 0;
+        for (unsigned w = 0; w < nwords; ++w) {
+            if (!(mask & (1u << w))) continue;
+            if (pos + 8 > len) { truncated = 1; break; }
+            memcpy(prev[type] + 8 * w, buf + pos, 8);
+            pos += 8;
+        }
+        if (truncated) break;
+
+        t += dt;
+        print_record(path, csv, (double)(t - hdr.t0_ns) * 1e-9, type, prev[type]);
+        nrec++;
+    }
+
+    if (!csv) printf("# %ld record(s), %zu bytes\n", nrec, len);
+    free(buf);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int csv = 0;
+    int first = 1;
+
+    if (argc > 1 && strcmp(argv[1], "--csv") == 0) {
+        csv = 1;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [--csv] FILE.blog [FILE.blog ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (csv) puts(CSV_HEADER);
+
+    int rc = 0;
+    for (int i = first; i < argc; ++i) {
+        rc |= decode_file(argv[i], csv);
+    }
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
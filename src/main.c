@@ -15,12 +15,36 @@
  * 
  *       [Watchdog W] <--- (Signals) ------ [All Processes]
  * 
+ *       In shm mode (ipc_mode=shm) the B<->D pair exchanges state/force through
+ *       a shared seqlock mailbox and I pushes keys into a shared SPSC ring;
+ *       their pipes are kept for EOF detection only.
+ *       With swarm=N, D also publishes N swarm positions in a shared buffer read by B.
+ * 
  * **Key Responsibility**:
  * 1. Load configuration (params.txt).
- * 2. Create all communication pipes.
+ * 2. Create all communication pipes (and the shared mailbox in shm mode).
  * 3. Fork all child processes (I, D, O, T, W).
  * 4. Close unused pipe ends in each process (critical for EOF detection).
  * 5. Parent process becomes the Server (B).
+ *
+ * **Command line**:
+ *   ./arp1 [--headless] [--stats-file FILE] [--stats-interval SEC]
+ *          [--lockstep STEPS] [--script FILE]
+ *          [--record FILE] [--replay FILE [--replay-realtime]]
+ *   --headless        no ncurses; keys come from stdin (pipe a script),
+ *                     B prints a stats line every interval (stderr by default)
+ *   --stats-file      appends the stats lines to FILE (also works with the UI)
+ *   --stats-interval  seconds between stats lines (default 1)
+ *   --lockstep        B and D step in lockstep, as fast as the CPU allows,
+ *                     for STEPS steps (uses the pipes, even with ipc_mode=shm)
+ *   --script          applies keys at given step numbers ("<step> <keys>" lines)
+ *   --record          writes every key and obstacle / target batch B applies,
+ *                     with its step number, to FILE (record.h)
+ *   --replay          runs a recording: its params, its inputs in place of
+ *                     I, O and T (O and T are not started), in lockstep for
+ *                     the recorded number of steps, as fast as possible
+ *                     (a real-time recording also brings D's states)
+ *   --replay-realtime replays at the recorded pace (one step per dt)
  */
 
 #include "headers/params.h"
@@ -33,15 +57,84 @@
 #include "headers/targets.h"
 
 #include "headers/watchdog.h"
+#include "headers/shm_ipc.h"
+#include "headers/swarm.h"
+#include "headers/rng.h"
+#include "headers/blog.h"
+#include "headers/record.h"
 
 #include <unistd.h>
+#include <signal.h>
+#include <sys/prctl.h>   // PR_SET_PDEATHSIG
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--headless] [--stats-file FILE] [--stats-interval SEC]\n"
+            "          [--lockstep STEPS] [--script FILE]\n"
+            "          [--record FILE] [--replay FILE [--replay-realtime]]\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+// Child side: asks for SIGTERM when B (the parent) exits, so I, O, T and W
+// do not outlive a finished run. D is left out: it exits on EOF after
+// writing its own report.
+static void die_with_parent(pid_t parent) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != parent) exit(EXIT_SUCCESS);   // B already gone
+}
+
+// Parses the command line into the server options (the recording to
+// replay, if any, into *replay_path: main loads it).
+static void parse_args(int argc, char **argv, ServerOptions *opts, const char **replay_path) {
+    *replay_path = NULL;
+    opts->headless       = 0;
+    opts->stats_path     = NULL;
+    opts->stats_interval = 1.0;
+    opts->lockstep_steps = 0;
+    opts->script_path    = NULL;
+    opts->record_path    = NULL;
+    opts->replay         = NULL;
+    opts->replay_realtime = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            opts->headless = 1;
+        } else if (strcmp(argv[i], "--stats-file") == 0 && i + 1 < argc) {
+            opts->stats_path = argv[++i];
+        } else if (strcmp(argv[i], "--stats-interval") == 0 && i + 1 < argc) {
+            opts->stats_interval = strtod(argv[++i], NULL);
+            if (opts->stats_interval <= 0.0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--lockstep") == 0 && i + 1 < argc) {
+            opts->lockstep_steps = strtol(argv[++i], NULL, 10);
+            if (opts->lockstep_steps <= 0) usage(argv[0]);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            opts->script_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            opts->record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            *replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay-realtime") == 0) {
+            opts->replay_realtime = 1;
+        } else {
+            usage(argv[0]);
+        }
+    }
+}
+
+
+int main(int argc, char **argv) {
+    ServerOptions opts;
+    const char   *replay_path;
+    parse_args(argc, argv, &opts, &replay_path);
+    if (opts.replay_realtime && !replay_path) usage(argv[0]);
 
 
-int main(void) {
     // Ensures logs/ directory exists
     ensure_logs_dir();
 
@@ -50,6 +143,38 @@ int main(void) {
     init_default_params(&params);
     load_params_from_file("params.txt", &params);
 
+    // Random seed: resolved once so every child derives its stream from the
+    // same value, and printed so a run with seed=0 can be replayed
+    if (params.seed == 0) params.seed = rng_clock_seed();
+
+    // Replay: the recording brings its own params and inputs, and runs in
+    // lockstep for the recorded number of steps (unless --lockstep says otherwise)
+    Replay replay;
+    if (replay_path) {
+        if (replay_load(replay_path, &replay) == -1) exit(EXIT_FAILURE);
+        params = replay.hdr.params;
+        opts.replay = &replay;
+        if (opts.script_path) {
+            fprintf(stderr, "[MAIN] --script ignored: the recorded keys are replayed\n");
+            opts.script_path = NULL;
+        }
+        if (opts.lockstep_steps == 0) {
+            uint64_t steps = replay.has_end ? replay.end.steps : replay.last_step;
+            opts.lockstep_steps = steps > 0 ? (long)steps : 1;
+        }
+        fprintf(stderr, "[MAIN] replaying '%s': %zu input(s), %ld step(s)%s%s\n",
+                replay_path, replay.inputs, opts.lockstep_steps,
+                replay.hdr.lockstep ? "" : ", real-time run (states from the recording)",
+                replay.has_end ? "" : ", recording cut short");
+    }
+    fprintf(stderr, "[MAIN] seed=%llu\n", (unsigned long long)params.seed);
+
+    // Lockstep exchanges numbered request/reply messages over the pipes
+    if (opts.lockstep_steps > 0 && params.ipc_mode == IPC_MODE_SHM) {
+        fprintf(stderr, "[MAIN] --lockstep uses the B<->D pipes, ignoring ipc_mode=shm\n");
+        params.ipc_mode = IPC_MODE_PIPE;
+    }
+
     // 2) Creates pipes:
     //    - I -> B
     //    - B -> D
@@ -74,7 +199,29 @@ int main(void) {
     if (pipe(pipe_T_to_B) == -1) die("pipe T->B");
 
     if (pipe(pipe_CFG_to_W) == -1) die("pipe CFG->W");
+
+    // Shared B<->D mailbox and I->B key ring (shm mode only), inherited by the forked children
+    ShmIpc  shm_ipc;
+    ShmIpc *ipc = NULL;
+    if (params.ipc_mode == IPC_MODE_SHM) {
+        if (shm_ipc_create(&shm_ipc) == -1) die("shm mailbox");
+        ipc = &shm_ipc;
+    }
+
+    // Heartbeat counters of B, I, D, O and T, polled by W
+    HeartbeatBoard *hb = hb_create();
+    if (!hb) die("heartbeat counters");
+
+    // Shared swarm positions D -> B (swarm=N only)
+    SwarmBuf  swarm_buf;
+    SwarmBuf *swarm = NULL;
+    if (params.swarm > 0) {
+        if (swarm_buf_create(&swarm_buf, params.swarm) == -1) die("swarm buffer");
+        swarm = &swarm_buf;
+    }
     
+    pid_t pid_B = getpid();
+
     // 3) Forks Keyboard process (I)
     pid_t pid_I = fork();
     if (pid_I == -1) die("fork I");
@@ -90,7 +237,9 @@ int main(void) {
         close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
         close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
 
-        run_keyboard_process(pipe_I_to_B[1]);
+        die_with_parent(pid_B);
+        blog_configure(LOG_PROC_KEYBOARD, &params.log);
+        run_keyboard_process(pipe_I_to_B[1], ipc, hb);
     }
 
     // 4) Forks Dynamics process (D)
@@ -108,14 +257,16 @@ int main(void) {
         close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
         close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
 
-        run_dynamics_process(pipe_B_to_D[0], pipe_D_to_B[1], params);
+        blog_configure(LOG_PROC_DYNAMICS, &params.log);
+        run_dynamics_process(pipe_B_to_D[0], pipe_D_to_B[1], params, ipc,
+                             opts.lockstep_steps > 0, swarm, hb);
     }
 
-    // 5) Forks Obstacles process (O)
-    pid_t pid_O = fork();
+    // 5) Forks Obstacles process (O), not when replaying (B reads the recording)
+    pid_t pid_O = opts.replay ? 0 : fork();
     if (pid_O == -1) die("fork O");
 
-    if (pid_O == 0) {
+    if (pid_O == 0 && !opts.replay) {
         // CHILD: Obstacle generator
         close(pipe_O_to_B[0]);   // O writes to O->B[1]
 
@@ -125,14 +276,16 @@ int main(void) {
         close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
         close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
         close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
-        run_obstacle_process(pipe_O_to_B[1], params);
+        die_with_parent(pid_B);
+        blog_configure(LOG_PROC_OBSTACLES, &params.log);
+        run_obstacle_process(pipe_O_to_B[1], params, hb);
     }
 
-    // 6) Forks Targets process (T)
-    pid_t pid_T = fork();
+    // 6) Forks Targets process (T), not when replaying
+    pid_t pid_T = opts.replay ? 0 : fork();
     if (pid_T == -1) die("fork T");
 
-    if (pid_T == 0) {
+    if (pid_T == 0 && !opts.replay) {
         // CHILD: Target generator
         close(pipe_T_to_B[0]);   // T writes to T->B[1]
         
@@ -142,10 +295,12 @@ int main(void) {
         close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
         close(pipe_O_to_B[0]); close(pipe_O_to_B[1]);
         close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
-        run_target_process(pipe_T_to_B[1], params);
+        die_with_parent(pid_B);
+        blog_configure(LOG_PROC_TARGETS, &params.log);
+        run_target_process(pipe_T_to_B[1], params, hb);
     }
 
-    // 7) Fork Watchdog (W) — signal based
+    // 7) Fork Watchdog (W) — polls the heartbeat counters
     pid_t pid_W = fork();
     if (pid_W == -1) die("fork W");
 
@@ -161,7 +316,9 @@ int main(void) {
         close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
 
         // warn after configured sec, kill after configured sec
-        run_watchdog_process(pipe_CFG_to_W[0], params.wd_warn_sec, params.wd_kill_sec);
+        die_with_parent(pid_B);
+        blog_configure(LOG_PROC_WATCHDOG, &params.log);
+        run_watchdog_process(pipe_CFG_to_W[0], params.wd_warn_sec, params.wd_kill_sec, hb);
     }
 
     // 8) PARENT: Becomes Server B
@@ -171,6 +328,13 @@ int main(void) {
 
     close(pipe_O_to_B[1]);  // B reads from O->B[0]
     close(pipe_T_to_B[1]);  // B reads from T->B[0]
+    int fd_obs = pipe_O_to_B[0];
+    int fd_tgt = pipe_T_to_B[0];
+    if (opts.replay) {      // no O / T: nothing to read
+        close(fd_obs);
+        close(fd_tgt);
+        fd_obs = fd_tgt = -1;
+    }
 
     // Send PIDs to watchdog (one-time config)
     close(pipe_CFG_to_W[0]); // parent writes
@@ -187,15 +351,22 @@ int main(void) {
     close(pipe_CFG_to_W[1]);
 
 
+    // Binary log of B: opened here so its header records every PID
+    blog_configure(LOG_PROC_SERVER, &params.log);
+    BlogPids bp = { wp.pid_B, wp.pid_I, wp.pid_D, wp.pid_O, wp.pid_T, pid_W };
+    if (blog_open("server", &bp, &params) == -1) {
+        perror("[MAIN/B] cannot open logs/server.blog, binary logging off");
+    }
+
     run_server_process(pipe_I_to_B[0],
                         pipe_B_to_D[1],
                         pipe_D_to_B[0],
-                        pipe_O_to_B[0],
-                        pipe_T_to_B[0],
-                        pid_W,params);
+                        fd_obs,
+                        fd_tgt,
+                        hb, params, ipc, &opts, swarm);
 
     // 9) Waits for children to avoid zombies (good practice)
-    // Forked 5 children: I, D, O, T, W
+    // Forked 5 children: I, D, O, T, W (3 when replaying)
     while (wait(NULL) > 0) {
         // loop until all children are reaped
     }
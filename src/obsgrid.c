@@ -0,0 +1,272 @@
+// obsgrid.c
+// Obstacle store and repulsion kernels of B (see headers/obsgrid.h)
+// ======================================================================
+
+#include "headers/obsgrid.h"
+#include "headers/util.h"   // OBS_CLEARANCE_FACTOR, OBS_GAIN
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OBSGRID_X86 1
+#endif
+
+// Cell index along one axis; points outside the world go to the edge cells.
+static inline int cell_of(const ObsGrid *g, double v) {
+    int c = (int)floor((v - g->x0) * g->inv_cell);
+    if (c < 0)      c = 0;
+    if (c >= g->nx) c = g->nx - 1;
+    return c;
+}
+
+void obsgrid_init(ObsGrid *g) {
+    memset(g, 0, sizeof(*g));
+}
+
+void obsgrid_free(ObsGrid *g) {
+    free(g->start);
+    free(g->ox);
+    free(g->oy);
+    obsgrid_init(g);
+}
+
+// Grows the arrays to hold n obstacles in cells cells. Returns 0 or -1.
+static int reserve(ObsGrid *g, int n, int cells) {
+    if (cells + 1 > g->cells_cap) {
+        int *s = realloc(g->start, (size_t)(cells + 1) * sizeof(*s));
+        if (!s) return -1;
+        g->start     = s;
+        g->cells_cap = cells + 1;
+    }
+    if (n > g->cap) {
+        double *ox = realloc(g->ox, (size_t)n * sizeof(*ox));
+        if (ox) g->ox = ox;
+        double *oy = realloc(g->oy, (size_t)n * sizeof(*oy));
+        if (oy) g->oy = oy;
+        if (!ox || !oy) return -1;
+        g->cap = n;
+    }
+    return 0;
+}
+
+// Counting sort of the active obstacles by cell: count, prefix sum, scatter.
+// ----------------------------------------------------------------------
+int obsgrid_build(ObsGrid *g, const Obstacle *obs, const int *idx, int num_obs,
+                  const SimParams *params)
+{
+    g->generation++;   // even a failed build changes what queries return
+
+    double cell = params->world_half * OBS_CLEARANCE_FACTOR;
+    int    nx   = cell > 0.0 ? (int)ceil(2.0 * params->world_half / cell) : 0;
+    if (nx < 1) {
+        g->nx = 0;
+        return -1;
+    }
+
+    int n = 0;
+    for (int k = 0; k < num_obs; ++k) n += obs[idx ? idx[k] : k].active ? 1 : 0;
+
+    if (reserve(g, n, nx * nx) == -1) {
+        g->nx = 0;
+        g->n  = 0;
+        return -1;
+    }
+    g->x0       = -params->world_half;
+    g->inv_cell = 1.0 / cell;
+    g->nx       = nx;
+    g->n        = n;
+    g->kernel   = obsgrid_select_kernel(params->obs_simd);
+
+    int cells = nx * nx;
+    memset(g->start, 0, (size_t)(cells + 1) * sizeof(*g->start));
+    for (int k = 0; k < num_obs; ++k) {
+        const Obstacle *o = &obs[idx ? idx[k] : k];
+        if (!o->active) continue;
+        int c = cell_of(g, o->y) * nx + cell_of(g, o->x);
+        g->start[c + 1]++;
+    }
+    for (int c = 0; c < cells; ++c) g->start[c + 1] += g->start[c];
+
+    // start[c] is used as the fill cursor of cell c, then shifted back
+    for (int k = 0; k < num_obs; ++k) {
+        const Obstacle *o = &obs[idx ? idx[k] : k];
+        if (!o->active) continue;
+        int c = cell_of(g, o->y) * nx + cell_of(g, o->x);
+        int e = g->start[c]++;
+        g->ox[e] = o->x;
+        g->oy[e] = o->y;
+    }
+    memmove(g->start + 1, g->start, (size_t)cells * sizeof(*g->start));
+    g->start[0] = 0;
+    return 0;
+}
+
+// ---------------- Repulsion kernels ----------------
+// Per obstacle, with d = (x - ox, y - oy) and rho = max(|d|, eps):
+//   mag = max(gain * (1/rho - 1/clearance), 0), kept only if |d| < clearance
+//   P  += mag * d / rho
+// The in/out test is a mask on |d|^2 < clearance^2, so there is no branch.
+
+typedef struct {
+    double x, y;
+    double c2;          // clearance^2
+    double inv_c;       // 1 / clearance
+    double gain;
+    double eps;
+} SumConst;
+
+static void sum_scalar(const double *ox, const double *oy, int i0, int n,
+                       const SumConst *c, double *Px, double *Py)
+{
+    double sx = 0.0, sy = 0.0;
+    for (int i = i0; i < n; ++i) {
+        double dx  = c->x - ox[i];
+        double dy  = c->y - oy[i];
+        double d2  = dx*dx + dy*dy;
+        double rho = sqrt(d2);
+        rho = rho > c->eps ? rho : c->eps;
+        double inv = 1.0 / rho;
+        double mag = c->gain * (inv - c->inv_c);
+        mag = (d2 < c->c2 && mag > 0.0) ? mag * inv : 0.0;
+        sx += mag * dx;
+        sy += mag * dy;
+    }
+    *Px += sx;
+    *Py += sy;
+}
+
+#ifdef OBSGRID_X86
+
+// SSE2: 2 obstacles per register, scalar tail.
+__attribute__((target("sse2")))
+static void sum_sse2(const double *ox, const double *oy, int n,
+                     const SumConst *c, double *Px, double *Py)
+{
+    const __m128d x = _mm_set1_pd(c->x), y = _mm_set1_pd(c->y);
+    const __m128d c2 = _mm_set1_pd(c->c2), inv_c = _mm_set1_pd(c->inv_c);
+    const __m128d gain = _mm_set1_pd(c->gain), eps = _mm_set1_pd(c->eps);
+    const __m128d one = _mm_set1_pd(1.0), zero = _mm_setzero_pd();
+    __m128d sx = zero, sy = zero;
+
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx  = _mm_sub_pd(x, _mm_loadu_pd(ox + i));
+        __m128d dy  = _mm_sub_pd(y, _mm_loadu_pd(oy + i));
+        __m128d d2  = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        __m128d rho = _mm_max_pd(_mm_sqrt_pd(d2), eps);
+        __m128d inv = _mm_div_pd(one, rho);
+        __m128d mag = _mm_max_pd(_mm_mul_pd(gain, _mm_sub_pd(inv, inv_c)), zero);
+        mag = _mm_and_pd(_mm_mul_pd(mag, inv), _mm_cmplt_pd(d2, c2));
+        sx = _mm_add_pd(sx, _mm_mul_pd(mag, dx));
+        sy = _mm_add_pd(sy, _mm_mul_pd(mag, dy));
+    }
+    double lx[2], ly[2];
+    _mm_storeu_pd(lx, sx);
+    _mm_storeu_pd(ly, sy);
+    *Px += lx[0] + lx[1];
+    *Py += ly[0] + ly[1];
+    if (i < n) sum_scalar(ox, oy, i, n, c, Px, Py);
+}
+
+// AVX2: 4 obstacles per register, scalar tail.
+__attribute__((target("avx2")))
+static void sum_avx2(const double *ox, const double *oy, int n,
+                     const SumConst *c, double *Px, double *Py)
+{
+    const __m256d x = _mm256_set1_pd(c->x), y = _mm256_set1_pd(c->y);
+    const __m256d c2 = _mm256_set1_pd(c->c2), inv_c = _mm256_set1_pd(c->inv_c);
+    const __m256d gain = _mm256_set1_pd(c->gain), eps = _mm256_set1_pd(c->eps);
+    const __m256d one = _mm256_set1_pd(1.0), zero = _mm256_setzero_pd();
+    __m256d sx = zero, sy = zero;
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dx  = _mm256_sub_pd(x, _mm256_loadu_pd(ox + i));
+        __m256d dy  = _mm256_sub_pd(y, _mm256_loadu_pd(oy + i));
+        __m256d d2  = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        __m256d rho = _mm256_max_pd(_mm256_sqrt_pd(d2), eps);
+        __m256d inv = _mm256_div_pd(one, rho);
+        __m256d mag = _mm256_max_pd(_mm256_mul_pd(gain, _mm256_sub_pd(inv, inv_c)), zero);
+        mag = _mm256_and_pd(_mm256_mul_pd(mag, inv), _mm256_cmp_pd(d2, c2, _CMP_LT_OQ));
+        sx = _mm256_add_pd(sx, _mm256_mul_pd(mag, dx));
+        sy = _mm256_add_pd(sy, _mm256_mul_pd(mag, dy));
+    }
+    double lx[4], ly[4];
+    _mm256_storeu_pd(lx, sx);
+    _mm256_storeu_pd(ly, sy);
+    *Px += (lx[0] + lx[1]) + (lx[2] + lx[3]);
+    *Py += (ly[0] + ly[1]) + (ly[2] + ly[3]);
+    if (i < n) sum_scalar(ox, oy, i, n, c, Px, Py);
+}
+
+#endif // OBSGRID_X86
+
+int obsgrid_select_kernel(int want) {
+#ifdef OBSGRID_X86
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2");
+    int sse2 = __builtin_cpu_supports("sse2");
+
+    if ((want == SIMD_AUTO || want == SIMD_AVX2) && avx2) return SIMD_AVX2;
+    if (want != SIMD_SCALAR && sse2) return SIMD_SSE2;
+#else
+    (void)want;
+#endif
+    return SIMD_SCALAR;
+}
+
+static void sum_dispatch(int kernel, const double *ox, const double *oy, int n,
+                         const SumConst *c, double *Px, double *Py)
+{
+    switch (kernel) {
+#ifdef OBSGRID_X86
+        case SIMD_AVX2: sum_avx2(ox, oy, n, c, Px, Py); break;
+        case SIMD_SSE2: sum_sse2(ox, oy, n, c, Px, Py); break;
+#endif
+        default:        sum_scalar(ox, oy, 0, n, c, Px, Py); break;
+    }
+}
+
+static void sum_const(SumConst *c, double x, double y, double clearance) {
+    c->x     = x;
+    c->y     = y;
+    c->c2    = clearance * clearance;
+    c->inv_c = 1.0 / clearance;
+    c->gain  = OBS_GAIN;
+    c->eps   = 1e-3;   // as in compute_repulsive_P
+}
+
+void obsgrid_sum(int kernel, const double *ox, const double *oy, int n,
+                 double x, double y, double clearance, double *Px, double *Py)
+{
+    if (n <= 0 || clearance <= 0.0) return;
+    SumConst c;
+    sum_const(&c, x, y, clearance);
+    sum_dispatch(kernel, ox, oy, n, &c, Px, Py);
+}
+
+// Sums over the 3x3 cells around (x, y). An obstacle farther than one cell
+// away on either axis is beyond the clearance. The cells of one grid row are
+// contiguous, so each row is one kernel call.
+// ----------------------------------------------------------------------
+void obsgrid_repulsion(const ObsGrid *g, double x, double y,
+                       const SimParams *params, double *Px, double *Py)
+{
+    if (g->nx <= 0 || g->n == 0) return;
+
+    SumConst c;
+    sum_const(&c, x, y, params->world_half * OBS_CLEARANCE_FACTOR);
+
+    int cx = cell_of(g, x), cy = cell_of(g, y);
+    int x_lo = cx > 0 ? cx - 1 : 0, x_hi = cx < g->nx - 1 ? cx + 1 : g->nx - 1;
+    int y_lo = cy > 0 ? cy - 1 : 0, y_hi = cy < g->nx - 1 ? cy + 1 : g->nx - 1;
+
+    for (int j = y_lo; j <= y_hi; ++j) {
+        int e0 = g->start[j * g->nx + x_lo];
+        int e1 = g->start[j * g->nx + x_hi + 1];
+        if (e1 > e0) sum_dispatch(g->kernel, g->ox + e0, g->oy + e0, e1 - e0, &c, Px, Py);
+    }
+}
@@ -0,0 +1,204 @@
+// obsgrid_bench.c
+// Cost of the obstacle repulsion sum of B (make obsgrid-bench)
+//   - Places N obstacles uniformly in the world and queries the repulsion at
+//     random drone positions with:
+//       scan        compute_repulsive_P() over the Obstacle array (structs)
+//       soa-<k>     obsgrid_sum() over all obstacles, kernel k (SoA, no branch)
+//       grid-<k>    obsgrid_repulsion(), the 3x3 cells around the drone only
+//       field-<res> repfield_lookup(), bilinear read of the cached field
+//   - Reports ns per query, obstacles visited per query, the largest
+//     difference with the scan (relative to 1 + |P|) and how often the
+//     virtual key B would send (direction, steps) differs from the scan's,
+//     among the queries where the scan's repulsion is not zero
+// Usage: ./obsgrid_bench [--csv]
+// ======================================================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "headers/obsgrid.h"
+#include "headers/repfield.h"
+#include "headers/util.h"
+#include "headers/params.h"
+#include "headers/rng.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define QUERIES  4096     // drone positions per timed run
+#define REPS     5        // timed runs, best one reported
+
+enum { M_SCAN, M_SOA, M_GRID, M_FIELD };
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// Obstacles visited by a grid query at (x, y): the 3x3 cells around it.
+static int visited(const ObsGrid *g, double x, double y) {
+    int cx = (int)floor((x - g->x0) * g->inv_cell);
+    int cy = (int)floor((y - g->x0) * g->inv_cell);
+    int n  = 0;
+    for (int j = cy - 1; j <= cy + 1; ++j) {
+        if (j < 0 || j >= g->nx) continue;
+        int lo = cx > 0 ? cx - 1 : 0, hi = cx < g->nx - 1 ? cx + 1 : g->nx - 1;
+        n += g->start[j * g->nx + hi + 1] - g->start[j * g->nx + lo];
+    }
+    return n;
+}
+
+// Virtual key of send_total_force_to_d() for P: direction index * 1000 +
+// key steps, or -1 for none.
+static int vkey(double Px, double Py, const SimParams *p) {
+    if (Px*Px + Py*Py < 1e-6) return -1;
+    int idx = best_dir8_for_vector(Px, Py);
+    if (idx < 0) return -1;
+    double dot = dot2(Px, Py, g_dir8[idx].ux, g_dir8[idx].uy);
+    return idx * 1000 + (int)(dot / (p->force_step + 1e-9) + 0.5);
+}
+
+static RepField g_field;
+
+// One repulsion query with the given method (kernel = field resolution for
+// M_FIELD).
+static void query(int method, int kernel, ObsGrid *g, const Obstacle *obs, int n,
+                  SimParams *p, double x, double y, double *Px, double *Py)
+{
+    *Px = 0.0;
+    *Py = 0.0;
+    if (method == M_SCAN) {
+        DroneStateMsg s = { .x = x, .y = y };
+        compute_repulsive_P(&s, p, obs, n, false, true, Px, Py);
+    } else if (method == M_SOA) {
+        obsgrid_sum(kernel, g->ox, g->oy, g->n, x, y,
+                    p->world_half * OBS_CLEARANCE_FACTOR, Px, Py);
+    } else if (method == M_GRID) {
+        g->kernel = kernel;
+        obsgrid_repulsion(g, x, y, p, Px, Py);
+    } else {
+        g->kernel = obsgrid_select_kernel(SIMD_AUTO);
+        p->rep_field_res = kernel;
+        repfield_lookup(&g_field, g, p, x, y, Px, Py);
+    }
+}
+
+int main(int argc, char **argv) {
+    int csv = (argc > 1 && strcmp(argv[1], "--csv") == 0);
+
+    SimParams p;
+    init_default_params(&p);
+    Rng rng;
+    rng_seed(&rng, 12345, RNG_STREAM_BENCH);
+
+    static double qx[QUERIES], qy[QUERIES], rx[QUERIES], ry[QUERIES];
+    rng_fill_uniform(&rng, qx, QUERIES, -p.world_half, p.world_half);
+    rng_fill_uniform(&rng, qy, QUERIES, -p.world_half, p.world_half);
+
+    const int counts[]  = { 12, 100, 1000, 4000, 16000 };
+    const int ncounts   = (int)(sizeof(counts) / sizeof(counts[0]));
+    const int kernels[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+    const int nkernels  = (int)(sizeof(kernels) / sizeof(kernels[0]));
+    const int fres[]    = { 101, 201, 401 };
+    const int nfres     = (int)(sizeof(fres) / sizeof(fres[0]));
+
+    if (csv) {
+        printf("obstacles,method,ns_per_query,visited,ns_per_visited,speedup,max_diff,key_diff_pct\n");
+    } else {
+        printf("%d queries per run, best of %d, cell = clearance = %.1f\n\n",
+               QUERIES, REPS, p.world_half * OBS_CLEARANCE_FACTOR);
+        printf("%9s %-12s %10s %9s %8s %8s %10s %8s\n", "obstacles", "method", "ns/query",
+               "visited", "ns/obs", "speedup", "max_diff", "key_diff");
+    }
+
+    for (int ci = 0; ci < ncounts; ++ci) {
+        int n = counts[ci];
+        Obstacle *obs = malloc((size_t)n * sizeof(*obs));
+        if (!obs) return 1;
+        for (int k = 0; k < n; ++k) {
+            obs[k].x          = rng_range(&rng, -p.world_half, p.world_half);
+            obs[k].y          = rng_range(&rng, -p.world_half, p.world_half);
+            obs[k].active     = (k % 8) != 7;   // a few expired slots, as in B
+            obs[k].life_steps = 100;
+        }
+        ObsGrid g;
+        obsgrid_init(&g);
+        if (obsgrid_build(&g, obs, NULL, n, &p) == -1) return 1;
+
+        // Reference sums
+        for (int q = 0; q < QUERIES; ++q) {
+            query(M_SCAN, 0, &g, obs, n, &p, qx[q], qy[q], &rx[q], &ry[q]);
+        }
+
+        double scan_ns = 0.0;
+        for (int method = M_SCAN; method <= M_FIELD; ++method) {
+            int nvar = method == M_FIELD ? nfres : nkernels;
+            for (int ki = 0; ki < nvar; ++ki) {
+                int kernel = method == M_FIELD ? fres[ki] : kernels[ki];
+                if (method == M_SCAN && ki > 0) break;
+                if ((method == M_SOA || method == M_GRID) &&
+                    obsgrid_select_kernel(kernel) != kernel) continue;
+
+                double max_diff = 0.0;
+                long   vis      = 0;
+                int    near     = 0, key_diff = 0;
+                for (int q = 0; q < QUERIES; ++q) {
+                    double Px, Py;
+                    query(method, kernel, &g, obs, n, &p, qx[q], qy[q], &Px, &Py);
+                    double d = hypot(Px - rx[q], Py - ry[q]) / (1.0 + hypot(rx[q], ry[q]));
+                    if (d > max_diff) max_diff = d;
+                    if (rx[q] != 0.0 || ry[q] != 0.0) {
+                        near++;
+                        key_diff += vkey(Px, Py, &p) != vkey(rx[q], ry[q], &p);
+                    }
+                    vis += method == M_SCAN ? n : method == M_SOA ? g.n :
+                           method == M_GRID ? visited(&g, qx[q], qy[q]) : 0;
+                }
+                double key_pct = near > 0 ? 100.0 * key_diff / near : 0.0;
+
+                volatile double sink = 0.0;
+                double best = 1e30;
+                for (int r = 0; r < REPS; ++r) {
+                    double t0 = now_sec();
+                    for (int q = 0; q < QUERIES; ++q) {
+                        double Px, Py;
+                        query(method, kernel, &g, obs, n, &p, qx[q], qy[q], &Px, &Py);
+                        sink += Px + Py;
+                    }
+                    double t = now_sec() - t0;
+                    if (t < best) best = t;
+                }
+                (void)sink;
+
+                double ns = 1e9 * best / QUERIES;
+                if (method == M_SCAN) scan_ns = ns;
+                double per_q = (double)vis / QUERIES;
+                char   label[24];
+                snprintf(label, sizeof(label), "%s", method == M_SCAN ? "scan" : "");
+                if (method == M_SOA || method == M_GRID) {
+                    snprintf(label, sizeof(label), "%s-%s", method == M_SOA ? "soa" : "grid",
+                             simd_name(kernel));
+                } else if (method == M_FIELD) {
+                    snprintf(label, sizeof(label), "field-%d", kernel);
+                }
+
+                if (csv) {
+                    printf("%d,%s,%.1f,%.1f,%.2f,%.2f,%.3e,%.2f\n", n, label, ns, per_q,
+                           per_q > 0 ? ns / per_q : 0.0, scan_ns / ns, max_diff, key_pct);
+                } else {
+                    printf("%9d %-12s %10.1f %9.1f %8.2f %7.2fx %10.2e %7.2f%%", n, label, ns,
+                           per_q, per_q > 0 ? ns / per_q : 0.0, scan_ns / ns, max_diff, key_pct);
+                    if (method == M_FIELD) printf("  (build %.1f ms)", g_field.build_ms);
+                    printf("\n");
+                }
+            }
+        }
+        if (!csv) printf("\n");
+        obsgrid_free(&g);
+        free(obs);
+    }
+    return 0;
+}
@@ -2,14 +2,57 @@
 #include "headers/params.h"
 #include "headers/obstacles.h"
 #include "headers/util.h"
+#include "headers/blog.h"   // BLOG_ON
+#include "headers/poisson.h"
 
 #include <unistd.h>
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
 
-Obstacle g_obstacles[NUM_OBSTACLES];
-
+Obstacle  *g_obstacles = NULL;
+SlotPool   g_obs_pool;
+PointGrid  g_obs_index;
+
+// Allocates the obstacle slots (all inactive), their pool and their index.
+// The index cell is the spawn clearance, the largest radius queried.
+// ----------------------------------------------------------------------
+int obstacle_store_init(int capacity, double world_half) {
+    if (pool_init(&g_obs_pool, capacity) == -1) return -1;
+    g_obstacles = calloc((size_t)g_obs_pool.cap, sizeof(*g_obstacles));
+    if (!g_obstacles ||
+        pointgrid_init(&g_obs_index, g_obs_pool.cap, world_half,
+                       world_half * SPAWN_CLEARANCE_FACTOR) == -1) {
+        obstacle_store_free();
+        return -1;
+    }
+    return 0;
+}
+
+void obstacle_store_free(void) {
+    free(g_obstacles);
+    g_obstacles = NULL;
+    pool_free(&g_obs_pool);
+    pointgrid_free(&g_obs_index);
+}
+
+int obstacle_add(double x, double y, int life_steps) {
+    int slot = pool_alloc(&g_obs_pool);
+    if (slot < 0) return -1;
+    g_obstacles[slot].x          = x;
+    g_obstacles[slot].y          = y;
+    g_obstacles[slot].life_steps = life_steps;
+    g_obstacles[slot].active     = 1;
+    pointgrid_insert(&g_obs_index, slot, x, y);
+    return slot;
+}
+
+void obstacle_remove(int slot) {
+    g_obstacles[slot].active     = 0;
+    g_obstacles[slot].life_steps = 0;
+    pool_release(&g_obs_pool, slot);
+    pointgrid_remove(&g_obs_index, slot);
+}
 
 /**
  * @brief Run the Obstacle Generator (O) process.
@@ -17,20 +60,26 @@ Obstacle g_obstacles[NUM_OBSTACLES];
  * @details
  * Periodically spawns obstacles and sends them to the Server (B).
  * - **Generation Logic**: 
- *   - Samples random positions within the "safe" inner area (avoiding walls).
- *   - Ensures minimum spacing between generated obstacles.
+ *   - Samples positions within the "safe" inner area (avoiding walls) with a
+ *     Poisson-disk sampler: minimum spacing guaranteed, linear time.
  *   - (Note: Collision with targets is checked by Server (B) upon receipt).
  * 
+ * - **Batch size**: `obs_batch` in params.txt, sent as one variable-length
+ *   message (BatchHeader + specs).
+ * 
  * @param pipe_fd Write-end pipe to Server (B).
- * @param params  Simulation parameters (used for world boundaries).
+ * @param params  Simulation parameters (used for world boundaries and batch size).
+ * @param hb      Shared heartbeat counters: beats while waiting for the next batch.
  */
-void run_obstacle_process(int write_fd, SimParams params) {
+void run_obstacle_process(int write_fd, SimParams params, HeartbeatBoard *hb) {
     FILE *log = open_process_log("obstacles", "O");
     if (!log) log = stderr;   // <-- don't die, just log to stderr
 
     fprintf(log, "[O] Obstacles started | PID = %d\n", getpid());
     
-    srand((unsigned)time(NULL) ^ getpid());
+    // Own stream of the run seed: same seed, same obstacles
+    Rng rng;
+    rng_seed(&rng, params.seed, RNG_STREAM_OBSTACLES);
 
     double world_half = params.world_half;
 
@@ -48,79 +97,58 @@ void run_obstacle_process(int write_fd, SimParams params) {
     // Defines minimum spacing between obstacles in the same batch
     const double spacing_factor  = 0.15;   // 15% of world_half
     double min_spacing           = world_half * spacing_factor;
-    double min_spacing2          = min_spacing * min_spacing;
-
-    // Defines maximum attempts per obstacle to find a valid (non-overlapping) position.
-    const int max_attempts       = 50;
 
     // Determines how often to *try* to spawn a new batch of obstacles (in real seconds).
     // Decides how soon O tries to create the next batch
     const unsigned spawn_interval_sec = 45;   // 40 did good visually, test more
-    
-    
+
+    // Batch buffer: obs_batch specs, filled again for every batch
+    int           batch_count = params.obs_batch;
+    ObstacleSpec *specs       = malloc((size_t)(batch_count > 0 ? batch_count : 1) * sizeof(*specs));
+    if (!specs) die("[O] batch buffer");
+
+    // Poisson-disk sampler, buffers kept across batches
+    PoissonSampler sampler;
+    poisson_init(&sampler);
+
+    hb_watch(hb, HB_O, true);
     while (1) {
-        ObstacleSetMsg msg;
-        msg.count = MAX_OBSTACLES;  // we'll try to generate this many each time
-
-        // Samples a position for each obstacle in this batch that:
-        //  -- Is inside the inner box (margin from walls)
-        //  -- Is at least min_spacing away from previously generated obstacles
-        for (int i = 0; i < msg.count; ++i) {
-            int attempts = 0;
-            int placed   = 0;
-            while (attempts < max_attempts) {
-                attempts++;
-
-                // Samples inside inner box: [-world_half+margin, +world_half-margin]
-                double x = rand_in_range(-world_half + margin, +world_half - margin);
-                double y = rand_in_range(-world_half + margin, +world_half - margin);
-
-                // Checks spacing with all previously placed obstacles in this batch
-                int ok = 1;
-                for (int j = 0; j < i; ++j) {
-                    double dx = x - msg.obs[j].x;
-                    double dy = y - msg.obs[j].y;
-                    double d2 = dx*dx + dy*dy;
-                    if (d2 < min_spacing2) {
-                        ok = 0;
-                        break;
-                    }
-                }
-
-                if (ok) {
-                    msg.obs[i].x          = x;
-                    msg.obs[i].y          = y;
-                    msg.obs[i].life_steps = life_steps_default;
-                    placed = 1;
-                    break;
-                }
-            }
-
-            if (!placed) {
-                // Falls back to "somewhere in the inner box without spacing check" if a good spot is not found.
-                double x = rand_in_range(-world_half + margin, +world_half - margin);
-                double y = rand_in_range(-world_half + margin, +world_half - margin);
-
-                msg.obs[i].x          = x;
-                msg.obs[i].y          = y;
-                msg.obs[i].life_steps = life_steps_default;
-            }
+        // Samples positions for this batch that:
+        //  -- Are inside the inner box (margin from walls)
+        //  -- Are at least min_spacing away from each other
+        int placed = poisson_sample(&sampler, &rng, POISSON_BOX, world_half - margin,
+                                    min_spacing, POISSON_K, batch_count);
+        if (placed < 0) die("[O] obstacle sampling");
+
+        for (int i = 0; i < placed; ++i) {
+            specs[i].x          = sampler.x[i];
+            specs[i].y          = sampler.y[i];
+            specs[i].life_steps = life_steps_default;
+        }
+        if (placed < batch_count && BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(log, "[O] only %d of %d obstacles fit at spacing %.2f\n",
+                    placed, batch_count, min_spacing);
         }
 
         // Sends the whole batch to B.
-        if (write(write_fd, &msg, sizeof(msg)) == -1) {
+        if (batch_write(write_fd, specs, (uint32_t)placed, sizeof(ObstacleSpec)) == -1) {
             perror("[O] write to B failed");
             break;  // exit the loop -> process ends
         }
 
         // Logs the sending event
-        fprintf(log, "[O] sending batch count=%d life_steps=%d ...\n", msg.count, msg.obs[0].life_steps);
-        fflush(log);
+        if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(log, "[O] sending batch count=%d life_steps=%d ...\n", placed, life_steps_default);
+            fflush(log);
+        }
 
-        // Waits a while before attempting to spawn the next batch.
-        sleep(spawn_interval_sec);
+        // Waits a while before attempting to spawn the next batch (beating for W).
+        hb_sleep(hb, HB_O, spawn_interval_sec);
     }
     // Final cleanup
+    hb_watch(hb, HB_O, false);
+    poisson_free(&sampler);
+    free(specs);
     if (log) {
         fprintf(log, "[O] Exiting.\n");
         fclose(log);
@@ -5,6 +5,7 @@
 // ======================================================================
 
 #include "headers/params.h"
+#include "headers/messages.h"   // BATCH_MAX_COUNT
 
 #include <stdio.h>
 #include <string.h>
@@ -36,6 +37,124 @@ static void trim(char *s) {
     }
 }
 
+// Helper: Cuts a value at its first whitespace (drops trailing comments).
+// ----------------------------------------------------------------------
+static void first_word(char *s) {
+    if (!s) return;
+    while (*s && *s != ' ' && *s != '\t' && *s != '#')
+        s++;
+    *s = '\0';
+}
+
+static const char *const g_log_proc_names[LOG_PROC_COUNT] = {
+    "server", "keyboard", "dynamics", "obstacles", "targets", "watchdog"
+};
+static const char *const g_log_cat_names[LOG_CAT_COUNT] = {
+    "keys", "state", "force", "spawn", "watchdog"
+};
+
+const char *integrator_name(int integrator) {
+    switch (integrator) {
+        case INTEG_RK4: return "rk4";
+        case INTEG_EXP: return "exp";
+        case INTEG_ADAPTIVE: return "adaptive";
+        default:        return "semi_implicit";
+    }
+}
+
+const char *simd_name(int simd) {
+    switch (simd) {
+        case SIMD_SCALAR: return "scalar";
+        case SIMD_SSE2:   return "sse2";
+        case SIMD_AVX2:   return "avx2";
+        default:          return "auto";
+    }
+}
+
+const char *log_proc_name(int proc) {
+    return (proc >= 0 && proc < LOG_PROC_COUNT) ? g_log_proc_names[proc] : "?";
+}
+
+const char *log_cat_name(int cat) {
+    return (cat >= 0 && cat < LOG_CAT_COUNT) ? g_log_cat_names[cat] : "?";
+}
+
+// Helper: Returns the index of name in names[n], or -1.
+// ----------------------------------------------------------------------
+static int find_name(const char *const *names, int n, const char *name) {
+    for (int i = 0; i < n; ++i) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// Helper: Parses a log level ("off", "info", "debug" or 0..2). Returns -1 if invalid.
+// ----------------------------------------------------------------------
+static int parse_log_level(char *val) {
+    first_word(val);
+    if (strcmp(val, "off")   == 0) return LOG_OFF;
+    if (strcmp(val, "info")  == 0) return LOG_INFO;
+    if (strcmp(val, "debug") == 0) return LOG_DEBUG;
+
+    char *end;
+    long  v = strtol(val, &end, 10);
+    if (end == val || *end != '\0' || v < LOG_OFF) return -1;
+    return v > LOG_DEBUG ? LOG_DEBUG : (int)v;
+}
+
+// Helper: Applies one log_* key. Returns 0 if the key is not a known log key.
+//   log_level=L                   every process, every category
+//   log_<category>=L              one category in every process
+//   log_<process>_<category>=L    one category in one process
+//   log_sample_<category>=N       keep 1 record in N of that category
+// Later lines override earlier ones.
+// ----------------------------------------------------------------------
+static int parse_log_key(const char *key, char *val, LogParams *lp) {
+    if (strncmp(key, "log_", 4) != 0) return 0;
+    const char *rest = key + 4;
+
+    if (strncmp(rest, "sample_", 7) == 0) {
+        int cat = find_name(g_log_cat_names, LOG_CAT_COUNT, rest + 7);
+        if (cat < 0) return 0;
+        int n = atoi(val);
+        lp->sample[cat] = n < 1 ? 1 : n;
+        return 1;
+    }
+
+    int proc = -1;   // -1 = all processes
+    int cat  = -1;   // -1 = all categories
+    if (strcmp(rest, "level") != 0) {
+        cat = find_name(g_log_cat_names, LOG_CAT_COUNT, rest);
+        if (cat < 0) {
+            const char *us = strchr(rest, '_');
+            if (!us) return 0;
+            char pname[16];
+            size_t plen = (size_t)(us - rest);
+            if (plen >= sizeof(pname)) return 0;
+            memcpy(pname, rest, plen);
+            pname[plen] = '\0';
+
+            proc = find_name(g_log_proc_names, LOG_PROC_COUNT, pname);
+            cat  = find_name(g_log_cat_names,  LOG_CAT_COUNT,  us + 1);
+            if (proc < 0 || cat < 0) return 0;
+        }
+    }
+
+    int level = parse_log_level(val);
+    if (level < 0) {
+        fprintf(stderr, "[PARAMS] Bad log level for '%s', keeping previous.\n", key);
+        return 1;
+    }
+    for (int pi = 0; pi < LOG_PROC_COUNT; ++pi) {
+        if (proc >= 0 && pi != proc) continue;
+        for (int ci = 0; ci < LOG_CAT_COUNT; ++ci) {
+            if (cat >= 0 && ci != cat) continue;
+            lp->level[pi][ci] = (unsigned char)level;
+        }
+    }
+    return 1;
+}
+
 // Initializes default parameters (used if no params.txt exists).
 // ----------------------------------------------------------------------
 void init_default_params(SimParams *p) {
@@ -52,6 +171,51 @@ void init_default_params(SimParams *p) {
     // Watchdog defaults
     p->wd_warn_sec    = 2;
     p->wd_kill_sec    = 10;
+
+    // B<->D transport
+    p->ipc_mode       = IPC_MODE_PIPE;
+
+    // UI frame rate, independent of dt
+    p->ui_fps         = 30.0;
+
+    // Dynamics scheduler: catch up at most 4 steps per wake-up
+    p->sched_policy      = SCHED_CATCHUP;
+    p->sched_max_catchup = 4;
+
+    // Integrator: the original semi-implicit Euler, one update per dt
+    p->integrator        = INTEG_SEMI_IMPLICIT;
+    p->substeps          = 1;
+
+    // Adaptive integrator: 1e-4 local error per internal step, steps >= 10 us
+    p->adapt_tol         = 1e-4;
+    p->adapt_h_min       = 1e-5;
+
+    // No swarm: D integrates the user's drone only
+    p->swarm             = 0;
+    p->swarm_simd        = SIMD_AUTO;
+    p->obs_simd          = SIMD_AUTO;
+
+    // Exact obstacle repulsion every tick (no cached field)
+    p->rep_field_res     = 0;
+
+    // Batches of 8; the pools hold two overlapping batches and some slack
+    p->obs_capacity      = 32;
+    p->tgt_capacity      = 32;
+    p->obs_batch         = 8;
+    p->tgt_batch         = 8;
+
+    // Seed from the clock (a different run each time)
+    p->seed              = 0;
+
+    // Logging: everything on, no sampling
+    for (int pi = 0; pi < LOG_PROC_COUNT; ++pi) {
+        for (int ci = 0; ci < LOG_CAT_COUNT; ++ci) {
+            p->log.level[pi][ci] = LOG_DEBUG;
+        }
+    }
+    for (int ci = 0; ci < LOG_CAT_COUNT; ++ci) {
+        p->log.sample[ci] = 1;
+    }
 }
 
 // Loads parameters from a simple "key=value" file.
@@ -95,6 +259,75 @@ void load_params_from_file(const char *filename, SimParams *p) {
         else if (strcmp(key, "wall_gain")      == 0) p->wall_gain      = d;
         else if (strcmp(key, "wd_warn_sec")    == 0) p->wd_warn_sec    = (int)d;
         else if (strcmp(key, "wd_kill_sec")    == 0) p->wd_kill_sec    = (int)d;
+        else if (strcmp(key, "ui_fps")         == 0) p->ui_fps         = d;
+        else if (strcmp(key, "ipc_mode")       == 0) {
+            first_word(val);
+            if      (strcmp(val, "shm")  == 0) p->ipc_mode = IPC_MODE_SHM;
+            else if (strcmp(val, "pipe") == 0) p->ipc_mode = IPC_MODE_PIPE;
+            else fprintf(stderr, "[PARAMS] Unknown ipc_mode '%s', keeping default.\n", val);
+        }
+        else if (strcmp(key, "substeps")       == 0) {
+            p->substeps = (int)d < 1 ? 1 : (int)d;
+        }
+        else if (strcmp(key, "swarm")          == 0) {
+            p->swarm = (int)d < 0 ? 0 : (int)d;
+        }
+        else if (strcmp(key, "swarm_simd")     == 0 ||
+                 strcmp(key, "obs_simd")       == 0) {
+            int *dst = key[0] == 's' ? &p->swarm_simd : &p->obs_simd;
+            first_word(val);
+            if      (strcmp(val, "auto")   == 0) *dst = SIMD_AUTO;
+            else if (strcmp(val, "scalar") == 0) *dst = SIMD_SCALAR;
+            else if (strcmp(val, "sse2")   == 0) *dst = SIMD_SSE2;
+            else if (strcmp(val, "avx2")   == 0) *dst = SIMD_AVX2;
+            else fprintf(stderr, "[PARAMS] Unknown %s '%s', keeping default.\n", key, val);
+        }
+        else if (strcmp(key, "obs_capacity")   == 0) {
+            p->obs_capacity = (int)d < 1 ? 1 : (int)d;
+        }
+        else if (strcmp(key, "tgt_capacity")   == 0) {
+            p->tgt_capacity = (int)d < 1 ? 1 : (int)d;
+        }
+        else if (strcmp(key, "obs_batch")      == 0) {
+            p->obs_batch = (int)d < 0 ? 0 : (int)d > (int)BATCH_MAX_COUNT ? (int)BATCH_MAX_COUNT : (int)d;
+        }
+        else if (strcmp(key, "tgt_batch")      == 0) {
+            p->tgt_batch = (int)d < 0 ? 0 : (int)d > (int)BATCH_MAX_COUNT ? (int)BATCH_MAX_COUNT : (int)d;
+        }
+        else if (strcmp(key, "seed")           == 0) {
+            // Integer key: strtod would round seeds above 2^53
+            p->seed = strtoull(val, NULL, 0);
+        }
+        else if (strcmp(key, "rep_field_res")  == 0) {
+            // 0 (or 1) turns the cache off
+            p->rep_field_res = (int)d < 2 ? 0 : (int)d;
+        }
+        else if (strcmp(key, "adapt_tol")      == 0) {
+            if (d > 0.0) p->adapt_tol = d;
+        }
+        else if (strcmp(key, "adapt_h_min")    == 0) {
+            if (d > 0.0) p->adapt_h_min = d;
+        }
+        else if (strcmp(key, "integrator")     == 0) {
+            first_word(val);
+            if      (strcmp(val, "semi_implicit") == 0) p->integrator = INTEG_SEMI_IMPLICIT;
+            else if (strcmp(val, "rk4")           == 0) p->integrator = INTEG_RK4;
+            else if (strcmp(val, "exp")           == 0) p->integrator = INTEG_EXP;
+            else if (strcmp(val, "adaptive")      == 0) p->integrator = INTEG_ADAPTIVE;
+            else fprintf(stderr, "[PARAMS] Unknown integrator '%s', keeping default.\n", val);
+        }
+        else if (strcmp(key, "sched_max_catchup") == 0) {
+            p->sched_max_catchup = (int)d < 1 ? 1 : (int)d;
+        }
+        else if (strcmp(key, "sched_policy")   == 0) {
+            first_word(val);
+            if      (strcmp(val, "catchup") == 0) p->sched_policy = SCHED_CATCHUP;
+            else if (strcmp(val, "drop")    == 0) p->sched_policy = SCHED_DROP;
+            else fprintf(stderr, "[PARAMS] Unknown sched_policy '%s', keeping default.\n", val);
+        }
+        else if (parse_log_key(key, val, &p->log)) {
+            // handled
+        }
         else {
             fprintf(stderr, "[PARAMS] Unknown key '%s', ignoring.\n", key);
         }
@@ -104,7 +337,77 @@ void load_params_from_file(const char *filename, SimParams *p) {
 
     fprintf(stderr,
             "[PARAMS] Loaded: mass=%.3f, visc=%.3f, dt=%.3f, force_step=%.3f, "
-            "world_half=%.3f, wall_clearance=%.3f, wall_gain=%.3f\n",
+            "world_half=%.3f, wall_clearance=%.3f, wall_gain=%.3f, ui_fps=%.1f, ipc_mode=%s\n",
             p->mass, p->visc, p->dt, p->force_step,
-            p->world_half, p->wall_clearance, p->wall_gain);
+            p->world_half, p->wall_clearance, p->wall_gain, p->ui_fps,
+            p->ipc_mode == IPC_MODE_SHM ? "shm" : "pipe");
+}
+
+// Writes the parameters as "key=value" lines (same keys as params.txt).
+// Returns the number of characters written (like snprintf).
+// ----------------------------------------------------------------------
+int params_format(const SimParams *p, char *buf, size_t len) {
+    int n = snprintf(buf, len,
+                     "mass=%.17g\n"
+                     "visc=%.17g\n"
+                     "dt=%.17g\n"
+                     "force_step=%.17g\n"
+                     "world_half=%.17g\n"
+                     "wall_clearance=%.17g\n"
+                     "wall_gain=%.17g\n"
+                     "wd_warn_sec=%d\n"
+                     "wd_kill_sec=%d\n"
+                     "ipc_mode=%s\n"
+                     "ui_fps=%.17g\n"
+                     "sched_policy=%s\n"
+                     "sched_max_catchup=%d\n"
+                     "integrator=%s\n"
+                     "substeps=%d\n"
+                     "adapt_tol=%.17g\n"
+                     "adapt_h_min=%.17g\n"
+                     "swarm=%d\n"
+                     "swarm_simd=%s\n"
+                     "obs_simd=%s\n"
+                     "rep_field_res=%d\n"
+                     "obs_capacity=%d\n"
+                     "tgt_capacity=%d\n"
+                     "obs_batch=%d\n"
+                     "tgt_batch=%d\n"
+                     "seed=%llu\n",
+                     p->mass, p->visc, p->dt, p->force_step, p->world_half,
+                     p->wall_clearance, p->wall_gain,
+                     p->wd_warn_sec, p->wd_kill_sec,
+                     p->ipc_mode == IPC_MODE_SHM ? "shm" : "pipe",
+                     p->ui_fps,
+                     p->sched_policy == SCHED_DROP ? "drop" : "catchup",
+                     p->sched_max_catchup,
+                     integrator_name(p->integrator),
+                     p->substeps,
+                     p->adapt_tol,
+                     p->adapt_h_min,
+                     p->swarm,
+                     simd_name(p->swarm_simd),
+                     simd_name(p->obs_simd),
+                     p->rep_field_res,
+                     p->obs_capacity,
+                     p->tgt_capacity,
+                     p->obs_batch,
+                     p->tgt_batch,
+                     (unsigned long long)p->seed);
+
+    // Log levels and sampling, one line per entry so the snapshot is exact
+    for (int pi = 0; pi < LOG_PROC_COUNT; ++pi) {
+        for (int ci = 0; ci < LOG_CAT_COUNT; ++ci) {
+            size_t off = (n >= 0 && (size_t)n < len) ? (size_t)n : len;
+            n += snprintf(buf + off, len - off, "log_%s_%s=%d\n",
+                          g_log_proc_names[pi], g_log_cat_names[ci],
+                          p->log.level[pi][ci]);
+        }
+    }
+    for (int ci = 0; ci < LOG_CAT_COUNT; ++ci) {
+        size_t off = (n >= 0 && (size_t)n < len) ? (size_t)n : len;
+        n += snprintf(buf + off, len - off, "log_sample_%s=%d\n",
+                      g_log_cat_names[ci], p->log.sample[ci]);
+    }
+    return n;
 }
@@ -0,0 +1,125 @@
+// pointgrid.c
+// Proximity index of B over pool slots (see headers/pointgrid.h)
+// ======================================================================
+
+#include "headers/pointgrid.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POINTGRID_PER_CELL 4     // points per cell at full capacity
+#define POINTGRID_MAX_NX   512   // cells per axis, whatever the capacity
+
+// Cell index along one axis; points outside the world go to the edge cells.
+static inline int axis_cell(const PointGrid *g, double v) {
+    int c = (int)floor((v - g->x0) * g->inv_cell);
+    if (c < 0)      c = 0;
+    if (c >= g->nx) c = g->nx - 1;
+    return c;
+}
+
+int pointgrid_init(PointGrid *g, int cap, double world_half, double cell) {
+    memset(g, 0, sizeof(*g));
+    if (cap < 1) cap = 1;
+
+    double side = 2.0 * world_half;
+    int    nx   = cell > 0.0 ? (int)ceil(side / cell) : 1;
+    int    nx_n = (int)ceil(sqrt((double)cap / POINTGRID_PER_CELL));
+    if (nx < nx_n)             nx = nx_n;
+    if (nx > POINTGRID_MAX_NX) nx = POINTGRID_MAX_NX;
+    if (nx < 1)                nx = 1;
+
+    g->cap      = cap;
+    g->nx       = nx;
+    g->x0       = -world_half;
+    g->inv_cell = side > 0.0 ? (double)nx / side : 0.0;
+
+    size_t cells = (size_t)nx * (size_t)nx;
+    g->head = malloc(cells * sizeof(*g->head));
+    g->next = malloc((size_t)cap * sizeof(*g->next));
+    g->prev = malloc((size_t)cap * sizeof(*g->prev));
+    g->cell = malloc((size_t)cap * sizeof(*g->cell));
+    g->px   = malloc((size_t)cap * sizeof(*g->px));
+    g->py   = malloc((size_t)cap * sizeof(*g->py));
+    if (!g->head || !g->next || !g->prev || !g->cell || !g->px || !g->py) {
+        pointgrid_free(g);
+        return -1;
+    }
+    memset(g->head, 0xff, cells * sizeof(*g->head));          // all -1
+    memset(g->cell, 0xff, (size_t)cap * sizeof(*g->cell));
+    return 0;
+}
+
+void pointgrid_free(PointGrid *g) {
+    free(g->head);
+    free(g->next);
+    free(g->prev);
+    free(g->cell);
+    free(g->px);
+    free(g->py);
+    memset(g, 0, sizeof(*g));
+}
+
+void pointgrid_insert(PointGrid *g, int slot, double x, double y) {
+    if (slot < 0 || slot >= g->cap) return;
+    if (g->cell[slot] >= 0) pointgrid_remove(g, slot);   // moved
+
+    int c = axis_cell(g, y) * g->nx + axis_cell(g, x);
+    g->px[slot]   = x;
+    g->py[slot]   = y;
+    g->cell[slot] = c;
+    g->prev[slot] = -1;
+    g->next[slot] = g->head[c];
+    if (g->head[c] >= 0) g->prev[g->head[c]] = slot;
+    g->head[c] = slot;
+    g->count++;
+}
+
+void pointgrid_remove(PointGrid *g, int slot) {
+    if (slot < 0 || slot >= g->cap) return;
+    int c = g->cell[slot];
+    if (c < 0) return;
+
+    int p = g->prev[slot], n = g->next[slot];
+    if (p >= 0) g->next[p]  = n;
+    else        g->head[c]  = n;
+    if (n >= 0) g->prev[n]  = p;
+    g->cell[slot] = -1;
+    g->count--;
+}
+
+// Visits the cells overlapping [x-r, x+r] x [y-r, y+r]; stops after max_out
+// matches (max_out = 1 for the any-query).
+// ----------------------------------------------------------------------
+static int scan(const PointGrid *g, double x, double y, double r, int *out, int max_out) {
+    if (g->count == 0 || max_out <= 0) return 0;
+
+    double r2 = r * r;
+    int cx0 = axis_cell(g, x - r), cx1 = axis_cell(g, x + r);
+    int cy0 = axis_cell(g, y - r), cy1 = axis_cell(g, y + r);
+    int n   = 0;
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            for (int s = g->head[cy * g->nx + cx]; s >= 0; s = g->next[s]) {
+                double dx = x - g->px[s];
+                double dy = y - g->py[s];
+                if (dx*dx + dy*dy > r2) continue;
+                if (out) out[n] = s;
+                if (++n == max_out) return n;
+            }
+        }
+    }
+    return n;
+}
+
+bool pointgrid_any_within(const PointGrid *g, double x, double y, double r) {
+    return scan(g, x, y, r, NULL, 1) > 0;
+}
+
+int pointgrid_within(const PointGrid *g, double x, double y, double r,
+                     int *out, int max_out)
+{
+    return scan(g, x, y, r, out, max_out);
+}
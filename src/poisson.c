@@ -0,0 +1,141 @@
+// poisson.c
+// Bridson Poisson-disk sampler of O and T (see headers/poisson.h)
+// ======================================================================
+
+#define _GNU_SOURCE   // M_PI
+
+#include "headers/poisson.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POISSON_MAX_CELLS (1 << 22)   // background grid limit (min_dist too small)
+
+void poisson_init(PoissonSampler *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+void poisson_free(PoissonSampler *s) {
+    free(s->x);
+    free(s->y);
+    free(s->active);
+    free(s->grid);
+    poisson_init(s);
+}
+
+// Grows the buffers to n samples and cells cells. Returns 0 or -1.
+static int reserve(PoissonSampler *s, int n, int cells) {
+    if (n > s->cap) {
+        double *x = realloc(s->x, (size_t)n * sizeof(*x));
+        if (x) s->x = x;
+        double *y = realloc(s->y, (size_t)n * sizeof(*y));
+        if (y) s->y = y;
+        int    *a = realloc(s->active, (size_t)n * sizeof(*a));
+        if (a) s->active = a;
+        if (!x || !y || !a) return -1;
+        s->cap = n;
+    }
+    if (cells > s->grid_cap) {
+        int *g = realloc(s->grid, (size_t)cells * sizeof(*g));
+        if (!g) return -1;
+        s->grid     = g;
+        s->grid_cap = cells;
+    }
+    return 0;
+}
+
+static inline bool in_domain(int shape, double half, double x, double y) {
+    if (shape == POISSON_DISK) return x*x + y*y <= half*half;
+    return fabs(x) <= half && fabs(y) <= half;
+}
+
+// ----------------------------------------------------------------------
+int poisson_sample(PoissonSampler *s, Rng *rng, int shape, double half, double min_dist,
+                   int k, int max_n)
+{
+    if (max_n <= 0 || half <= 0.0) return 0;
+    if (min_dist <= 0.0) return -1;
+
+    // One sample per cell at most: cell diagonal = min_dist
+    double cell  = min_dist / sqrt(2.0);
+    double cells_d = ceil(2.0 * half / cell);
+    if (cells_d * cells_d > POISSON_MAX_CELLS) return -1;
+    int    nx    = cells_d < 1.0 ? 1 : (int)cells_d;
+    int    cells = nx * nx;
+    if (reserve(s, cells, cells) == -1) return -1;
+    memset(s->grid, 0xff, (size_t)cells * sizeof(*s->grid));   // all -1
+
+    double inv_cell = 1.0 / cell;
+    double r2       = min_dist * min_dist;
+    int    n        = 0;
+    int    n_active = 0;
+
+    // First sample: uniform in the domain (area-uniform radius for the disk)
+    double x, y;
+    if (shape == POISSON_DISK) {
+        rng_fill_disk(rng, &x, &y, 1, half);
+    } else {
+        x = rng_range(rng, -half, half);
+        y = rng_range(rng, -half, half);
+    }
+
+    for (;;) {
+        // Stores (x, y) as a new sample
+        int cx = (int)((x + half) * inv_cell), cy = (int)((y + half) * inv_cell);
+        if (cx >= nx) cx = nx - 1;
+        if (cy >= nx) cy = nx - 1;
+        s->grid[cy * nx + cx] = n;
+        s->x[n] = x;
+        s->y[n] = y;
+        s->active[n_active++] = n;
+        n++;
+
+        // Next sample: a candidate around a random active point, first
+        // one far enough from every sample of the 5x5 cells around it
+        bool found = false;
+        while (n_active > 0 && !found) {
+            int    a  = (int)rng_below(rng, (uint32_t)n_active);
+            int    p  = s->active[a];
+            for (int t = 0; t < k && !found; ++t) {
+                double theta = rng_range(rng, 0.0, 2.0 * M_PI);
+                double r     = min_dist * (1.0 + rng_uniform(rng));
+                x = s->x[p] + r * cos(theta);
+                y = s->y[p] + r * sin(theta);
+                if (!in_domain(shape, half, x, y)) continue;
+
+                cx = (int)((x + half) * inv_cell);
+                cy = (int)((y + half) * inv_cell);
+                bool ok = true;
+                for (int j = cy - 2; j <= cy + 2 && ok; ++j) {
+                    if (j < 0 || j >= nx) continue;
+                    for (int i = cx - 2; i <= cx + 2; ++i) {
+                        if (i < 0 || i >= nx) continue;
+                        int q = s->grid[j * nx + i];
+                        if (q < 0) continue;
+                        double dx = x - s->x[q], dy = y - s->y[q];
+                        if (dx*dx + dy*dy < r2) {
+                            ok = false;
+                            break;
+                        }
+                    }
+                }
+                found = ok;
+            }
+            // k misses: no room left around p
+            if (!found) s->active[a] = s->active[--n_active];
+        }
+        if (!found) break;
+    }
+
+    // Keeps a random subset of max_n (partial Fisher-Yates shuffle)
+    int keep = n < max_n ? n : max_n;
+    for (int i = 0; i < keep; ++i) {
+        int j = i + (int)rng_below(rng, (uint32_t)(n - i));
+        double tx = s->x[i], ty = s->y[i];
+        s->x[i] = s->x[j];  s->y[i] = s->y[j];
+        s->x[j] = tx;       s->y[j] = ty;
+    }
+    return keep;
+}
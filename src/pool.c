@@ -0,0 +1,65 @@
+// pool.c
+// Slot pool with a free list and a dense live list (see headers/pool.h)
+// ======================================================================
+
+#include "headers/pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int pool_init(SlotPool *p, int cap) {
+    memset(p, 0, sizeof(*p));
+    if (cap < 1) cap = 1;
+
+    // One block: next_free | live | live_pos
+    int *mem = malloc(3 * (size_t)cap * sizeof(*mem));
+    if (!mem) return -1;
+    p->cap       = cap;
+    p->next_free = mem;
+    p->live      = mem + cap;
+    p->live_pos  = mem + 2 * (size_t)cap;
+    pool_clear(p);
+    return 0;
+}
+
+void pool_free(SlotPool *p) {
+    free(p->next_free);
+    memset(p, 0, sizeof(*p));
+    p->free_head = -1;
+}
+
+int pool_alloc(SlotPool *p) {
+    int slot = p->free_head;
+    if (slot < 0) return -1;
+    p->free_head       = p->next_free[slot];
+    p->live_pos[slot]  = p->count;
+    p->live[p->count++] = slot;
+    p->gen++;
+    return slot;
+}
+
+void pool_release(SlotPool *p, int slot) {
+    int pos = p->live_pos[slot];
+    if (pos < 0) return;   // already free
+
+    // Swap-remove from the live list
+    int last = p->live[--p->count];
+    p->live[pos]       = last;
+    p->live_pos[last]  = pos;
+    p->live_pos[slot]  = -1;
+
+    // Push on the free list
+    p->next_free[slot] = p->free_head;
+    p->free_head       = slot;
+    p->gen++;
+}
+
+void pool_clear(SlotPool *p) {
+    p->count = 0;
+    for (int s = 0; s < p->cap; ++s) {
+        p->next_free[s] = s + 1 < p->cap ? s + 1 : -1;
+        p->live_pos[s]  = -1;
+    }
+    p->free_head = p->cap > 0 ? 0 : -1;
+    p->gen++;
+}
@@ -0,0 +1,225 @@
+// record.c
+// Session recorder and replay loader of B (see headers/record.h)
+// ======================================================================
+
+#include "headers/record.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REC_IO_BUF (64 * 1024)   // stdio buffer of the recorder
+
+// ---------------- Recorder ----------------
+
+int recorder_open(Recorder *r, const char *path, const SimParams *params, bool lockstep) {
+    memset(r, 0, sizeof(*r));
+
+    r->fp = fopen(path, "wb");
+    if (!r->fp) return -1;
+    setvbuf(r->fp, NULL, _IOFBF, REC_IO_BUF);
+
+    RecFileHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic       = REC_MAGIC;
+    h.version     = REC_VERSION;
+    h.params_size = (uint32_t)sizeof(SimParams);
+    h.lockstep    = lockstep ? 1u : 0u;
+    h.params      = *params;
+    if (fwrite(&h, sizeof(h), 1, r->fp) != 1) {
+        int e = errno;
+        fclose(r->fp);
+        r->fp = NULL;
+        errno = e;
+        return -1;
+    }
+    return 0;
+}
+
+// Writes one record header and its payload.
+static void put(Recorder *r, uint64_t step, uint32_t type, uint32_t count,
+                const void *payload, size_t size)
+{
+    if (!r->fp || r->failed) return;
+
+    RecHeader h = { step, type, count };
+    if (fwrite(&h, sizeof(h), 1, r->fp) != 1 ||
+        (size > 0 && fwrite(payload, size, 1, r->fp) != 1)) {
+        r->failed = true;
+        return;
+    }
+    if (type != REC_END && type != REC_STATE) r->records++;
+}
+
+void recorder_key(Recorder *r, uint64_t step, char key) {
+    put(r, step, REC_KEY, (uint32_t)(unsigned char)key, NULL, 0);
+}
+
+void recorder_obstacles(Recorder *r, uint64_t step, const ObstacleSetMsg *msg) {
+    put(r, step, REC_OBS, (uint32_t)msg->count, msg->obs,
+        (size_t)msg->count * sizeof(ObstacleSpec));
+}
+
+void recorder_targets(Recorder *r, uint64_t step, const TargetSetMsg *msg) {
+    put(r, step, REC_TGT, (uint32_t)msg->count, msg->tgt,
+        (size_t)msg->count * sizeof(TargetSpec));
+}
+
+void recorder_state(Recorder *r, uint64_t step, const DroneStateMsg *s) {
+    put(r, step, REC_STATE, 1, s, sizeof(*s));
+}
+
+int recorder_close(Recorder *r, const RecSummary *end) {
+    if (!r->fp) return -1;
+    if (end) put(r, end->steps, REC_END, 0, end, sizeof(*end));
+
+    bool failed = r->failed;
+    if (fclose(r->fp) != 0) failed = true;
+    r->fp = NULL;
+    return failed ? -1 : 0;
+}
+
+// ---------------- Replay ----------------
+
+// Payload bytes of a record, or -1 for an unknown type / bad count.
+static long payload_size(const RecHeader *h) {
+    switch (h->type) {
+    case REC_KEY:   return 0;
+    case REC_OBS:   return h->count <= BATCH_MAX_COUNT ? (long)(h->count * sizeof(ObstacleSpec)) : -1;
+    case REC_TGT:   return h->count <= BATCH_MAX_COUNT ? (long)(h->count * sizeof(TargetSpec)) : -1;
+    case REC_STATE: return (long)sizeof(DroneStateMsg);
+    case REC_END:   return (long)sizeof(RecSummary);
+    default:        return -1;
+    }
+}
+
+// Walks the records once: checks them, counts the inputs, finds the end
+// record and drops a trailing partial record. Returns 0 or -1.
+// ----------------------------------------------------------------------
+static int scan_records(Replay *rp, const char *path) {
+    size_t   pos  = 0;
+    uint64_t prev = 0;
+
+    while (rp->size - pos >= sizeof(RecHeader)) {
+        RecHeader h;
+        memcpy(&h, rp->data + pos, sizeof(h));
+
+        long len = payload_size(&h);
+        if (len < 0) {
+            fprintf(stderr, "[REPLAY] %s: bad record at byte %zu\n", path, pos);
+            return -1;
+        }
+        if (rp->size - pos - sizeof(h) < (size_t)len) break;   // cut short
+        if (h.step < prev) {
+            fprintf(stderr, "[REPLAY] %s: steps go backwards at byte %zu\n", path, pos);
+            return -1;
+        }
+        prev = h.step;
+
+        if (h.type == REC_END) {
+            memcpy(&rp->end, rp->data + pos + sizeof(h), sizeof(rp->end));
+            rp->has_end = true;
+            rp->size    = pos;   // inputs stop here
+            return 0;
+        }
+        if (h.type == REC_STATE) rp->states++;
+        else                     rp->inputs++;
+        rp->last_step = h.step;
+        pos += sizeof(h) + (size_t)len;
+    }
+    rp->size = pos;
+    return 0;
+}
+
+int replay_load(const char *path, Replay *rp) {
+    memset(rp, 0, sizeof(*rp));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        perror("[REPLAY] fopen");
+        return -1;
+    }
+    if (fread(&rp->hdr, sizeof(rp->hdr), 1, fp) != 1 ||
+        rp->hdr.magic != REC_MAGIC || rp->hdr.version != REC_VERSION) {
+        fprintf(stderr, "[REPLAY] %s: not a recording (or another version)\n", path);
+        fclose(fp);
+        return -1;
+    }
+    if (rp->hdr.params_size != sizeof(SimParams)) {
+        fprintf(stderr, "[REPLAY] %s: recorded by another build (params size %u, expected %zu)\n",
+                path, rp->hdr.params_size, sizeof(SimParams));
+        fclose(fp);
+        return -1;
+    }
+
+    // Reads the records in one piece
+    size_t cap = REC_IO_BUF;
+    for (;;) {
+        unsigned char *nd = realloc(rp->data, cap);
+        if (!nd) {
+            fprintf(stderr, "[REPLAY] %s: out of memory\n", path);
+            fclose(fp);
+            replay_free(rp);
+            return -1;
+        }
+        rp->data  = nd;
+        rp->size += fread(rp->data + rp->size, 1, cap - rp->size, fp);
+        if (rp->size < cap) break;
+        cap *= 2;
+    }
+    bool err = ferror(fp);
+    fclose(fp);
+    if (err) {
+        fprintf(stderr, "[REPLAY] %s: read error\n", path);
+        replay_free(rp);
+        return -1;
+    }
+
+    if (scan_records(rp, path) == -1) {
+        replay_free(rp);
+        return -1;
+    }
+    return 0;
+}
+
+int replay_next_due(Replay *rp, uint64_t step, RecEvent *ev) {
+    if (rp->pos >= rp->size) return 0;
+
+    RecHeader h;
+    memcpy(&h, rp->data + rp->pos, sizeof(h));
+    if (h.step > step || h.type == REC_STATE) return 0;
+
+    const void *payload = rp->data + rp->pos + sizeof(h);
+    memset(ev, 0, sizeof(*ev));
+    ev->type = h.type;
+    switch (h.type) {
+    case REC_KEY: ev->key       = (char)h.count;                          break;
+    case REC_OBS: ev->obs.count = (int)h.count; ev->obs.obs = payload;    break;
+    case REC_TGT: ev->tgt.count = (int)h.count; ev->tgt.tgt = payload;    break;
+    }
+    rp->pos += sizeof(h) + (size_t)payload_size(&h);
+    return 1;
+}
+
+int replay_next_state(Replay *rp, DroneStateMsg *s) {
+    if (rp->pos >= rp->size) return 0;
+
+    RecHeader h;
+    memcpy(&h, rp->data + rp->pos, sizeof(h));
+    if (h.type != REC_STATE) return 0;
+
+    memcpy(s, rp->data + rp->pos + sizeof(h), sizeof(*s));
+    rp->pos += sizeof(h) + sizeof(*s);
+    return 1;
+}
+
+int replay_done(const Replay *rp) {
+    return rp->pos >= rp->size;
+}
+
+void replay_free(Replay *rp) {
+    free(rp->data);
+    rp->data = NULL;
+    rp->size = 0;
+    rp->pos  = 0;
+}
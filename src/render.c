@@ -0,0 +1,201 @@
+// render.c
+// Render thread and snapshot triple buffer of the server (B)
+// ======================================================================
+
+#define _GNU_SOURCE
+
+#include "headers/render.h"
+#include "headers/ui.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+// ---------------- Triple buffer ----------------
+// Three slots: the writer owns `back`, the reader owns `front`, and
+// `middle` holds the last published slot. Publishing and acquiring are a
+// single atomic exchange each, so neither side ever waits for the other.
+// TB_FRESH marks a middle slot the reader has not taken yet.
+#define TB_FRESH 4u
+#define TB_INDEX 3u
+
+static WorldSnapshot     g_slots[3];
+static _Atomic unsigned  g_middle = 1;   // slot index | TB_FRESH
+static unsigned          g_back   = 0;   // event thread only
+static unsigned          g_front  = 2;   // render thread only
+static uint64_t          g_seq    = 0;   // event thread only
+
+// ---------------- Thread state ----------------
+static pthread_t         g_thread;
+static bool              g_running = false;
+static SimParams         g_params;
+static atomic_bool       g_stop    = false;
+static atomic_bool       g_resize  = false;
+static _Atomic uint64_t  g_frames  = 0;
+
+// Swarm positions (render thread only), read from the shared buffer per frame
+static const SwarmBuf   *g_swarm   = NULL;
+static double           *g_swarm_x = NULL;
+static double           *g_swarm_y = NULL;
+static int               g_swarm_n = 0;
+
+// Pending status line (rare: generator ended), guarded by a mutex
+static pthread_mutex_t   g_status_mtx = PTHREAD_MUTEX_INITIALIZER;
+static const char       *g_status_msg = NULL;
+static int               g_status_row = 0;
+
+void render_publish(const WorldSnapshot *ws) {
+    if (!g_running) return;
+
+    // The slot keeps its own item arrays: the pointers of ws are not shared.
+    // They are refreshed only when the items changed since the slot was filled.
+    WorldSnapshot *dst = &g_slots[g_back];
+    Obstacle *obs     = dst->obs;
+    Target   *tgt     = dst->tgt;
+    bool      obs_new = ws->obs_gen == 0 || ws->obs_gen != dst->obs_gen;
+    bool      tgt_new = ws->tgt_gen == 0 || ws->tgt_gen != dst->tgt_gen;
+    *dst = *ws;
+    dst->obs   = obs;
+    dst->tgt   = tgt;
+    dst->n_obs = ws->n_obs < g_params.obs_capacity ? ws->n_obs : g_params.obs_capacity;
+    dst->n_tgt = ws->n_tgt < g_params.tgt_capacity ? ws->n_tgt : g_params.tgt_capacity;
+    if (obs_new) memcpy(obs, ws->obs, (size_t)dst->n_obs * sizeof(*obs));
+    if (tgt_new) memcpy(tgt, ws->tgt, (size_t)dst->n_tgt * sizeof(*tgt));
+    dst->seq = ++g_seq;
+
+    unsigned prev = atomic_exchange_explicit(&g_middle, g_back | TB_FRESH,
+                                             memory_order_acq_rel);
+    g_back = prev & TB_INDEX;
+}
+
+// Render side: swaps in the newest snapshot if there is one.
+static bool acquire_latest(void) {
+    if (!(atomic_load_explicit(&g_middle, memory_order_relaxed) & TB_FRESH))
+        return false;
+    unsigned prev = atomic_exchange_explicit(&g_middle, g_front,
+                                             memory_order_acq_rel);
+    g_front = prev & TB_INDEX;
+    return true;
+}
+
+void render_request_resize(void) {
+    atomic_store(&g_resize, true);
+}
+
+void render_status(int row, const char *msg) {
+    pthread_mutex_lock(&g_status_mtx);
+    g_status_msg = msg;
+    g_status_row = row;
+    pthread_mutex_unlock(&g_status_mtx);
+}
+
+uint64_t render_frames(void) {
+    return atomic_load_explicit(&g_frames, memory_order_relaxed);
+}
+
+static double timespec_sec(const struct timespec *ts) {
+    return (double)ts->tv_sec + 1e-9 * (double)ts->tv_nsec;
+}
+
+static void timespec_add_ns(struct timespec *ts, long ns) {
+    ts->tv_nsec += ns;
+    while (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+// Frame loop: sleeps to an absolute deadline, then draws the newest snapshot.
+// If drawing overruns a whole period, the schedule restarts from "now"
+// instead of bursting to catch up.
+// ----------------------------------------------------------------------
+static void *render_main(void *arg) {
+    (void)arg;
+
+    long period_ns = (long)(1e9 / g_params.ui_fps);
+    bool have_frame = false;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load(&g_stop)) {
+        timespec_add_ns(&next, period_ns);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0) {
+            // EINTR: sleep again until the deadline
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (timespec_sec(&now) - timespec_sec(&next) > 1e-9 * (double)period_ns) {
+            next = now;   // frames dropped, skip ahead
+        }
+
+        if (atomic_exchange(&g_resize, false)) {
+            ui_resize();
+        }
+
+        pthread_mutex_lock(&g_status_mtx);
+        const char *msg = g_status_msg;
+        int row = g_status_row;
+        g_status_msg = NULL;
+        pthread_mutex_unlock(&g_status_mtx);
+        if (msg) ui_status(row, msg);
+
+        if (acquire_latest()) have_frame = true;
+        if (!have_frame) continue;
+
+        const WorldSnapshot *ws = &g_slots[g_front];
+        if (g_swarm_n > 0) swarm_buf_read(g_swarm, g_swarm_x, g_swarm_y, NULL);
+        ui_draw(ws, &g_params, timespec_sec(&now) - ws->hb_stamp,
+                g_swarm_x, g_swarm_y, g_swarm_n);
+        atomic_fetch_add_explicit(&g_frames, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+int render_start(const SimParams *params, const SwarmBuf *swarm) {
+    g_params = *params;
+    if (g_params.ui_fps <= 0.0) g_params.ui_fps = 30.0;
+
+    g_swarm   = swarm;
+    g_swarm_n = swarm ? (int)swarm->shared->count : 0;
+    if (g_swarm_n > 0) {
+        g_swarm_x = malloc((size_t)g_swarm_n * sizeof(double));
+        g_swarm_y = malloc((size_t)g_swarm_n * sizeof(double));
+        if (!g_swarm_x || !g_swarm_y) return -1;
+    }
+    for (int i = 0; i < 3; ++i) {
+        g_slots[i].obs = calloc((size_t)g_params.obs_capacity, sizeof(Obstacle));
+        g_slots[i].tgt = calloc((size_t)g_params.tgt_capacity, sizeof(Target));
+        if (!g_slots[i].obs || !g_slots[i].tgt) return -1;
+    }
+
+    atomic_store(&g_stop, false);
+    g_running = true;
+    if (pthread_create(&g_thread, NULL, render_main, NULL) != 0) {
+        g_running = false;
+        return -1;
+    }
+    return 0;
+}
+
+void render_stop(void) {
+    if (!g_running) return;
+    atomic_store(&g_stop, true);
+    pthread_join(g_thread, NULL);
+    g_running = false;
+
+    free(g_swarm_x);
+    free(g_swarm_y);
+    g_swarm_x = g_swarm_y = NULL;
+    g_swarm_n = 0;
+    for (int i = 0; i < 3; ++i) {
+        free(g_slots[i].obs);
+        free(g_slots[i].tgt);
+        g_slots[i].obs = NULL;
+        g_slots[i].tgt = NULL;
+    }
+}
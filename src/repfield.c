@@ -0,0 +1,93 @@
+// repfield.c
+// Cached obstacle repulsion field of B (see headers/repfield.h)
+// ======================================================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "headers/repfield.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+void repfield_init(RepField *f) {
+    memset(f, 0, sizeof(*f));
+}
+
+void repfield_free(RepField *f) {
+    free(f->p);
+    repfield_init(f);
+}
+
+// Samples the grid at every node: node (i, j) is at (x0 + i*h, x0 + j*h).
+// ----------------------------------------------------------------------
+static int build(RepField *f, const ObsGrid *grid, const SimParams *params) {
+    int res = params->rep_field_res;
+    if (res != f->res) {
+        double *p = realloc(f->p, (size_t)res * (size_t)res * 2 * sizeof(*p));
+        if (!p) return -1;
+        f->p   = p;
+        f->res = res;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    double h = 2.0 * params->world_half / (double)(res - 1);
+    f->x0    = -params->world_half;
+    f->inv_h = 1.0 / h;
+
+    double *p = f->p;
+    for (int j = 0; j < res; ++j) {
+        double y = f->x0 + j * h;
+        for (int i = 0; i < res; ++i) {
+            double Px = 0.0, Py = 0.0;
+            obsgrid_repulsion(grid, f->x0 + i * h, y, params, &Px, &Py);
+            *p++ = Px;
+            *p++ = Py;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    f->build_ms   = 1e3 * (double)(t1.tv_sec - t0.tv_sec) + 1e-6 * (double)(t1.tv_nsec - t0.tv_nsec);
+    f->builds++;
+    f->generation = grid->generation;
+    f->valid      = true;
+    return 0;
+}
+
+// Node coordinate along one axis: cell index *i and fraction *t in [0, 1].
+static inline void locate(const RepField *f, double v, int *i, double *t) {
+    double u = (v - f->x0) * f->inv_h;
+    if (u < 0.0)                 u = 0.0;
+    if (u > (double)(f->res - 1)) u = (double)(f->res - 1);
+    int k = (int)u;
+    if (k > f->res - 2) k = f->res - 2;
+    *i = k;
+    *t = u - (double)k;
+}
+
+bool repfield_lookup(RepField *f, const ObsGrid *grid, const SimParams *params,
+                     double x, double y, double *Px, double *Py)
+{
+    if (params->rep_field_res < 2 || grid->nx <= 0) return false;
+
+    if (!f->valid || f->generation != grid->generation || f->res != params->rep_field_res) {
+        f->valid = false;
+        if (build(f, grid, params) == -1) return false;
+    }
+
+    int    i, j;
+    double tx, ty;
+    locate(f, x, &i, &tx);
+    locate(f, y, &j, &ty);
+
+    const double *a = f->p + 2 * ((size_t)j * (size_t)f->res + (size_t)i);   // (i,   j)
+    const double *b = a + 2 * (size_t)f->res;                                 // (i,   j+1)
+    double w00 = (1.0 - tx) * (1.0 - ty), w10 = tx * (1.0 - ty);
+    double w01 = (1.0 - tx) * ty,         w11 = tx * ty;
+
+    *Px = w00 * a[0] + w10 * a[2] + w01 * b[0] + w11 * b[2];
+    *Py = w00 * a[1] + w10 * a[3] + w01 * b[1] + w11 * b[3];
+    return true;
+}
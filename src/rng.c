@@ -0,0 +1,166 @@
+// rng.c
+// xoshiro256** streams and batch fills (see headers/rng.h)
+// ======================================================================
+
+#include "headers/rng.h"
+
+#include <string.h>   // memcpy
+#include <time.h>
+#include <unistd.h>   // getpid
+
+#define RNG_LANES      4
+#define RNG_DISK_BLOCK 256   // candidate points per fill of rng_fill_disk()
+
+// splitmix64 step: the recommended seeder of xoshiro (any input, including
+// 0, gives a well-mixed output).
+static inline uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream) {
+    // The stream is hashed first, so streams 1, 2, ... of one seed start far apart
+    uint64_t h = stream;
+    uint64_t x = seed ^ splitmix64(&h);
+    for (int i = 0; i < 4; ++i) rng->s[i] = splitmix64(&x);
+    if ((rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]) == 0) rng->s[0] = 1;
+}
+
+uint32_t rng_below(Rng *rng, uint32_t n) {
+    uint64_t m = (uint64_t)(uint32_t)(rng_next(rng) >> 32) * n;
+    if ((uint32_t)m < n) {
+        uint32_t floor_ = (uint32_t)(-n) % n;
+        while ((uint32_t)m < floor_) {
+            m = (uint64_t)(uint32_t)(rng_next(rng) >> 32) * n;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Four xoshiro256** lanes, one state word per array so each line of the
+// step is one operation over RNG_LANES words.
+typedef struct {
+    uint64_t s0[RNG_LANES], s1[RNG_LANES], s2[RNG_LANES], s3[RNG_LANES];
+} RngLanes;
+
+// Lanes seeded from rng (consumes RNG_LANES draws of it).
+static void lanes_seed(RngLanes *L, Rng *rng) {
+    for (int l = 0; l < RNG_LANES; ++l) {
+        uint64_t x = rng_next(rng);
+        L->s0[l] = splitmix64(&x);
+        L->s1[l] = splitmix64(&x);
+        L->s2[l] = splitmix64(&x);
+        L->s3[l] = splitmix64(&x);
+    }
+}
+
+// One step of every lane: RNG_LANES uniform doubles in [0, 1) to u[]
+// (multiples of 2^-52).
+static inline void lanes_uniform(RngLanes *L, double *u) {
+    for (int l = 0; l < RNG_LANES; ++l) {
+        uint64_t r = rng_rotl(L->s1[l] * 5, 7) * 9;
+        uint64_t t = L->s1[l] << 17;
+        L->s2[l] ^= L->s0[l];
+        L->s3[l] ^= L->s1[l];
+        L->s1[l] ^= L->s2[l];
+        L->s0[l] ^= L->s3[l];
+        L->s2[l] ^= t;
+        L->s3[l]  = rng_rotl(L->s3[l], 45);
+        // 52 random bits as the mantissa of a double in [1, 2): no integer
+        // to float conversion, which has no vector form below AVX-512
+        uint64_t bits = (r >> 12) | 0x3ff0000000000000ULL;
+        double   d;
+        memcpy(&d, &bits, sizeof(d));
+        u[l] = d - 1.0;
+    }
+}
+
+// Whole lane steps into out[0..n), n a multiple of RNG_LANES. The body is
+// compiled twice: baseline x86-64 and AVX2 (four 64-bit lanes per register).
+static inline void lanes_fill(RngLanes *L, double *out, int n, double lo, double span) {
+    for (int i = 0; i < n; i += RNG_LANES) {
+        double u[RNG_LANES];
+        lanes_uniform(L, u);
+        for (int l = 0; l < RNG_LANES; ++l) out[i + l] = lo + span * u[l];
+    }
+}
+
+static void lanes_fill_base(RngLanes *L, double *out, int n, double lo, double span) {
+    lanes_fill(L, out, n, lo, span);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void lanes_fill_avx2(RngLanes *L, double *out, int n, double lo, double span) {
+    lanes_fill(L, out, n, lo, span);
+}
+#endif
+
+// ----------------------------------------------------------------------
+void rng_fill_uniform(Rng *rng, double *out, int n, double lo, double hi) {
+    double span = hi - lo;
+
+    // Short fills: seeding the lanes would cost more than it saves
+    if (n < 4 * RNG_LANES) {
+        for (int i = 0; i < n; ++i) out[i] = lo + span * rng_uniform(rng);
+        return;
+    }
+
+    static int use_avx2 = -1;
+    if (use_avx2 < 0) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        use_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+        use_avx2 = 0;
+#endif
+    }
+
+    RngLanes L;
+    lanes_seed(&L, rng);
+    int whole = n - n % RNG_LANES;
+#if defined(__x86_64__) || defined(__i386__)
+    if (use_avx2) lanes_fill_avx2(&L, out, whole, lo, span);
+    else
+#endif
+    lanes_fill_base(&L, out, whole, lo, span);
+
+    if (whole < n) {
+        double u[RNG_LANES];
+        lanes_uniform(&L, u);
+        for (int l = 0; whole + l < n; ++l) out[whole + l] = lo + span * u[l];
+    }
+}
+
+// Points drawn uniformly in the bounding square, kept when inside the disk
+// (pi/4 of them): cheaper than a sqrt, a sin and a cos per point.
+// ----------------------------------------------------------------------
+void rng_fill_disk(Rng *rng, double *x, double *y, int n, double radius) {
+    double u[2 * RNG_DISK_BLOCK];
+    double r2 = radius * radius;
+    int    k  = 0;
+
+    while (k < n) {
+        // Enough candidates for the remaining points on average, plus slack
+        int m = (n - k) + (n - k) / 3 + 4;
+        if (m > RNG_DISK_BLOCK) m = RNG_DISK_BLOCK;
+        rng_fill_uniform(rng, u, 2 * m, -radius, radius);
+        for (int i = 0; i < m && k < n; ++i) {
+            // Branch-free compaction: written always, kept if inside
+            double px = u[2 * i], py = u[2 * i + 1];
+            x[k] = px;
+            y[k] = py;
+            k   += (px*px + py*py <= r2);
+        }
+    }
+}
+
+uint64_t rng_clock_seed(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t x = ((uint64_t)ts.tv_sec << 30) ^ (uint64_t)ts.tv_nsec ^ ((uint64_t)getpid() << 48);
+    uint64_t s = splitmix64(&x);
+    return s ? s : 1;
+}
@@ -0,0 +1,102 @@
+// script.c
+// Scripted key input for B (see headers/script.h)
+// ======================================================================
+
+#include "headers/script.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sorts keys by step, keeping file order within a step (insertion sort:
+// linear for the usual, already ordered file).
+// ----------------------------------------------------------------------
+static void sort_keys(ScriptKey *k, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        ScriptKey cur = k[i];
+        size_t    j   = i;
+        while (j > 0 && k[j - 1].step > cur.step) {
+            k[j] = k[j - 1];
+            j--;
+        }
+        k[j] = cur;
+    }
+}
+
+// Appends one key, growing the array as needed. Returns 0 or -1.
+static int push_key(KeyScript *ks, size_t *cap, uint64_t step, char key) {
+    if (ks->count == *cap) {
+        size_t     ncap = *cap ? *cap * 2 : 64;
+        ScriptKey *nk   = realloc(ks->keys, ncap * sizeof(*nk));
+        if (!nk) return -1;
+        ks->keys = nk;
+        *cap     = ncap;
+    }
+    ks->keys[ks->count].step = step;
+    ks->keys[ks->count].key  = key;
+    ks->count++;
+    return 0;
+}
+
+int script_load(const char *path, KeyScript *ks) {
+    memset(ks, 0, sizeof(*ks));
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror("[SCRIPT] fopen");
+        return -1;
+    }
+
+    size_t cap = 0;
+    char   line[256];
+    int    lineno = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') continue;
+
+        char *end;
+        unsigned long long step = strtoull(p, &end, 10);
+        if (end == p || !isspace((unsigned char)*end)) {
+            fprintf(stderr, "[SCRIPT] %s:%d: expected '<step> <keys>'\n", path, lineno);
+            fclose(fp);
+            script_free(ks);
+            return -1;
+        }
+
+        for (p = end; *p; ++p) {
+            if (isspace((unsigned char)*p)) continue;
+            if (push_key(ks, &cap, (uint64_t)step, *p) == -1) {
+                fclose(fp);
+                script_free(ks);
+                return -1;
+            }
+        }
+    }
+    fclose(fp);
+
+    sort_keys(ks->keys, ks->count);
+    return 0;
+}
+
+int script_next_due(KeyScript *ks, uint64_t step, char *key) {
+    if (ks->next >= ks->count || ks->keys[ks->next].step > step) return 0;
+    *key = ks->keys[ks->next++].key;
+    return 1;
+}
+
+int script_done(const KeyScript *ks) {
+    return ks->next >= ks->count;
+}
+
+void script_free(KeyScript *ks) {
+    free(ks->keys);
+    ks->keys  = NULL;
+    ks->count = 0;
+    ks->next  = 0;
+}
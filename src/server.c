@@ -1,51 +1,51 @@
 // server.c
 // Defines server / blackboard process (B)
-//   - Owns global "blackboard" state: force and drone state
+//   - Owns global "blackboard" state: force and drone state (see blackboard.c)
 //   - Listens to keys from I and states from D (via pipes)
 //   - Sends updated forces to D
 //   - Monitors obstacles and targets
-//   - Draws ncurses User Interface comprising of the drone world and an inspection window
+//   - Publishes world snapshots to the render thread, which draws the ncurses
+//     User Interface (drone world + inspection window) at a fixed frame rate
+//     (see render.c / ui.c), or runs headless and prints periodic stats instead
 //   - Reacts to the commands pause 'p', reset 'O', brake 'd', quit 'q'
+//   - Records the inputs it applies (--record) or replays a recording in
+//     place of I, O and T (--replay), see record.h
+//   - Measures the I->B, B->D, D->B and key->state latencies from the
+//     message stamps and checks their sequence numbers (latency.h); the
+//     histograms go to the log on exit and on SIGUSR1
 // ======================================================================
 
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <signal.h>
 #include <string.h>
-#include <sys/select.h>   // for fd_set, FD_ZERO, FD_SET, select()
+#include <sys/epoll.h>     // epoll_create1, epoll_ctl, epoll_wait
+#include <sys/signalfd.h>  // signalfd (watchdog SIGUSR2 / SIGTERM)
+#include <sys/timerfd.h>   // timerfd (banner blink timing, headless stats)
 #include <sys/types.h>
 
 #include "headers/server.h"
 #include "headers/messages.h"
 #include "headers/util.h"
+#include "headers/blackboard.h"
+#include "headers/ui.h"
+#include "headers/render.h"
+#include "headers/blog.h"
 #include "headers/obstacles.h"
 #include "headers/targets.h"
+#include "headers/script.h"
+#include "headers/record.h"
+#include "headers/latency.h"
 #include <time.h>   // clock_gettime
 
 
-#include <ncurses.h>
 #include <stdio.h>
 #include <stdlib.h>     // exit, strtod
 #include <unistd.h>
 #include <errno.h>
 #include <stdbool.h>
-#include <math.h>  // for sqrt, to be used in key mapping instead of hard code, REP
 
-//#define NUM_OBSTACLES 8
-// Defines global / static array of 8 obstacles
-//static Obstacle g_obstacles[NUM_OBSTACLES];
-
-// Defines scoring globals
-static int g_score             = 0;
-static int g_targets_collected = 0;
-static int g_last_hit_step     = -1;
-static int g_step_counter      = 0;
-
-// blinking warning banner globals
-static int  wd_warning_active = 0;   // warning state ON/OFF
-static int  wd_blink_phase   = 0;   // 0 or 1 (visible / invisible)
-static int  wd_blink_counter = 0;   // counts simulation steps
-
-static int wd_blink_ticks = 0;
+// Blink half-period of the watchdog banner, driven by a timerfd
+#define WD_BLINK_PERIOD_NS 500000000L   // 0.5s ON/OFF toggle
 
 // ---- Heartbeat timing ----
 static struct timespec g_last_hb_ts;
@@ -62,32 +62,161 @@ static void set_last_hb_now(void) {
     g_have_hb = 1;
 }
 
-static double hb_age_sec(void) {
-    if (!g_have_hb) return 0.0;
-    double now = monotonic_now_sec();
-    double last = (double)g_last_hb_ts.tv_sec + 1e-9 * (double)g_last_hb_ts.tv_nsec;
-    return now - last;
+// Time (s) of the last heartbeat; the render thread derives the watchdog countdown from it.
+static double last_hb_sec(void) {
+    if (!g_have_hb) return monotonic_now_sec();
+    return (double)g_last_hb_ts.tv_sec + 1e-9 * (double)g_last_hb_ts.tv_nsec;
+}
+
+
+// ---------------- Event sources multiplexed by epoll ----------------
+// Each registered fd carries its source id in epoll_event.data.u32;
+// adding a channel means adding an id here and one epoll_add() call.
+enum {
+    SRC_KB,          // pipe I->B (keys in pipe mode, EOF only in shm mode)
+    SRC_KB_RING,     // shm mode: key-ring doorbell
+    SRC_D,           // pipe D->B (states in pipe mode, EOF only in shm mode; unused in lockstep)
+    SRC_D_MAILBOX,   // shm mode: state-mailbox doorbell
+    SRC_OBS,         // pipe O->B
+    SRC_TGT,         // pipe T->B
+    SRC_SIGNAL,      // signalfd: SIGUSR2 (watchdog warning), SIGTERM (watchdog stop), SIGINT (headless), SIGWINCH (UI),
+                     //           SIGUSR1 (latency dump)
+    SRC_BLINK,       // timerfd: watchdog banner blink
+    SRC_STATS,       // timerfd: periodic stats line
+    SRC_COUNT
+};
+
+static void epoll_add(int ep_fd, int fd, int src) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN;
+    ev.data.u32 = (uint32_t)src;
+    if (epoll_ctl(ep_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        ui_shutdown();
+        die("[B] epoll_ctl ADD");
+    }
+}
+
+// Starts (on=true) or stops the periodic blink timer.
+static void set_blink_timer(int timer_fd, bool on) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));   // all zero = disarmed
+    if (on) {
+        its.it_value.tv_nsec    = WD_BLINK_PERIOD_NS;
+        its.it_interval.tv_nsec = WD_BLINK_PERIOD_NS;
+    }
+    timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+// ---------------- Periodic stats ----------------
+// Counters accumulated between two stats lines.
+typedef struct {
+    double   t_start;      // time the process started (s)
+    double   t_window;     // start of the current window (s)
+    long     ticks;        // states received from D in the window
+    long     iters;        // loop iterations in the window
+    double   loop_sum;     // summed loop latency (s)
+    double   loop_max;     // worst loop latency (s)
+    uint64_t frames0;      // render frame counter at window start
+} LoopStats;
+
+static void stats_reset_window(LoopStats *st, double now) {
+    st->t_window = now;
+    st->ticks    = 0;
+    st->iters    = 0;
+    st->loop_sum = 0.0;
+    st->loop_max = 0.0;
+    st->frames0  = render_frames();
 }
 
+// Prints one line: elapsed time, ticks/s, frames/s, score, loop latency (avg/max),
+// and the swarm hits when there is a swarm.
+static void stats_print(LoopStats *st, FILE *out, const Blackboard *bb, int swarm_n) {
+    double now    = monotonic_now_sec();
+    double window = now - st->t_window;
+    if (window <= 0.0) window = 1e-9;
+
+    double avg_us = st->iters > 0 ? 1e6 * st->loop_sum / (double)st->iters : 0.0;
+
+    fprintf(out,
+            "[B] t=%.1fs ticks/s=%.1f frames/s=%.1f score=%d targets=%d paused=%d loop_us avg=%.1f max=%.1f\n",
+            now - st->t_start,
+            (double)st->ticks / window,
+            (double)(render_frames() - st->frames0) / window,
+            bb->score,
+            bb->targets_collected,
+            bb->paused ? 1 : 0,
+            avg_us,
+            1e6 * st->loop_max);
+    if (swarm_n > 0) {
+        fprintf(out, "[B]   swarm=%d swarm_hits=%d\n", swarm_n, bb->swarm_hits);
+    }
+    fflush(out);
 
-// ---------------- Watchdog signal flags (set by signal handlers) ----------------
-static volatile sig_atomic_t g_wd_warning_flag = 0; // set by SIGUSR2 handler
-static volatile sig_atomic_t g_wd_stop    = 0;  // set when SIGTERM arrives
+    stats_reset_window(st, now);
+}
 
-static void on_watchdog_warning(int signo) {
-    (void)signo;
-    g_wd_warning_flag = 1;
+// ---------------- Record / replay ----------------
+// Hands the recorded inputs due at `step` to the blackboard, in file order,
+// and records them again when a recorder is open. Returns true if one of
+// them is the quit key.
+// ----------------------------------------------------------------------
+static bool replay_apply_due(Replay *rp, uint64_t step, Blackboard *bb, const SimParams *params,
+                             const ForceLink *link, Recorder *rec, FILE *logfile)
+{
+    RecEvent ev;
+    while (replay_next_due(rp, step, &ev)) {
+        switch (ev.type) {
+        case REC_KEY:
+            if (rec) recorder_key(rec, step, ev.key);
+            if (bb_handle_key(bb, ev.key, params, link, logfile)) return true;
+            break;
+        case REC_OBS:
+            if (rec) recorder_obstacles(rec, step, &ev.obs);
+            bb_accept_obstacles(bb, &ev.obs, params, logfile);
+            break;
+        case REC_TGT:
+            if (rec) recorder_targets(rec, step, &ev.tgt);
+            bb_accept_targets(bb, &ev.tgt, params, logfile);
+            break;
+        }
+    }
+    return false;
 }
 
-static void on_watchdog_stop(int signo) {
-    (void)signo;
-    g_wd_stop = 1;
+// Sleeps until monotonic time t (s), for the real-time replay.
+static void sleep_until(double t) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)t;
+    ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
 }
 
-// ---------------- Watchdog banner UI state ----------------
-// Show a warning banner for a limited amount of time after SIGUSR2
-// We store it as "how many simulation steps remaining" to show the banner.
-static char watchdog_banner_msg[] = "WATCHDOG WARNING, system may be unstable"; 
+// Final line of every run: the numbers a replay must reproduce, at full
+// precision. With a replay, also says whether they match the recording.
+// ----------------------------------------------------------------------
+static void report_final(const Blackboard *bb, uint64_t steps, const Replay *rp,
+                         FILE *logfile, FILE *stats_out)
+{
+    char line[512];
+    int  n = snprintf(line, sizeof(line),
+                      "[B] final: steps=%llu score=%d targets=%d x=%.17g y=%.17g vx=%.17g vy=%.17g\n",
+                      (unsigned long long)steps, bb->score, bb->targets_collected,
+                      bb->cur_state.x, bb->cur_state.y, bb->cur_state.vx, bb->cur_state.vy);
+    if (rp && rp->has_end && n > 0 && (size_t)n < sizeof(line)) {
+        const RecSummary *e = &rp->end;
+        bool same = e->steps == steps && e->score == bb->score &&
+                    e->targets == bb->targets_collected &&
+                    memcmp(&e->state, &bb->cur_state, offsetof(DroneStateMsg, stamp)) == 0;
+        snprintf(line + n, sizeof(line) - (size_t)n,
+                 "[B] replay: %s the recording (steps=%llu score=%d targets=%d x=%.17g y=%.17g)\n",
+                 same ? "matches" : "DIFFERS from",
+                 (unsigned long long)e->steps, e->score, e->targets, e->state.x, e->state.y);
+    }
+    if (logfile) fputs(line, logfile);
+    if (stats_out) fputs(line, stats_out);
+}
 
 /**
  * @brief Main function for the Server (B) process.
@@ -96,366 +225,463 @@ static char watchdog_banner_msg[] = "WATCHDOG WARNING, system may be unstable";
  * Acts as the "Blackboard" or central hub of the architecture.
  * - **Responsibility**: Maintains the authoritative state of the world (drone, obstacles, targets).
  * - **IPC Hub**: Multiplexes inputs from Keyboard (I), Dynamics (D), Obstacles (O), and Targets (T).
- * - **Visualization**: Draws the ncurses UI.
+ * - **Visualization**: Feeds the render thread (ncurses UI), or prints periodic stats when headless.
  * - **Synchronization**: Sends the official force commands to Dynamics to step the physics.
  * 
  * @param fd_kb      Pipe FD for reading KeyMsg from Keyboard (I).
  * @param fd_to_d    Pipe FD for writing ForceStateMsg to Dynamics (D).
  * @param fd_from_d  Pipe FD for reading DroneStateMsg from Dynamics (D).
- * @param fd_obs     Pipe FD for reading obstacles from Generator (O).
- * @param fd_tgt     Pipe FD for reading targets from Generator (T).
- * @param pid_W      PID of the Watchdog process (for sending heartbeat signals).
+ * @param fd_obs     Pipe FD for reading obstacles from Generator (O), -1 when replaying.
+ * @param fd_tgt     Pipe FD for reading targets from Generator (T), -1 when replaying.
+ * @param hb         Shared heartbeat counters: B beats once per state, W polls them.
  * @param params     Simulation parameters.
+ * @param ipc        Shared B<->D mailbox (shm mode), NULL in pipe mode.
+ * @param opts       Command-line options (headless mode, stats output, lockstep, script,
+ *                   record / replay).
+ * @param swarm      Shared swarm positions from D (swarm=N), NULL without a swarm. B reads
+ *                   them after each state for the hit test; the render thread reads them
+ *                   directly when it draws a frame.
+ *
+ * Lockstep mode (opts->lockstep_steps > 0): the loop polls its event sources
+ * without blocking, then sends D one numbered StepRequestMsg carrying the
+ * latest force and waits for the matching StepReplyMsg. D does not sleep, so
+ * the B/D pipeline runs as fast as the CPU allows; the run ends after
+ * lockstep_steps steps and reports steps/s.
+ *
+ * The binary log (logs/server.blog) is opened by the caller, which knows all
+ * PIDs for its header; this function closes it on exit.
  */
-void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int fd_tgt, pid_t pid_W, SimParams params) 
+void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int fd_tgt, HeartbeatBoard *hb, SimParams params, ShmIpc *ipc,
+                        const ServerOptions *opts, const SwarmBuf *swarm)
 {
     // --- Opens logfile ---
     FILE *logfile = open_process_log("server", "B");
     if (!logfile) {
-        endwin();
         die("[B] cannot open logs/server.log");
     }
     // Initialize heartbeat tracking
     set_last_hb_now(); // assume "alive" at start
 
-    // --- Initialize ncurses ---
-    initscr();      // Assignment-1 (previously was called inside loop which caused seldom window flickering issues)
-    cbreak();
-    noecho();
-    curs_set(0);  // hide cursor
-
-    // Assignment-1 (previously was defined inside loop casing uneccessary repeated calls)
-    // ---- ncurses color init (DO THIS ONCE) ----
-    if (has_colors()) {     
-        start_color();
-
-        // Only attempt init_color if terminal supports changing colors.
-        if (can_change_color()) {
-            init_color(COLOR_YELLOW, 1000, 500, 0); // orange-ish
-            init_color(COLOR_GREEN,  0, 1000, 0);   // green
-        }
+    // --- Stats output: stderr when headless, or the --stats-file if given ---
+    FILE *stats_out = NULL;
+    if (opts->stats_path) {
+        stats_out = fopen(opts->stats_path, "a");
+        if (!stats_out) die("[B] cannot open stats file");
+    } else if (opts->headless) {
+        stats_out = stderr;
+    }
+
+    fprintf(logfile, "[B] obstacle repulsion: kernel=%s (asked %s)\n",
+            simd_name(obsgrid_select_kernel(params.obs_simd)), simd_name(params.obs_simd));
 
-        init_pair(1, COLOR_YELLOW, COLOR_BLACK); // obstacles
-        init_pair(2, COLOR_GREEN,  COLOR_BLACK); // targets
-        init_pair(3, COLOR_RED,    COLOR_BLACK); // watchdog warning
-    } else {
-        // If cmd doesnot permit colors, then continue without colors.
+    // --- Obstacle / target pools, sized once from params.txt ---
+    if (obstacle_store_init(params.obs_capacity, params.world_half) == -1 ||
+        target_store_init(params.tgt_capacity, params.world_half) == -1) {
+        die("[B] cannot allocate obstacle / target pools");
+    }
+    // Live items gathered densely for the snapshots, regathered only when the
+    // pool generation moves (spawn, expiry, hit); never in headless mode
+    Obstacle *snap_obs = malloc((size_t)g_obs_pool.cap * sizeof(*snap_obs));
+    Target   *snap_tgt = malloc((size_t)g_tgt_pool.cap * sizeof(*snap_tgt));
+    if (!snap_obs || !snap_tgt) die("[B] cannot allocate snapshot buffers");
+    unsigned snap_obs_gen = 0, snap_tgt_gen = 0;   // pool generations gathered (0 = none)
+    // Variable-length batches from O and T, grown to the largest one seen
+    BatchBuf obs_buf = { NULL, 0 };
+    BatchBuf tgt_buf = { NULL, 0 };
+    fprintf(logfile, "[B] pools: %d obstacle slot(s), %d target slot(s)\n",
+            g_obs_pool.cap, g_tgt_pool.cap);
+    fflush(logfile);
+
+    // --- Scripted keys (optional), applied by step number ---
+    KeyScript script;
+    bool have_script = false;
+    if (opts->script_path) {
+        if (script_load(opts->script_path, &script) == -1) die("[B] cannot load key script");
+        have_script = true;
+        fprintf(logfile, "[B] Key script '%s': %zu key(s)\n", opts->script_path, script.count);
+        fflush(logfile);
     }
 
-    // ---------------- Install signal handlers for Watchdog ----------------
-    struct sigaction sa_warn;
-    memset(&sa_warn, 0, sizeof(sa_warn));
-    sa_warn.sa_handler = on_watchdog_warning;
-    sigemptyset(&sa_warn.sa_mask);
-    sa_warn.sa_flags = SA_RESTART;
-    if (sigaction(SIGUSR2, &sa_warn, NULL) == -1) {
-        fprintf(logfile, "[B] sigaction(SIGUSR2) failed: %s\n", strerror(errno));
+    bool lockstep = opts->lockstep_steps > 0;
+
+    // --- Replay (optional): the recording stands in for I, O and T, and
+    //     for D too when it was made in real time (its states are in it) ---
+    Replay *replay        = opts->replay;
+    bool    replay_states = replay && !replay->hdr.lockstep;
+    if (replay) {
+        fprintf(logfile, "[B] Replaying %zu input(s) over %ld step(s)%s%s\n",
+                replay->inputs, opts->lockstep_steps,
+                replay_states ? ", states from the recording" : "",
+                opts->replay_realtime ? ", at the recorded pace" : "");
+        fflush(logfile);
+    }
+
+    // --- Session recording (optional): every applied input, by step, and
+    //     every state unless they come from D in lockstep ---
+    bool      rec_states = !lockstep || replay_states;
+    Recorder  recorder;
+    Recorder *rec = NULL;
+    if (opts->record_path) {
+        if (recorder_open(&recorder, opts->record_path, &params, !rec_states) == -1) {
+            die("[B] cannot create the recording");
+        }
+        rec = &recorder;
+        fprintf(logfile, "[B] Recording to '%s'%s\n", opts->record_path,
+                rec_states ? " (inputs and states)" : " (inputs)");
         fflush(logfile);
     }
 
-    struct sigaction sa_stop;
-    memset(&sa_stop, 0, sizeof(sa_stop));
-    sa_stop.sa_handler = on_watchdog_stop;
-    sigemptyset(&sa_stop.sa_mask);
-    sa_stop.sa_flags = SA_RESTART;
-    if (sigaction(SIGTERM, &sa_stop, NULL) == -1) {
-        fprintf(logfile, "[B] sigaction(SIGTERM) failed: %s\n", strerror(errno));
+    // --- Initialize ncurses (not in headless mode) ---
+    if (!opts->headless) {
+        ui_init();
+    }
+
+    // ---------------- Watchdog signals through a signalfd ----------------
+    // SIGUSR2 (warning) and SIGTERM (stop) are blocked and read as ordinary
+    // events in the loop, so no async handler and no flag polling are needed.
+    // Headless runs also stop cleanly on Ctrl-C (SIGINT); with the UI,
+    // SIGWINCH arrives here too and triggers the static-layer rebuild.
+    // SIGUSR1 (kill -USR1 <pid of B>) writes the latency histograms to the log.
+    sigset_t wd_sigs;
+    sigemptyset(&wd_sigs);
+    sigaddset(&wd_sigs, SIGUSR2);
+    sigaddset(&wd_sigs, SIGTERM);
+    sigaddset(&wd_sigs, SIGUSR1);
+    if (opts->headless) sigaddset(&wd_sigs, SIGINT);
+    else                sigaddset(&wd_sigs, SIGWINCH);
+    // Blocked before the render thread starts, so it inherits the mask
+    if (sigprocmask(SIG_BLOCK, &wd_sigs, NULL) == -1) {
+        fprintf(logfile, "[B] sigprocmask failed: %s\n", strerror(errno));
         fflush(logfile);
     }
+    int sig_fd = signalfd(-1, &wd_sigs, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sig_fd == -1) {
+        ui_shutdown();
+        die("[B] signalfd");
+    }
+
+    // Blink timer: armed only while the watchdog banner is shown
+    int blink_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (blink_fd == -1) {
+        ui_shutdown();
+        die("[B] timerfd_create");
+    }
+
+    // Stats timer: armed only when a stats output exists
+    int stats_fd = -1;
+    if (stats_out) {
+        stats_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (stats_fd == -1) {
+            ui_shutdown();
+            die("[B] timerfd_create (stats)");
+        }
+        double iv = opts->stats_interval > 0.0 ? opts->stats_interval : 1.0;
+        struct itimerspec its;
+        its.it_value.tv_sec     = (time_t)iv;
+        its.it_value.tv_nsec    = (long)((iv - (double)(time_t)iv) * 1e9);
+        its.it_interval         = its.it_value;
+        timerfd_settime(stats_fd, 0, &its, NULL);
+    }
+
+    // ---------------- Registers all event sources ----------------
+    int ep_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ep_fd == -1) {
+        ui_shutdown();
+        die("[B] epoll_create1");
+    }
+    epoll_add(ep_fd, fd_kb,     SRC_KB);
+    if (!lockstep) {
+        epoll_add(ep_fd, fd_from_d, SRC_D);   // lockstep reads D's replies synchronously
+    }
+    if (fd_obs != -1) epoll_add(ep_fd, fd_obs, SRC_OBS);
+    if (fd_tgt != -1) epoll_add(ep_fd, fd_tgt, SRC_TGT);
+    epoll_add(ep_fd, sig_fd,    SRC_SIGNAL);
+    epoll_add(ep_fd, blink_fd,  SRC_BLINK);
+    if (stats_fd != -1) {
+        epoll_add(ep_fd, stats_fd, SRC_STATS);
+    }
+    if (ipc) {
+        epoll_add(ep_fd, ipc->key_doorbell_fd,   SRC_KB_RING);
+        epoll_add(ep_fd, ipc->state_doorbell_fd, SRC_D_MAILBOX);
+    }
+
+    // Render thread: draws the newest snapshot at ui_fps, decoupled from this loop
+    if (!opts->headless && render_start(&params, swarm) == -1) {
+        ui_shutdown();
+        die("[B] render thread");
+    }
 
 
     // --- Defines Blackboard state (model of the world)
-    ForceStateMsg cur_force;
-    cur_force.Fx = 0.0;
-    cur_force.Fy = 0.0;
-    cur_force.reset = 0;
+    Blackboard bb;
+    bb_init(&bb);
+
+    // Forces go through the pipe, or through the shared mailbox in shm mode
+    ForceLink link;
+    link.fd   = fd_to_d;
+    link.mbox = ipc ? &ipc->shared->mbox : NULL;
 
-    DroneStateMsg cur_state = (DroneStateMsg){0.0, 0.0, 0.0, 0.0};
-    char last_key = '?';
-    bool paused = false;
+    // Lockstep: forces are latched and travel with the next step request
+    ForceStateMsg step_force = { .Fx = 0.0, .Fy = 0.0, .reset = 0 };
+    link.latch = lockstep ? &step_force : NULL;
 
     // Sends to helper rather than directly write to D
     // Initial state is zero, so cur_state is still {0,0,0,0}.
     // Sends initial total force (which is just user=0 + obstacles repulsion).
-    send_total_force_to_d(&cur_force,
-                          &cur_state,
+    send_total_force_to_d(&bb.cur_force,
+                          &bb.cur_state,
                           &params,
                           g_obstacles,
-                          NUM_OBSTACLES,
-                          fd_to_d,
-                          logfile,
-                          "init");
+                          g_obs_pool.cap,
+                          &bb.obs_grid,
+                          &bb.rep_field,
+                          &link,
+                          BLOG_REASON_INIT);
+
+
+    // Keys handled in one loop pass (one in pipe mode, a drained ring batch in shm mode)
+    static KeyRingEntry key_batch[KEY_RING_CAP];
+    // shm mode: last key-ring overrun total written to the log
+    uint64_t kb_overruns_reported = 0;
+    // Headless: stdin may end long before the run does
+    bool kb_open = true;
+    // Final status line, shown once the render thread has stopped
+    const char *exit_msg = NULL;
+    int         exit_row = 0;
+
+    WorldSnapshot snap;
+
+    // Swarm positions, refreshed from the shared buffer after every state
+    int     swarm_n = swarm ? (int)swarm->shared->count : 0;
+    double *swarm_x = NULL, *swarm_y = NULL;
+    if (swarm_n > 0) {
+        swarm_x = malloc((size_t)swarm_n * sizeof(double));
+        swarm_y = malloc((size_t)swarm_n * sizeof(double));
+        if (!swarm_x || !swarm_y) die("[B] swarm buffers");
+    }
 
+    // States handled so far (= step number of the newest state)
+    uint64_t sim_step = 0;
 
-    int max_y, max_x;
+    LoopStats stats;
+    stats.t_start = monotonic_now_sec();
+    stats_reset_window(&stats, stats.t_start);
 
-    // Needed for handling time_since_last_hit
-    double time_since_last_hit = 0; // for tracking time since last hit
+    // Per-hop latencies and sequence checks, from the message stamps
+    static LatencyStats lat;
+    lat_init(&lat);
 
     // --- Main event loop ---
     while (1) {
 
-        // ---------------- Watchdog notifications ----------------
-        // Watchdog warning -> start banner
-        // Convert the SIGUSR2 flag into a visible banner for 2 seconds.
-        // We do this here (NOT in signal handler) because ncurses is not signal-safe.
-        if (g_wd_warning_flag) {
-            g_wd_warning_flag = 0;
-
-            // Start blinking warning until SIGTERM arrives.
-            wd_warning_active = 1;
-            wd_blink_phase    = 1;   // start "visible"
-            wd_blink_counter  = 0;
-            wd_blink_ticks    = 0;
-
-            fprintf(logfile, "[B] WATCHDOG WARNING: blinking ON\n");
-            fflush(logfile);
+        // ---------------- Waits for events (epoll) ----------------
+        // No timeout: B sleeps until a pipe, doorbell, signal or timer is ready.
+        // Lockstep only polls (timeout 0): D is driven below, one step per pass.
+        // EINTR just retries (SIGWINCH comes through the signalfd).
+        struct epoll_event evs[SRC_COUNT];
+        int nev = epoll_wait(ep_fd, evs, SRC_COUNT, lockstep ? 0 : -1);
+        if (nev == -1) {
+            if (errno == EINTR) continue;
+            fclose(logfile);
+            ui_shutdown();
+            die("[B] epoll_wait failed");
         }
 
+        // Loop latency: from wake-up to the end of this pass
+        double t_wake = monotonic_now_sec();
 
-
-        if (g_wd_stop) {
-            fprintf(logfile, "[B] WATCHDOG STOP: received SIGTERM, exiting.\n");
-            fflush(logfile);
-            break; // exit from server loop
-        }
-
-        // Queries current terminal size (for resizing).
-        getmaxyx(stdscr, max_y, max_x);
-
-        // Plans layout:
-        //   - 2 top lines of info
-        //   - horizontal separator
-        //   - world area below
-        //   - inspection panel on the right
-        int content_top    = 1;                 // first row inside border
-        int top_lines      = 2;                 // 2 text lines at top
-        int top_info_y1    = content_top;
-        int top_info_y2    = content_top + 1;
-        int sep_y          = content_top + top_lines; // horizontal separator row
-        int content_bottom = max_y - 2;         // last row inside bottom border
-
-        if (sep_y >= content_bottom) {
-            sep_y = content_top; // in tiny terminals
+        bool ready[SRC_COUNT] = { false };
+        for (int i = 0; i < nev; ++i) {
+            ready[evs[i].data.u32] = true;
         }
 
-        // Defines right inspection panel width
-        int insp_width = 35;               // was 35
-        if (max_x < insp_width + 10) {
-            insp_width = max_x / 4;
-            if (insp_width < 10) insp_width = 10;
-        }
-        int insp_start_x = max_x - insp_width;
-        if (insp_start_x < 1) insp_start_x = 1;
-
-        // Defines world area below separator.
-        int world_top    = sep_y + 1;
-        if (world_top > content_bottom) world_top = content_top + 1;
-        int world_bottom = content_bottom;
-        int world_height = world_bottom - world_top + 1;
-        if (world_height < 1) world_height = 1;
-
-        // Defines left world width.
-        int main_width = insp_start_x - 2;
-        if (main_width < 10) main_width = 10;
-
-        // ---------------- Uses select() to wait for events ----------------        // Uses select() to wait for data from keyboard, dynamics, obstacles, and targets.
-        // Also handles EINTR (signal generated on resize to permit window resize without exiting the program).
-        fd_set rfds;
-        int maxfd = fd_kb;
-        
-        if (fd_from_d > maxfd) maxfd = fd_from_d;
-        if (fd_obs    > maxfd) maxfd = fd_obs;
-        if (fd_tgt    > maxfd) maxfd = fd_tgt;
-        maxfd += 1;
-
-        int sel;
-        while (1) {
-            FD_ZERO(&rfds);
-            FD_SET(fd_kb,     &rfds);
-            FD_SET(fd_from_d, &rfds);
-            //
-            FD_SET(fd_obs,    &rfds);
-            FD_SET(fd_tgt,    &rfds);
-
-            // sel = select(maxfd, &rfds, NULL, NULL, NULL);
-            struct timeval tv;
-            tv.tv_sec  = 0;
-            tv.tv_usec = 100000; // 100 ms
-
-            sel = select(maxfd, &rfds, NULL, NULL, &tv);
-
-            if (sel == 0) {
-                if (wd_warning_active && !paused) {
-                    wd_blink_ticks++;
-
-                    // blink every 5 ticks -> 5 * 100ms = 500ms
-                    if (wd_blink_ticks >= 5) {
-                        wd_blink_ticks = 0;
-                        wd_blink_phase = !wd_blink_phase;
+        // ------------------------------------------------------------------
+        // Handles watchdog notifications (signalfd)
+        // Warning -> start blinking banner until heartbeats resume or SIGTERM arrives.
+        // Stop    -> leave the loop and shut down cleanly.
+        // ------------------------------------------------------------------
+        if (ready[SRC_SIGNAL]) {
+            bool stop = false;
+            struct signalfd_siginfo si;
+            while (read(sig_fd, &si, sizeof(si)) == (ssize_t)sizeof(si)) {
+                if (si.ssi_signo == SIGUSR2) {
+                    blog_watchdog(BLOG_WD_WARNING, monotonic_now_sec() - last_hb_sec());
+                    bb.wd_warning_active = 1;
+                    bb.wd_blink_phase    = 1;   // start "visible"
+                    set_blink_timer(blink_fd, true);
+
+                    if (BLOG_ON(LOG_CAT_WATCHDOG, LOG_INFO)) {
+                        fprintf(logfile, "[B] WATCHDOG WARNING: blinking ON\n");
+                        fflush(logfile);
                     }
+                } else if (si.ssi_signo == SIGTERM) {
+                    blog_watchdog(BLOG_WD_STOP, monotonic_now_sec() - last_hb_sec());
+                    fprintf(logfile, "[B] WATCHDOG STOP: received SIGTERM, exiting.\n");
+                    stop = true;
+                } else if (si.ssi_signo == SIGWINCH) {
+                    render_request_resize();
+                } else if (si.ssi_signo == SIGINT) {
+                    fprintf(logfile, "[B] SIGINT received, exiting.\n");
+                    stop = true;
+                } else if (si.ssi_signo == SIGUSR1) {
+                    lat_print(logfile, "[B]", &lat);
                 }
+            }
+            if (stop) {
+                fflush(logfile);
+                break; // exit from server loop
+            }
+        }
 
-
-
+        // Blink timer: toggles the banner (frozen while paused)
+        if (ready[SRC_BLINK]) {
+            uint64_t expirations = 0;
+            if (read(blink_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations)) {
+                if (bb.wd_warning_active && !bb.paused && (expirations & 1u)) {
+                    bb.wd_blink_phase = !bb.wd_blink_phase;
                 }
+            }
+        }
 
-            if (sel == -1) {
-                if (errno == EINTR) {
-                    // Retries if interrupted by signal (like resize)
-                    continue;
-                } else {
-                    fclose(logfile);
-                    endwin();
-                    die("[B] select failed");
-                }
+        // Stats timer: one line per interval
+        if (ready[SRC_STATS]) {
+            uint64_t expirations = 0;
+            if (read(stats_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations)) {
+                stats_print(&stats, stats_out, &bb, swarm_n);
             }
-            break; // sel >= 0, we have an event
         }
 
         // ------------------------------------------------------------------
         // Handles keyboard input from I (if available).
+        //   pipe mode: one KeyMsg per read().
+        //   shm mode : drains every pending key from the ring in one pass;
+        //              the I->B pipe then only reports EOF.
         // ------------------------------------------------------------------
-        if (FD_ISSET(fd_kb, &rfds)) {
-            KeyMsg km;
-            int n = read(fd_kb, &km, sizeof(km));
-            if (n <= 0) {
-                mvprintw(0, 1, "[B] Keyboard process ended (EOF).");
-                refresh();
-                break;
-            }
+        int  nkeys  = 0;
+        bool kb_eof = false;
 
-            last_key = km.key;
+        if (ipc) {
+            if (ready[SRC_KB_RING] || ready[SRC_KB]) {
+                uint64_t overruns = 0;
+                nkeys = keyring_drain(ipc, key_batch, KEY_RING_CAP, &overruns);
 
-            // Handles Quit request
-            if (km.key == 'q') {
-                fprintf(logfile, "QUIT requested by 'q'\n");
-                fflush(logfile);
-                break;
-            }
-            // ------------------------------------------------------------------
-            // Handles Pause toggle
-            // ------------------------------------------------------------------
-            if (km.key == 'p') {
-                paused = !paused;
-
-                if (paused) {
-                    // Zeroes the force when entering pause.
-                    cur_force.Fx = 0.0;
-                    cur_force.Fy = 0.0;
-                    cur_force.reset = 0;
-                    send_total_force_to_d(&cur_force,
-                                        &cur_state,
-                                        &params,
-                                        g_obstacles,
-                                        NUM_OBSTACLES,
-                                        fd_to_d,
-                                        logfile,
-                                        "key");
-                    fprintf(logfile, "PAUSE: ON\n");
-                } else {
-                    fprintf(logfile, "PAUSE: OFF\n");
+                if (overruns != kb_overruns_reported) {
+                    fprintf(logfile, "[B] Key ring overrun: %llu key(s) dropped so far\n",
+                            (unsigned long long)overruns);
+                    fflush(logfile);
+                    kb_overruns_reported = overruns;
                 }
-                fflush(logfile);
             }
-            // ------------------------------------------------------------------
-            // Handles Reset (uppercase O)
-            // ------------------------------------------------------------------
-            else if (km.key == 'O') {
-                // Resets server-side state
-                cur_state.x  = 0.0;
-                cur_state.y  = 0.0;
-                cur_state.vx = 0.0;
-                cur_state.vy = 0.0;
-
-                // Resets forces
-                cur_force.Fx = 0.0;
-                cur_force.Fy = 0.0;
-                cur_force.reset = 1; // Signals D to reset its state
-
-                send_total_force_to_d(&cur_force,
-                      &cur_state,
-                      &params,
-                      g_obstacles,
-                      NUM_OBSTACLES,
-                      fd_to_d,
-                      logfile,
-                      "key");
-
-                cur_force.reset = 0; // Clears locally
-                paused = false;      // Unpauses
-
-                fprintf(logfile, "RESET requested (O)\n");
-                fflush(logfile);
+            if (ready[SRC_KB] && kb_open) {
+                char c;
+                if (read(fd_kb, &c, 1) <= 0) kb_eof = true;
             }
-            // ------------------------------------------------------------------
-            // Handles Directional keys and the break 'd'
-            // ------------------------------------------------------------------
-            else {
-                double dFx, dFy;
-                direction_from_key(km.key, &dFx, &dFy);
-
-                if (!paused) {
-                    if (km.key == 'd') {
-                        // Brake: Zeroes forces
-                        cur_force.Fx = 0.0;
-                        cur_force.Fy = 0.0;
-                    } else {
-                        // Accumulates new force
-                        cur_force.Fx += dFx * params.force_step;
-                        cur_force.Fy += dFy * params.force_step;
-                    }
-
-                    cur_force.reset = 0;
+        } else if (ready[SRC_KB] && kb_open) {
+            int n = read(fd_kb, &key_batch[0].msg, sizeof(key_batch[0].msg));
+            if (n <= 0) kb_eof = true;
+            else        nkeys  = 1;
+        }
 
-                    send_total_force_to_d(&cur_force,
-                        &cur_state,
-                        &params,
-                        g_obstacles,
-                        NUM_OBSTACLES,
-                        fd_to_d,
-                        logfile,
-                        "key");
+        bool     quit   = false;
+        uint64_t t_keys = nkeys > 0 ? lat_now_ns() : 0;
+        for (int k = 0; k < nkeys && !quit; ++k) {
+            const KeyMsg *km  = &key_batch[k].msg;
+            char          key = km->key;
+            lat_key_received(&lat, km, t_keys);
+            // Replay: live keys can only stop it
+            if (replay && key != 'q') continue;
+            if (rec) recorder_key(rec, sim_step, key);
+            uint32_t sent = force_link_last_seq();
+            quit = bb_handle_key(&bb, key, &params, &link, logfile);
+            if (force_link_last_seq() != sent) lat_key_applied(&lat, km, sent + 1);
+        }
+        // Scripted keys due before the next step
+        char skey;
+        while (have_script && !quit && script_next_due(&script, sim_step + 1, &skey)) {
+            if (rec) recorder_key(rec, sim_step, skey);
+            quit = bb_handle_key(&bb, skey, &params, &link, logfile);
+        }
+        // Recorded inputs due before the next step (those of step 0 on the first pass)
+        if (replay && !quit) {
+            quit = replay_apply_due(replay, sim_step, &bb, &params, &link, rec, logfile);
+        }
+        if (quit) break;
 
-                    fprintf(logfile,
-                            "KEY: %c  dFx=%.1f dFy=%.1f -> Fx=%.2f Fy=%.2f\n",
-                            km.key, dFx, dFy, cur_force.Fx, cur_force.Fy);
-                    fflush(logfile);
-                } else {
-                    // Paused: Ignores directional changes (but still log)
-                    fprintf(logfile,
-                            "KEY: %c ignored (PAUSED)\n", km.key);
-                    fflush(logfile);
-                }
+        if (kb_eof) {
+            if (!opts->headless) {
+                exit_msg = "[B] Keyboard process ended (EOF).";
+                exit_row = 0;
+                break;
             }
+            // Headless: scripted input ran out, the simulation keeps going
+            // until SIGINT / SIGTERM or D ends.
+            fprintf(logfile, "[B] Keyboard input ended (EOF), continuing headless.\n");
+            fflush(logfile);
+            epoll_ctl(ep_fd, EPOLL_CTL_DEL, fd_kb, NULL);
+            kb_open = false;
         }
 
         // ------------------------------------------------------------------
         // 4) Handles state updates from D (if available).
+        //    shm mode: the doorbell says a new state sits in the mailbox;
+        //    the D->B pipe then only delivers EOF when D exits.
         // ------------------------------------------------------------------
-        if (FD_ISSET(fd_from_d, &rfds)) {
-            DroneStateMsg s;
-            int n = read(fd_from_d, &s, sizeof(s));
-            if (n == (int)sizeof(s)) {
-                // We received a valid "tick" from dynamics => system is alive
-                set_last_hb_now();
-
-                // Send heartbeat to watchdog (as before)
-                if (pid_W > 0) kill(pid_W, SIGUSR1);
+        DroneStateMsg s;
+        bool got_state = false;
+
+        // Replay of a real-time run: the next state comes from the recording
+        if (replay_states) {
+            if (!replay_next_state(replay, &s)) {
+                exit_msg = "[B] Recording ended.";
+                exit_row = 1;
+                break;
+            }
+            got_state = true;
+        }
+        // Lockstep: one numbered step per pass, B waits for D's reply
+        else if (lockstep) {
+            StepRequestMsg req;
+            StepReplyMsg   rep;
+            req.step  = sim_step + 1;
+            req.force = step_force;
+            step_force.reset = 0;
+
+            if (write(fd_to_d, &req, sizeof(req)) != (ssize_t)sizeof(req) ||
+                read(fd_from_d, &rep, sizeof(rep)) != (ssize_t)sizeof(rep)) {
+                exit_msg = "[B] Dynamics process ended (lockstep).";
+                exit_row = 1;
+                fprintf(logfile, "[B] Lockstep exchange with D failed at step %llu.\n",
+                        (unsigned long long)req.step);
+                fflush(logfile);
+                break;
+            }
+            if (rep.step != req.step) {
+                exit_msg = "[B] Lockstep step mismatch.";
+                exit_row = 1;
+                fprintf(logfile, "[B] Lockstep: asked step %llu, D answered %llu.\n",
+                        (unsigned long long)req.step, (unsigned long long)rep.step);
+                fflush(logfile);
+                break;
+            }
+            s = rep.state;
+            got_state = true;
+        }
 
-                // POLISH: if we were blinking due to warning, clear it once activity resumes
-                if (wd_warning_active) {
-                    wd_warning_active = 0;
-                    wd_blink_phase = 0;
-                    wd_blink_counter = 0;
+        if (ready[SRC_D_MAILBOX]) {
+            uint64_t rings = mailbox_take_state(ipc, &s);
+            got_state = (rings > 0);
+        }
 
-                    fprintf(logfile, "[B] Heartbeat resumed -> cleared watchdog warning UI\n");
-                    fflush(logfile);
-                }
+        if (ready[SRC_D]) {
+            int n = read(fd_from_d, &s, sizeof(s));
+            if (n == (int)sizeof(s)) {
+                got_state = true;
             }
             else if (n <= 0) {
-                mvprintw(1, 1, "[B] Dynamics process ended (EOF).");
-                refresh();
+                exit_msg = "[B] Dynamics process ended (EOF).";
+                exit_row = 1;
+                fprintf(logfile, "[B] Dynamics process ended (EOF).\n");
+                fflush(logfile);
                 break;
             } else {
                 // partial read (should not happen with pipes + small struct, but handle anyway)
@@ -463,373 +689,203 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
                 fflush(logfile);
                 continue;
             }
+        }
 
+        if (got_state) {
+            // Recorded states carry the stamps of the recorded run
+            if (!replay_states) lat_state_received(&lat, &s, lat_now_ns());
 
+            double hb_gap = monotonic_now_sec() - last_hb_sec();
 
-            // Updates current state
-            cur_state = s;
+            // We received a valid "tick" from dynamics => system is alive
+            set_last_hb_now();
+            stats.ticks++;
+            sim_step++;
+            if (rec && rec_states) recorder_state(rec, sim_step, &s);
 
-            // Increments global step counter (one more state update)
-            if (!paused) {
-                g_step_counter++;
-            }   
+            // Heartbeat for the watchdog: one store in the shared counters, W polls them
+            hb_beat(hb, HB_B);
 
-            // Logs state
-            fprintf(logfile,
-                    "STATE: x=%.2f y=%.2f vx=%.2f vy=%.2f\n",
-                    s.x, s.y, s.vx, s.vy);
-            fflush(logfile);
-            // Checks for target hits (only when not paused)
-            if (!paused) {
-                int hits = check_target_hits(&cur_state,
-                                            g_targets,
-                                            NUM_TARGETS,
-                                            &params,
-                                            &g_score,
-                                            &g_targets_collected,
-                                            &g_last_hit_step,
-                                            g_step_counter);
-                if (hits > 0) {
-                    fprintf(logfile,
-                            "[B] Collected %d target(s). SCORE=%d\n",
-                            hits, g_score);
+            // POLISH: if we were blinking due to warning, clear it once activity resumes
+            if (bb.wd_warning_active) {
+                blog_watchdog(BLOG_WD_RESUMED, hb_gap);
+                bb.wd_warning_active = 0;
+                bb.wd_blink_phase = 0;
+                set_blink_timer(blink_fd, false);
+
+                if (BLOG_ON(LOG_CAT_WATCHDOG, LOG_INFO)) {
+                    fprintf(logfile, "[B] Heartbeat resumed -> cleared watchdog warning UI\n");
                     fflush(logfile);
                 }
             }
-            // Decrements obstacles and targets lifetimes 
-            // Considers each time input is received from D, 1 sim time had elapsed
-            // Only age obstacles & targets when simulation is running
-            if (!paused){    
-                for (int i = 0; i < NUM_OBSTACLES; ++i) {
-                    if (g_obstacles[i].active && g_obstacles[i].life_steps > 0) {
-                        g_obstacles[i].life_steps--;   // Decreases 1 step from its lifetime
-                        if (g_obstacles[i].life_steps == 0) {
-                            g_obstacles[i].active = 0;
-                        }
-                    }
-                }
-                for (int i = 0; i < NUM_TARGETS; ++i) {
-                    if (g_targets[i].active && g_targets[i].life_steps > 0) {
-                        g_targets[i].life_steps--;
-                        if (g_targets[i].life_steps == 0) {
-                            g_targets[i].active = 0;
-                        }
-                    }
-                }
-            }
-            // Update blinking phase only while running (not paused)
-            if (wd_warning_active && !paused) {
-                wd_blink_counter++;
 
-                // Blink period in seconds:
-                const double BLINK_PERIOD_SEC = 0.5; // 0.5s ON/OFF toggle
+            // Hit check, aging and force re-send
+            bb_handle_state(&bb, &s, &params, &link);
 
-                int blink_steps = (int)(BLINK_PERIOD_SEC / params.dt);
-                if (blink_steps < 1) blink_steps = 1;
-
-                if (wd_blink_counter >= blink_steps) {
-                    wd_blink_counter = 0;
-                    wd_blink_phase = !wd_blink_phase; // toggle
-                }
+            // Swarm: D published the positions before this state
+            if (swarm_n > 0) {
+                swarm_buf_read(swarm, swarm_x, swarm_y, NULL);
+                bb_handle_swarm(&bb, swarm_x, swarm_y, swarm_n, &params);
             }
 
-
-            // Then, sends updated total force (evenif user doesn't send cmd) (user + obstacles)
-            send_total_force_to_d(&cur_force,
-                                  &cur_state,
-                                  &params,
-                                  g_obstacles,
-                                  NUM_OBSTACLES,
-                                  fd_to_d,
-                                  logfile,
-                                  "state");
-                                  
+            // Replay: the inputs applied after this state in the recorded run
+            if (replay && replay_apply_due(replay, sim_step, &bb, &params, &link, rec, logfile)) {
+                break;
+            }
+            if (replay && opts->replay_realtime) {
+                sleep_until(stats.t_start + (double)sim_step * params.dt);
+            }
         }
 
         // ------------------------------------------------------------------
         // Handles obstacle set messages from O
         // ------------------------------------------------------------------
-        if (FD_ISSET(fd_obs, &rfds)) {
-            ObstacleSetMsg msg;
-            int n = read(fd_obs, &msg, sizeof(msg));
+        if (ready[SRC_OBS]) {
+            int n = batch_read(fd_obs, sizeof(ObstacleSpec), &obs_buf);
             if (n <= 0) {
-                // if nth read, O process ended; may log and continue
-                mvprintw(0, 1, "[B] Obstacle generator ended.");
-                // Optionally: fd_obs = -1 and stop using it
-            } else {
-                if (paused){
-                    // Reads but ignores new obstacles while paused
-                    fprintf(logfile,
-                            "[B] Received obstacle set but PAUSED -> ignored.\n");
-                    fflush(logfile);
-                } else {
-                    int requested = msg.count;
-                    if (requested > NUM_OBSTACLES) requested = NUM_OBSTACLES;
-
-                    // Uses a clearance similar to what we used for targets
-                    double tgt_clearance = params.world_half * 0.15;
-
-                    int accepted = 0;
-
-                    for (int i = 0; i < requested; ++i) {
-                        double x = msg.obs[i].x;
-                        double y = msg.obs[i].y;
-
-                        // Rejects if too close to any active target
-                        if (too_close_to_any_pointlike(x, y,
-                               (PointLike*)g_obstacles,
-                               NUM_OBSTACLES,
-                               tgt_clearance)){
-                            fprintf(logfile,
-                                    "[B] Obstacle (%.2f, %.2f) rejected: too close to target.\n",
-                                    x, y);
-                            continue;
-                        }
-
-                        // Stores it if accepted index is within capacity
-                        if (accepted < NUM_OBSTACLES) {
-                            g_obstacles[accepted].x          = x;
-                            g_obstacles[accepted].y          = y;
-                            g_obstacles[accepted].life_steps = msg.obs[i].life_steps;
-                            g_obstacles[accepted].active     = 1;
-                            accepted++;
-                        }
-                    }
-
-                    // Deactivates remaining slots
-                    for (int i = accepted; i < NUM_OBSTACLES; ++i) {
-                        g_obstacles[i].active     = 0;
-                        g_obstacles[i].life_steps = 0;
-                    }
-
-                    fprintf(logfile,
-                            "[B] Accepted %d obstacles (requested %d).\n",
-                            accepted, requested);
+                // EOF: O process ended; error: the stream is out of sync.
+                // Logs and stops watching it either way
+                if (n == -1) {
+                    fprintf(logfile, "[B] bad obstacle batch: %s\n", strerror(errno));
                     fflush(logfile);
                 }
-
+                render_status(0, "[B] Obstacle generator ended.");
+                epoll_ctl(ep_fd, EPOLL_CTL_DEL, fd_obs, NULL);
+            } else {
+                ObstacleSetMsg msg = { n, obs_buf.data };
+                if (rec) recorder_obstacles(rec, sim_step, &msg);
+                bb_accept_obstacles(&bb, &msg, &params, logfile);
             }
         }
 
         // ------------------------------------------------------------------
         // Handles target-set messages from T
         // ------------------------------------------------------------------
-
-        if (FD_ISSET(fd_tgt, &rfds)) {
-            TargetSetMsg msg;
-            int n = read(fd_tgt, &msg, sizeof(msg));
+        if (ready[SRC_TGT]) {
+            int n = batch_read(fd_tgt, sizeof(TargetSpec), &tgt_buf);
             if (n <= 0) {
-                mvprintw(1, 1, "[B] Target generator ended.");
-            } else {
-                if (paused) {
-                    fprintf(logfile,
-                            "[B] Received target set but PAUSED -> ignored.\n");
-            fflush(logfile);
-        } else {
-            int requested = msg.count;
-            if (requested > NUM_TARGETS) requested = NUM_TARGETS;
-
-            // Tuning for filtering:
-            double wall_margin     = params.world_half * 0.20; // keep away from walls
-            double obs_clearance   = params.world_half * 0.15; // away from obstacles
-
-            int accepted = 0;
-
-            for (int i = 0; i < requested; ++i) {
-                double x = msg.tgt[i].x;
-                double y = msg.tgt[i].y;
-
-                // Rejects if too close to walls
-                if (target_too_close_to_wall(x, y, &params, wall_margin)) {
-                    fprintf(logfile,
-                            "[B] Target (%.2f,%.2f) rejected: too close to walls.\n",
-                            x, y);
-                    continue;
-                }
-
-                // Rejects if too close to obstacles
-                if (too_close_to_any_pointlike(x, y,
-                               (PointLike*)g_targets,
-                               NUM_TARGETS,
-                               obs_clearance)){
-                    fprintf(logfile,
-                            "[B] Target (%.2f,%.2f) rejected: too close to obstacles.\n",
-                            x, y);
-                    continue;
-                }
-
-                // Accepts target if it passed the above checks
-                if (accepted < NUM_TARGETS) {
-                    g_targets[accepted].x          = x;
-                    g_targets[accepted].y          = y;
-                    g_targets[accepted].life_steps = msg.tgt[i].life_steps;
-                    g_targets[accepted].active     = 1;
-                    accepted++;
+                if (n == -1) {
+                    fprintf(logfile, "[B] bad target batch: %s\n", strerror(errno));
+                    fflush(logfile);
                 }
+                render_status(1, "[B] Target generator ended.");
+                epoll_ctl(ep_fd, EPOLL_CTL_DEL, fd_tgt, NULL);
+            } else {
+                TargetSetMsg msg = { n, tgt_buf.data };
+                if (rec) recorder_targets(rec, sim_step, &msg);
+                bb_accept_targets(&bb, &msg, &params, logfile);
             }
-
-            // Deactivates remaining slots
-            for (int i = accepted; i < NUM_TARGETS; ++i) {
-                g_targets[i].active     = 0;
-                g_targets[i].life_steps = 0;
-            }
-
-            fprintf(logfile,
-                    "[B] Accepted %d targets (requested %d).\n",
-                    accepted, requested);
-            fflush(logfile);
         }
-    }
 
-}
         // ------------------------------------------------------------------
-        // Draws UI (drone world + inspection panel)
+        // Publishes the world snapshot for the render thread (skipped when headless)
         // ------------------------------------------------------------------
-        erase();
-        box(stdscr, 0, 0);
-
-        // Top info lines
-        mvprintw(top_info_y1, 2,
-                 "Controls: w e r / s d f / x c v | d=brake, p=pause, O=reset, q=quit");
-        mvprintw(top_info_y2, 2,
-                 "Paused: %s", paused ? "YES" : "NO");
-        
-        // Watchdog blinking warning: visible only when active AND blink phase is ON
-        // --- Watchdog live timing info ---
-        double age = hb_age_sec();  // seconds since last valid DroneStateMsg
-        double warn_in = (double)params.wd_warn_sec - age;
-        double kill_in = (double)params.wd_kill_sec - age;
-
-        if (warn_in < 0) warn_in = 0;
-        if (kill_in < 0) kill_in = 0;
-
-        if (wd_warning_active && wd_blink_phase) {
-            // If colors exist, use a red-ish pair. Otherwise use reverse + bold.
-            if (has_colors()) {
-                // Create once somewhere during init if you want:
-                // init_pair(3, COLOR_RED, COLOR_BLACK);
-                attron(COLOR_PAIR(3) | A_BOLD | A_REVERSE);
-                mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
-                mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
-                attroff(COLOR_PAIR(3) | A_BOLD | A_REVERSE);
-            } else {
-                attron(A_BOLD | A_REVERSE);
-                mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
-                mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
-                attroff(A_BOLD | A_REVERSE);
+        if (!opts->headless) {
+            // The items are regathered only after a spawn, expiry or hit. The
+            // life_steps they carry may then lag behind; the UI does not draw them.
+            if (snap_obs_gen != g_obs_pool.gen) {
+                for (int k = 0; k < g_obs_pool.count; ++k) snap_obs[k] = g_obstacles[g_obs_pool.live[k]];
+                snap_obs_gen = g_obs_pool.gen;
             }
-        }
-
-
-
-        
-
-        // Horizontal separator row (under top info)
-        if (sep_y >= 1 && sep_y <= max_y - 2) {
-            for (int x = 1; x < max_x - 1; ++x) {
-                mvaddch(sep_y, x, '-');
+            if (snap_tgt_gen != g_tgt_pool.gen) {
+                for (int k = 0; k < g_tgt_pool.count; ++k) snap_tgt[k] = g_targets[g_tgt_pool.live[k]];
+                snap_tgt_gen = g_tgt_pool.gen;
             }
+            snap.bb      = bb;
+            snap.obs     = snap_obs;
+            snap.n_obs   = g_obs_pool.count;
+            snap.obs_gen = snap_obs_gen;
+            snap.tgt     = snap_tgt;
+            snap.n_tgt   = g_tgt_pool.count;
+            snap.tgt_gen = snap_tgt_gen;
+            snap.hb_stamp = last_hb_sec();
+            render_publish(&snap);
         }
 
-        // Vertical separator between world and inspection
-        int sep_x = insp_start_x - 1;
-        if (sep_x > 1 && sep_x < max_x - 1) {
-            for (int y = world_top; y <= world_bottom; ++y) {
-                mvaddch(y, sep_x, '|');
-            }
-        }
-
-        // WORLD DRAWING (left)
-        double world_half = params.world_half;
-        double scale_x = main_width  / (2.0 * world_half);        // Maps world coordinates to the drone world on the display scree
-        double scale_y = world_height / (2.0 * world_half);
-        if (scale_x <= 0) scale_x = 1.0;
-        if (scale_y <= 0) scale_y = 1.0;
-
-        int sx = (int)(cur_state.x * scale_x) + main_width / 2 + 1;
-        int sy = (int)(-cur_state.y * scale_y) + world_top + world_height / 2;
-
-        if (sx < 1) sx = 1;
-        if (sx > main_width) sx = main_width;
-        if (sy < world_top) sy = world_top;
-        if (sy > world_bottom) sy = world_bottom;
-
-        mvaddch(sy, sx, '+'); // Draws drone
-
-        // Draws active obstacles as 'o' in the drone world
-        for (int k = 0; k < NUM_OBSTACLES; ++k) {
-            if (!g_obstacles[k].active) continue;  // Skips inactive 
-
-            int ox = (int)(g_obstacles[k].x * scale_x) + main_width / 2 + 1;
-            int oy = (int)(-g_obstacles[k].y * scale_y) + world_top + world_height / 2;
-
-            if (ox < 1) ox = 1;
-            if (ox > main_width) ox = main_width;
-            if (oy < world_top) oy = world_top;
-            if (oy > world_bottom) oy = world_bottom;
-            
-            attron(COLOR_PAIR(1));
-            mvaddch(oy, ox, 'o');  // TODO: Adds color to make them orange
-            
-            attroff(COLOR_PAIR(1));
-        }
-
-        for (int k = 0; k < NUM_TARGETS; ++k) {
-            if (!g_targets[k].active) continue;
-
-            int tx = (int)(g_targets[k].x * scale_x) + main_width / 2 + 1;
-            int ty = (int)(-g_targets[k].y * scale_y) + world_top + world_height / 2;
+        double loop_lat = monotonic_now_sec() - t_wake;
+        stats.iters++;
+        stats.loop_sum += loop_lat;
+        if (loop_lat > stats.loop_max) stats.loop_max = loop_lat;
 
-            if (tx < 1) tx = 1;
-            if (tx > main_width) tx = main_width;
-            if (ty < world_top) ty = world_top;
-            if (ty > world_bottom) ty = world_bottom;
-            
-            attron(COLOR_PAIR(2));
-            mvaddch(ty, tx, 'T');  // Placeholder, later make them numbered
-            attroff(COLOR_PAIR(2));
+        if (lockstep && sim_step >= (uint64_t)opts->lockstep_steps) {
+            exit_msg = "[B] Lockstep run complete.";
+            exit_row = 1;
+            break;
         }
+    }
 
+    // Stops drawing before anything else touches the terminal
+    render_stop();
+    if (exit_msg) ui_status(exit_row, exit_msg);
 
-        // INSPECTION panel on the right
-        int info_y = world_top;
-        int info_x = insp_start_x + 1;
-
-        
-        if (info_x < max_x - 1) {
-            mvprintw(info_y,     info_x, "INSPECTION");
-            mvprintw(info_y + 2, info_x, "Last key: %c", last_key);
-            mvprintw(info_y + 4, info_x, "Fx = %.2f", cur_force.Fx);
-            mvprintw(info_y + 5, info_x, "Fy = %.2f", cur_force.Fy);
-            mvprintw(info_y + 7, info_x, "x  = %.2f", cur_state.x);
-            mvprintw(info_y + 8, info_x, "y  = %.2f", cur_state.y);
-            mvprintw(info_y + 9, info_x, "vx = %.2f", cur_state.vx);
-            mvprintw(info_y +10, info_x, "vy = %.2f", cur_state.vy);
-            
-            mvprintw(info_y +12, info_x, "Score: %d", g_score);
-            mvprintw(info_y +13, info_x, "Targets collected: %d", g_targets_collected);
-            if (g_last_hit_step >= 0 ) {
-                time_since_last_hit = (g_step_counter - g_last_hit_step) * params .dt;
-
-                mvprintw(info_y +15, info_x, "Since last hit: %.2f sec", time_since_last_hit);
-            }
-            else {
-                mvprintw(info_y +14, info_x, "Last hit: none");
-            }
+    // Final stats line for the partial window
+    if (stats_out) {
+        stats_print(&stats, stats_out, &bb, swarm_n);
+    }
 
+    // Lockstep summary: throughput and speed-up over real time
+    if (lockstep) {
+        double wall = monotonic_now_sec() - stats.t_start;
+        if (wall <= 0.0) wall = 1e-9;
+        double simt = (double)sim_step * params.dt;
+        char   line[256];
+        snprintf(line, sizeof(line),
+                 "[B] lockstep: %llu steps (%.1f s simulated) in %.3f s = %.0f steps/s, %.0fx real time, score=%d\n",
+                 (unsigned long long)sim_step, simt, wall,
+                 (double)sim_step / wall, simt / wall, bb.score);
+        fputs(line, logfile);
+        if (stats_out) fputs(line, stats_out);
+    }
+    // Outcome of the run; closes the recording with it
+    report_final(&bb, sim_step, replay, logfile, stats_out);
+    lat_print(logfile, "[B]", &lat);
+    if (stats_out) lat_print(stats_out, "[B]", &lat);
+    if (rec) {
+        RecSummary end = { sim_step, bb.score, bb.targets_collected, bb.cur_state };
+        uint64_t   n   = rec->records;
+        if (recorder_close(rec, &end) == -1) {
+            fprintf(logfile, "[B] recording '%s' incomplete: write failed\n", opts->record_path);
+        } else {
+            fprintf(logfile, "[B] recording '%s': %llu input(s), %llu step(s)\n", opts->record_path,
+                    (unsigned long long)n, (unsigned long long)sim_step);
         }
-
-        refresh();
     }
+    if (replay) replay_free(replay);
+    if (stats_out && stats_out != stderr) fclose(stats_out);
+    if (have_script) script_free(&script);
+    free(swarm_x);
+    free(swarm_y);
+    if (logfile && bb.rep_field.builds > 0) {
+        fprintf(logfile, "[B] repulsion field: %dx%d, %lu build(s), last %.2f ms\n",
+                bb.rep_field.res, bb.rep_field.res, bb.rep_field.builds, bb.rep_field.build_ms);
+    }
+    bb_free(&bb);
+    free(obs_buf.data);
+    free(tgt_buf.data);
+    free(snap_obs);
+    free(snap_tgt);
+    obstacle_store_free();
+    target_store_free();
+
+    // Flushes the binary log
+    blog_close();
 
     // Final cleanup
     if (logfile) {
-        fprintf(logfile, "[B] Exiting.\n");
+        if (blog_dropped() > 0) {
+            fprintf(logfile, "[B] binary log: %llu record(s) dropped (ring full)\n",
+                    (unsigned long long)blog_dropped());
+        }
+        fprintf(logfile, "[B] Exiting. SCORE=%d targets=%d\n", bb.score, bb.targets_collected);
         fclose(logfile);
     }
     // Ends ncurses
-    endwin();
-    // Closes pipes
+    ui_shutdown();
+    // Closes event fds and pipes
+    close(ep_fd);
+    close(sig_fd);
+    close(blink_fd);
+    if (stats_fd != -1) close(stats_fd);
     close(fd_kb);
     close(fd_to_d);
     close(fd_from_d);
@@ -0,0 +1,254 @@
+// shm_ipc.c
+// Shared-memory mailbox between B and D (see headers/shm_ipc.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+
+#include "headers/shm_ipc.h"
+#include "headers/latency.h"   // lat_now_ns
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>        // O_* constants
+#include <unistd.h>
+#include <sys/mman.h>     // shm_open, mmap
+#include <sys/eventfd.h>
+
+_Static_assert(sizeof(DroneStateMsg) <= SEQLOCK_MAX_WORDS * 8, "DroneStateMsg too large for a SeqSlot");
+_Static_assert(sizeof(ForceStateMsg) <= SEQLOCK_MAX_WORDS * 8, "ForceStateMsg too large for a SeqSlot");
+
+// Creates the shared segment and the doorbell.
+// The name is unlinked right after mapping: only the forked children can reach it.
+// ----------------------------------------------------------------------
+int shm_ipc_create(ShmIpc *ipc) {
+    char name[64];
+    snprintf(name, sizeof(name), "/drone_ipc_%d", (int)getpid());
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) return -1;
+
+    if (ftruncate(fd, sizeof(ShmShared)) == -1) {
+        int saved = errno;
+        close(fd);
+        shm_unlink(name);
+        errno = saved;
+        return -1;
+    }
+
+    void *p = mmap(NULL, sizeof(ShmShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int saved = errno;
+    close(fd);
+    shm_unlink(name);
+    if (p == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+    memset(p, 0, sizeof(ShmShared));   // zero state, zero force, all seq counters even
+
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int kfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (efd == -1 || kfd == -1) {
+        saved = errno;
+        if (efd != -1) close(efd);
+        if (kfd != -1) close(kfd);
+        munmap(p, sizeof(ShmShared));
+        errno = saved;
+        return -1;
+    }
+
+    ipc->shared            = (ShmShared *)p;
+    ipc->state_doorbell_fd = efd;
+    ipc->key_doorbell_fd   = kfd;
+
+    // B starts out waiting for the first key
+    atomic_store(&ipc->shared->keys.consumer_idle, 1);
+    return 0;
+}
+
+void shm_ipc_destroy(ShmIpc *ipc) {
+    if (!ipc) return;
+    if (ipc->shared) munmap(ipc->shared, sizeof(ShmShared));
+    if (ipc->state_doorbell_fd >= 0) close(ipc->state_doorbell_fd);
+    if (ipc->key_doorbell_fd   >= 0) close(ipc->key_doorbell_fd);
+    ipc->shared            = NULL;
+    ipc->state_doorbell_fd = -1;
+    ipc->key_doorbell_fd   = -1;
+}
+
+// Seqlock writer: bump to odd, store payload, bump to even.
+// ----------------------------------------------------------------------
+void seqlock_write(SeqSlot *slot, const void *src, size_t len) {
+    uint64_t tmp[SEQLOCK_MAX_WORDS] = {0};
+    memcpy(tmp, src, len);
+    size_t nwords = (len + 7) / 8;
+
+    uint32_t s = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (size_t i = 0; i < nwords; ++i)
+        atomic_store_explicit(&slot->words[i], tmp[i], memory_order_relaxed);
+
+    atomic_store_explicit(&slot->seq, s + 2, memory_order_release);
+}
+
+// Seqlock reader: retries until it copied a payload no writer touched meanwhile.
+// ----------------------------------------------------------------------
+void seqlock_read(SeqSlot *slot, void *dst, size_t len) {
+    uint64_t tmp[SEQLOCK_MAX_WORDS];
+    size_t nwords = (len + 7) / 8;
+    uint32_t s1, s2;
+
+    do {
+        s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (s1 & 1u) continue;   // writer inside
+
+        for (size_t i = 0; i < nwords; ++i)
+            tmp[i] = atomic_load_explicit(&slot->words[i], memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    } while ((s1 & 1u) || s1 != s2);
+
+    memcpy(dst, tmp, len);
+}
+
+// D -> B
+// ----------------------------------------------------------------------
+void mailbox_publish_state(ShmIpc *ipc, const DroneStateMsg *s) {
+    seqlock_write(&ipc->shared->mbox.state, s, sizeof(*s));
+
+    // Non-blocking eventfd: the counter only saturates after 2^64-2 unread rings.
+    uint64_t one = 1;
+    if (write(ipc->state_doorbell_fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        perror("[D] doorbell write");
+    }
+}
+
+uint64_t mailbox_take_state(ShmIpc *ipc, DroneStateMsg *s) {
+    uint64_t rings = 0;
+    if (read(ipc->state_doorbell_fd, &rings, sizeof(rings)) != (ssize_t)sizeof(rings)) {
+        return 0;   // EAGAIN: nothing new
+    }
+    seqlock_read(&ipc->shared->mbox.state, s, sizeof(*s));
+    return rings;
+}
+
+// B -> D
+// ----------------------------------------------------------------------
+void mailbox_read_force(ShmMailbox *mb, ForceStateMsg *f, uint32_t *reset_seen) {
+    // Reads reset_gen first: B publishes the force before bumping it,
+    // so a new generation always comes with the matching force.
+    uint32_t gen = atomic_load_explicit(&mb->reset_gen, memory_order_acquire);
+    seqlock_read(&mb->force, f, sizeof(*f));
+
+    f->reset = (gen != *reset_seen) ? 1 : 0;
+    *reset_seen = gen;
+}
+
+// I -> B key ring
+// ----------------------------------------------------------------------
+static void ring_doorbell(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        perror("doorbell write");
+    }
+}
+
+// Producer side. The seq_cst fence pairs with the one in keyring_drain():
+// either I sees B idle (and rings), or B sees the new tail before going idle.
+int keyring_push(ShmIpc *ipc, const KeyMsg *km) {
+    KeyRing *r = &ipc->shared->keys;
+
+    uint64_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint64_t h = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (t - h >= KEY_RING_CAP) {
+        atomic_fetch_add_explicit(&r->overruns, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    r->entries[t & (KEY_RING_CAP - 1)].msg = *km;
+
+    atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&r->consumer_idle, memory_order_relaxed) &&
+        atomic_exchange_explicit(&r->consumer_idle, 0, memory_order_relaxed)) {
+        ring_doorbell(ipc->key_doorbell_fd);
+    }
+    return 0;
+}
+
+// Consumer side: drains everything pending, then announces it is idle.
+int keyring_drain(ShmIpc *ipc, KeyRingEntry *out, int max, uint64_t *overruns) {
+    KeyRing *r = &ipc->shared->keys;
+
+    // Clears the doorbell counter first so epoll stops reporting it.
+    uint64_t rings;
+    if (read(ipc->key_doorbell_fd, &rings, sizeof(rings)) == -1 && errno != EAGAIN) {
+        perror("[B] key doorbell read");
+    }
+
+    uint64_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    int n = 0;
+
+    while (1) {
+        uint64_t t = atomic_load_explicit(&r->tail, memory_order_acquire);
+        while (h != t && n < max) {
+            out[n++] = r->entries[h & (KEY_RING_CAP - 1)];
+            h++;
+        }
+        atomic_store_explicit(&r->head, h, memory_order_release);
+
+        if (h != t) {
+            // Caller's buffer is full: stay "busy" and wake ourselves for the rest.
+            ring_doorbell(ipc->key_doorbell_fd);
+            break;
+        }
+
+        atomic_store_explicit(&r->consumer_idle, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&r->tail, memory_order_relaxed) == h) break;
+
+        // A key slipped in before we went idle: keep draining.
+        atomic_store_explicit(&r->consumer_idle, 0, memory_order_relaxed);
+    }
+
+    if (overruns) *overruns = atomic_load_explicit(&r->overruns, memory_order_relaxed);
+    return n;
+}
+
+// B -> D force link
+// ----------------------------------------------------------------------
+// Sequence number of the last force stamped (B is the only sender)
+static uint32_t g_force_seq;
+
+uint32_t force_link_last_seq(void) {
+    return g_force_seq;
+}
+
+int force_link_send(const ForceLink *link, const ForceStateMsg *f) {
+    ForceStateMsg out = *f;
+    out.stamp.seq  = ++g_force_seq;
+    out.stamp.ref  = 0;
+    out.stamp.t_ns = lat_now_ns();
+
+    if (link->latch) {
+        out.reset |= link->latch->reset;
+        *link->latch = out;
+        return 0;
+    }
+
+    if (link->mbox) {
+        out.reset = 0;
+        seqlock_write(&link->mbox->force, &out, sizeof(out));
+        if (f->reset) {
+            atomic_fetch_add_explicit(&link->mbox->reset_gen, 1, memory_order_release);
+        }
+        return 0;
+    }
+
+    if (write(link->fd, &out, sizeof(out)) == -1) return -1;
+    return 0;
+}
@@ -0,0 +1,330 @@
+// swarm.c
+// Structure-of-arrays swarm engine and shared position buffer (see headers/swarm.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+
+#include "headers/swarm.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>     // mmap (anonymous shared mapping)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SWARM_X86 1
+#endif
+
+// Constants of one step, shared by every kernel.
+typedef struct {
+    double wh;          // world_half
+    double clear;       // wall_clearance
+    double inv_clear;   // 1 / wall_clearance
+    double gain;        // wall_gain (0 = no walls)
+    double eps;         // smallest wall distance (as in compute_repulsive_P)
+    double visc;
+    double inv_mass;    // 1 / mass
+    double h;           // internal step
+    int    substeps;
+} StepConst;
+
+int swarm_alloc(SwarmSoA *sw, int n) {
+    memset(sw, 0, sizeof(*sw));
+    if (n <= 0) return -1;
+
+    int    cap   = (n + 3) & ~3;
+    size_t bytes = (size_t)cap * sizeof(double);
+    double **arrays[6] = { &sw->x, &sw->y, &sw->vx, &sw->vy, &sw->Fx, &sw->Fy };
+
+    for (int i = 0; i < 6; ++i) {
+        *arrays[i] = aligned_alloc(32, bytes);
+        if (!*arrays[i]) {
+            swarm_free(sw);
+            return -1;
+        }
+        memset(*arrays[i], 0, bytes);
+    }
+    sw->n   = n;
+    sw->cap = cap;
+    return 0;
+}
+
+void swarm_free(SwarmSoA *sw) {
+    free(sw->x);  free(sw->y);
+    free(sw->vx); free(sw->vy);
+    free(sw->Fx); free(sw->Fy);
+    memset(sw, 0, sizeof(*sw));
+}
+
+// Grid of ceil(sqrt(n)) columns over the area the walls do not push.
+// ----------------------------------------------------------------------
+void swarm_layout(SwarmSoA *sw, const SimParams *params) {
+    int    cols = (int)ceil(sqrt((double)sw->n));
+    int    rows = (sw->n + cols - 1) / cols;
+    double span = params->world_half - params->wall_clearance;
+    if (span <= 0.0) span = 0.5 * params->world_half;
+
+    for (int i = 0; i < sw->cap; ++i) {
+        int c = i % cols;
+        int r = i / cols;
+        sw->x[i]  = cols > 1 ? -span + 2.0 * span * (double)c / (double)(cols - 1) : 0.0;
+        sw->y[i]  = rows > 1 ?  span - 2.0 * span * (double)r / (double)(rows - 1) : 0.0;
+        sw->vx[i] = 0.0;
+        sw->vy[i] = 0.0;
+        sw->Fx[i] = 0.0;
+        sw->Fy[i] = 0.0;
+    }
+}
+
+void swarm_set_force(SwarmSoA *sw, double Fx, double Fy) {
+    for (int i = 0; i < sw->cap; ++i) {
+        sw->Fx[i] = Fx;
+        sw->Fy[i] = Fy;
+    }
+}
+
+// ---------------- Scalar kernel ----------------
+// Wall term of compute_repulsive_P(): gain * (1/d - 1/clearance) for a wall
+// closer than the clearance, d clamped to eps, pushing inward. With
+// wall_clearance < world_half only the nearer of two opposite walls can be
+// that close, so each axis needs one distance d = world_half - |x| and one
+// division, and the push gets the sign of -x.
+// The vector kernels below do the same operations in the same order with
+// masks instead of tests, so every kernel gives bit-identical states.
+
+static inline double wall_push(double x, const StepConst *c) {
+    double d = c->wh - fabs(x);
+    if (!(d < c->clear)) return 0.0;
+    if (d < c->eps) d = c->eps;
+    double mag = c->gain * (1.0 / d - c->inv_clear);
+    if (mag < 0.0) mag = 0.0;
+    return copysign(mag, -x);
+}
+
+static void step_scalar(SwarmSoA *sw, int i0, int i1, const StepConst *c) {
+    for (int i = i0; i < i1; ++i) {
+        double x = sw->x[i], y = sw->y[i], vx = sw->vx[i], vy = sw->vy[i];
+        double Fx = sw->Fx[i], Fy = sw->Fy[i];
+
+        for (int k = 0; k < c->substeps; ++k) {
+            double ax = (Fx + wall_push(x, c) - c->visc * vx) * c->inv_mass;
+            double ay = (Fy + wall_push(y, c) - c->visc * vy) * c->inv_mass;
+            vx = vx + ax * c->h;
+            vy = vy + ay * c->h;
+            x  = x + vx * c->h;
+            y  = y + vy * c->h;
+        }
+        sw->x[i] = x;  sw->y[i] = y;
+        sw->vx[i] = vx; sw->vy[i] = vy;
+    }
+}
+
+#ifdef SWARM_X86
+
+// ---------------- SSE2 kernel (2 drones per register) ----------------
+
+typedef struct {
+    __m128d wh, clear, eps, gain, inv_clear, sign;
+} WallSse2;
+
+__attribute__((target("sse2")))
+static inline __m128d wall_push_sse2(__m128d x, const WallSse2 *w) {
+    __m128d xs     = _mm_and_pd(x, w->sign);          // sign bit of x
+    __m128d d      = _mm_sub_pd(w->wh, _mm_xor_pd(x, xs));   // wh - |x|
+    __m128d inside = _mm_cmplt_pd(d, w->clear);
+    d = _mm_max_pd(d, w->eps);
+    __m128d mag = _mm_mul_pd(w->gain, _mm_sub_pd(_mm_div_pd(_mm_set1_pd(1.0), d), w->inv_clear));
+    mag = _mm_and_pd(_mm_max_pd(mag, _mm_setzero_pd()), inside);
+    return _mm_xor_pd(mag, _mm_xor_pd(xs, w->sign));  // copysign(mag, -x)
+}
+
+__attribute__((target("sse2")))
+static void step_sse2(SwarmSoA *sw, int i0, int i1, const StepConst *c) {
+    WallSse2 w;
+    w.wh        = _mm_set1_pd(c->wh);
+    w.clear     = _mm_set1_pd(c->clear);
+    w.eps       = _mm_set1_pd(c->eps);
+    w.gain      = _mm_set1_pd(c->gain);
+    w.inv_clear = _mm_set1_pd(c->inv_clear);
+    w.sign      = _mm_set1_pd(-0.0);
+    const __m128d visc = _mm_set1_pd(c->visc), inv_mass = _mm_set1_pd(c->inv_mass);
+    const __m128d h = _mm_set1_pd(c->h);
+
+    for (int i = i0; i < i1; i += 2) {
+        __m128d x = _mm_load_pd(sw->x + i),   y = _mm_load_pd(sw->y + i);
+        __m128d vx = _mm_load_pd(sw->vx + i), vy = _mm_load_pd(sw->vy + i);
+        __m128d Fx = _mm_load_pd(sw->Fx + i), Fy = _mm_load_pd(sw->Fy + i);
+
+        for (int k = 0; k < c->substeps; ++k) {
+            __m128d ax = _mm_mul_pd(_mm_sub_pd(_mm_add_pd(Fx, wall_push_sse2(x, &w)),
+                                               _mm_mul_pd(visc, vx)), inv_mass);
+            __m128d ay = _mm_mul_pd(_mm_sub_pd(_mm_add_pd(Fy, wall_push_sse2(y, &w)),
+                                               _mm_mul_pd(visc, vy)), inv_mass);
+            vx = _mm_add_pd(vx, _mm_mul_pd(ax, h));
+            vy = _mm_add_pd(vy, _mm_mul_pd(ay, h));
+            x  = _mm_add_pd(x, _mm_mul_pd(vx, h));
+            y  = _mm_add_pd(y, _mm_mul_pd(vy, h));
+        }
+        _mm_store_pd(sw->x + i, x);   _mm_store_pd(sw->y + i, y);
+        _mm_store_pd(sw->vx + i, vx); _mm_store_pd(sw->vy + i, vy);
+    }
+}
+
+// ---------------- AVX2 kernel (4 drones per register) ----------------
+// No FMA: a fused multiply-add would round differently from the scalar kernel.
+
+typedef struct {
+    __m256d wh, clear, eps, gain, inv_clear, sign;
+} WallAvx2;
+
+__attribute__((target("avx2")))
+static inline __m256d wall_push_avx2(__m256d x, const WallAvx2 *w) {
+    __m256d xs     = _mm256_and_pd(x, w->sign);
+    __m256d d      = _mm256_sub_pd(w->wh, _mm256_xor_pd(x, xs));
+    __m256d inside = _mm256_cmp_pd(d, w->clear, _CMP_LT_OQ);
+    d = _mm256_max_pd(d, w->eps);
+    __m256d mag = _mm256_mul_pd(w->gain, _mm256_sub_pd(_mm256_div_pd(_mm256_set1_pd(1.0), d), w->inv_clear));
+    mag = _mm256_and_pd(_mm256_max_pd(mag, _mm256_setzero_pd()), inside);
+    return _mm256_xor_pd(mag, _mm256_xor_pd(xs, w->sign));
+}
+
+__attribute__((target("avx2")))
+static void step_avx2(SwarmSoA *sw, int i0, int i1, const StepConst *c) {
+    WallAvx2 w;
+    w.wh        = _mm256_set1_pd(c->wh);
+    w.clear     = _mm256_set1_pd(c->clear);
+    w.eps       = _mm256_set1_pd(c->eps);
+    w.gain      = _mm256_set1_pd(c->gain);
+    w.inv_clear = _mm256_set1_pd(c->inv_clear);
+    w.sign      = _mm256_set1_pd(-0.0);
+    const __m256d visc = _mm256_set1_pd(c->visc), inv_mass = _mm256_set1_pd(c->inv_mass);
+    const __m256d h = _mm256_set1_pd(c->h);
+
+    for (int i = i0; i < i1; i += 4) {
+        __m256d x = _mm256_load_pd(sw->x + i),   y = _mm256_load_pd(sw->y + i);
+        __m256d vx = _mm256_load_pd(sw->vx + i), vy = _mm256_load_pd(sw->vy + i);
+        __m256d Fx = _mm256_load_pd(sw->Fx + i), Fy = _mm256_load_pd(sw->Fy + i);
+
+        for (int k = 0; k < c->substeps; ++k) {
+            __m256d ax = _mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(Fx, wall_push_avx2(x, &w)),
+                                                     _mm256_mul_pd(visc, vx)), inv_mass);
+            __m256d ay = _mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(Fy, wall_push_avx2(y, &w)),
+                                                     _mm256_mul_pd(visc, vy)), inv_mass);
+            vx = _mm256_add_pd(vx, _mm256_mul_pd(ax, h));
+            vy = _mm256_add_pd(vy, _mm256_mul_pd(ay, h));
+            x  = _mm256_add_pd(x, _mm256_mul_pd(vx, h));
+            y  = _mm256_add_pd(y, _mm256_mul_pd(vy, h));
+        }
+        _mm256_store_pd(sw->x + i, x);   _mm256_store_pd(sw->y + i, y);
+        _mm256_store_pd(sw->vx + i, vx); _mm256_store_pd(sw->vy + i, vy);
+    }
+}
+
+#endif // SWARM_X86
+
+int swarm_select_kernel(int want) {
+#ifdef SWARM_X86
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2");
+    int sse2 = __builtin_cpu_supports("sse2");
+
+    if ((want == SIMD_AUTO || want == SIMD_AVX2) && avx2) return SIMD_AVX2;
+    if (want != SIMD_SCALAR && sse2) return SIMD_SSE2;
+#else
+    (void)want;
+#endif
+    return SIMD_SCALAR;
+}
+
+void swarm_step(SwarmSoA *sw, const SimParams *params, int kernel) {
+    StepConst c;
+    c.wh        = params->world_half;
+    c.clear     = params->wall_clearance;
+    c.inv_clear = params->wall_clearance > 0.0 ? 1.0 / params->wall_clearance : 0.0;
+    c.gain      = params->wall_gain;
+    c.eps       = 1e-3;
+    c.visc      = params->visc;
+    c.inv_mass  = 1.0 / params->mass;
+    c.substeps  = params->substeps > 1 ? params->substeps : 1;
+    c.h         = params->dt / (double)c.substeps;
+
+    // Walls off: a zero gain zeroes every wall term
+    if (!(c.clear > 0.0 && c.gain > 0.0)) c.gain = 0.0;
+
+    switch (kernel) {
+#ifdef SWARM_X86
+        case SIMD_AVX2: step_avx2(sw, 0, sw->cap, &c); break;
+        case SIMD_SSE2: step_sse2(sw, 0, sw->cap, &c); break;
+#endif
+        default:        step_scalar(sw, 0, sw->cap, &c); break;
+    }
+}
+
+// ---------------- Shared position buffer ----------------
+
+int swarm_buf_create(SwarmBuf *buf, int n) {
+    size_t bytes = sizeof(SwarmShared) + 2u * (size_t)n * sizeof(uint64_t);
+
+    // Anonymous shared mapping: inherited by fork(), nothing to unlink
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return -1;
+
+    buf->shared        = (SwarmShared *)p;
+    buf->bytes         = bytes;
+    buf->shared->count = (uint32_t)n;
+    return 0;
+}
+
+void swarm_buf_destroy(SwarmBuf *buf) {
+    if (buf->shared) munmap(buf->shared, buf->bytes);
+    buf->shared = NULL;
+    buf->bytes  = 0;
+}
+
+void swarm_buf_publish(SwarmBuf *buf, const SwarmSoA *sw, uint64_t step) {
+    SwarmShared *sh = buf->shared;
+    uint32_t     n  = sh->count < (uint32_t)sw->n ? sh->count : (uint32_t)sw->n;
+
+    uint32_t s = atomic_load_explicit(&sh->seq, memory_order_relaxed);
+    atomic_store_explicit(&sh->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t bx, by;
+        memcpy(&bx, &sw->x[i], sizeof(bx));
+        memcpy(&by, &sw->y[i], sizeof(by));
+        atomic_store_explicit(&sh->xy[i],         bx, memory_order_relaxed);
+        atomic_store_explicit(&sh->xy[sh->count + i], by, memory_order_relaxed);
+    }
+    atomic_store_explicit(&sh->step, step, memory_order_relaxed);
+
+    atomic_store_explicit(&sh->seq, s + 2, memory_order_release);
+}
+
+int swarm_buf_read(const SwarmBuf *buf, double *x, double *y, uint64_t *step) {
+    SwarmShared *sh = buf->shared;
+    uint32_t     n  = sh->count;
+    uint32_t     s1, s2;
+    uint64_t     st;
+
+    do {
+        s1 = atomic_load_explicit(&sh->seq, memory_order_acquire);
+        if (s1 & 1u) continue;   // D inside
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint64_t bx = atomic_load_explicit(&sh->xy[i],     memory_order_relaxed);
+            uint64_t by = atomic_load_explicit(&sh->xy[n + i], memory_order_relaxed);
+            memcpy(&x[i], &bx, sizeof(bx));
+            memcpy(&y[i], &by, sizeof(by));
+        }
+        st = atomic_load_explicit(&sh->step, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&sh->seq, memory_order_relaxed);
+    } while ((s1 & 1u) || s1 != s2);
+
+    if (step) *step = st;
+    return (int)n;
+}
@@ -0,0 +1,117 @@
+// swarm_bench.c
+// Throughput of the swarm kernels (make swarm-bench)
+//   - Integrates N drones for a fixed simulated time with each kernel the
+//     CPU supports (scalar, SSE2, AVX2) and reports drones x steps per second
+//   - Checks every kernel against the scalar one: the states must be
+//     bit-identical after the run
+// Usage: ./swarm_bench [--csv]
+// ======================================================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "headers/swarm.h"
+#include "headers/params.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_STEPS  400      // steps per timed run (20 s at dt = 0.05)
+#define BENCH_REPS   5        // timed runs, best one reported
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// Lays out the swarm and pushes it towards the top-right corner, so part of
+// the run is spent inside the wall clearance.
+static void reset(SwarmSoA *sw, const SimParams *p) {
+    swarm_layout(sw, p);
+    swarm_set_force(sw, 6.0, 4.0);
+}
+
+static void run(SwarmSoA *sw, const SimParams *p, int kernel) {
+    for (int k = 0; k < BENCH_STEPS; ++k) swarm_step(sw, p, kernel);
+}
+
+// Number of drones whose state differs (bitwise) between a and b.
+static int mismatches(const SwarmSoA *a, const SwarmSoA *b) {
+    int bad = 0;
+    for (int i = 0; i < a->n; ++i) {
+        if (memcmp(&a->x[i],  &b->x[i],  sizeof(double)) != 0 ||
+            memcmp(&a->y[i],  &b->y[i],  sizeof(double)) != 0 ||
+            memcmp(&a->vx[i], &b->vx[i], sizeof(double)) != 0 ||
+            memcmp(&a->vy[i], &b->vy[i], sizeof(double)) != 0) bad++;
+    }
+    return bad;
+}
+
+int main(int argc, char **argv) {
+    int csv = (argc > 1 && strcmp(argv[1], "--csv") == 0);
+
+    SimParams p;
+    init_default_params(&p);
+    p.wall_gain = 100.0;   // params.txt value
+
+    const int sizes[]   = { 64, 256, 1024, 4096, 16384, 65536 };
+    const int kernels[] = { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+    const int nsizes    = (int)(sizeof(sizes) / sizeof(sizes[0]));
+    const int nkernels  = (int)(sizeof(kernels) / sizeof(kernels[0]));
+
+    if (csv) {
+        printf("drones,kernel,ns_per_step,ns_per_drone_step,drone_steps_per_s,speedup,mismatches\n");
+    } else {
+        printf("%d steps per run, best of %d, dt=%g, substeps=%d\n\n",
+               BENCH_STEPS, BENCH_REPS, p.dt, p.substeps);
+        printf("%7s %-7s %12s %10s %14s %8s %6s\n",
+               "drones", "kernel", "us/step", "ns/drone", "drone-steps/s", "speedup", "diff");
+    }
+
+    for (int si = 0; si < nsizes; ++si) {
+        int n = sizes[si];
+
+        SwarmSoA ref, sw;
+        if (swarm_alloc(&ref, n) == -1 || swarm_alloc(&sw, n) == -1) {
+            fprintf(stderr, "out of memory for %d drones\n", n);
+            return 1;
+        }
+        reset(&ref, &p);
+        run(&ref, &p, SIMD_SCALAR);
+
+        double scalar_ns = 0.0;
+        for (int ki = 0; ki < nkernels; ++ki) {
+            int kernel = kernels[ki];
+            if (swarm_select_kernel(kernel) != kernel) continue;   // not on this CPU
+
+            reset(&sw, &p);
+            run(&sw, &p, kernel);
+            int bad = mismatches(&ref, &sw);
+
+            double best = 1e30;
+            for (int r = 0; r < BENCH_REPS; ++r) {
+                reset(&sw, &p);
+                double t0 = now_sec();
+                run(&sw, &p, kernel);
+                double t = now_sec() - t0;
+                if (t < best) best = t;
+            }
+            double ns_step = 1e9 * best / BENCH_STEPS;
+            if (kernel == SIMD_SCALAR) scalar_ns = ns_step;
+            double speedup = scalar_ns > 0.0 ? scalar_ns / ns_step : 1.0;
+            double rate    = 1e9 * (double)n / ns_step;
+
+            if (csv) {
+                printf("%d,%s,%.1f,%.3f,%.4g,%.2f,%d\n", n, simd_name(kernel),
+                       ns_step, ns_step / n, rate, speedup, bad);
+            } else {
+                printf("%7d %-7s %12.2f %10.3f %14.4g %7.2fx %6d\n", n, simd_name(kernel),
+                       ns_step * 1e-3, ns_step / n, rate, speedup, bad);
+            }
+        }
+        swarm_free(&ref);
+        swarm_free(&sw);
+    }
+    return 0;
+}
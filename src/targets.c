@@ -2,6 +2,8 @@
 #include "headers/params.h"
 #include "headers/targets.h"
 #include "headers/util.h"
+#include "headers/blog.h"   // BLOG_ON
+#include "headers/poisson.h"
 
 #include <unistd.h>
 #include <stdlib.h>
@@ -12,7 +14,49 @@
 
 #include <math.h>
 
-Target g_targets[NUM_TARGETS];
+Target    *g_targets = NULL;
+SlotPool   g_tgt_pool;
+PointGrid  g_tgt_index;
+
+// Allocates the target slots (all inactive), their pool and their index.
+// The index cell is the spawn clearance, the largest radius queried.
+// ----------------------------------------------------------------------
+int target_store_init(int capacity, double world_half) {
+    if (pool_init(&g_tgt_pool, capacity) == -1) return -1;
+    g_targets = calloc((size_t)g_tgt_pool.cap, sizeof(*g_targets));
+    if (!g_targets ||
+        pointgrid_init(&g_tgt_index, g_tgt_pool.cap, world_half,
+                       world_half * SPAWN_CLEARANCE_FACTOR) == -1) {
+        target_store_free();
+        return -1;
+    }
+    return 0;
+}
+
+void target_store_free(void) {
+    free(g_targets);
+    g_targets = NULL;
+    pool_free(&g_tgt_pool);
+    pointgrid_free(&g_tgt_index);
+}
+
+int target_add(double x, double y, int life_steps) {
+    int slot = pool_alloc(&g_tgt_pool);
+    if (slot < 0) return -1;
+    g_targets[slot].x          = x;
+    g_targets[slot].y          = y;
+    g_targets[slot].life_steps = life_steps;
+    g_targets[slot].active     = 1;
+    pointgrid_insert(&g_tgt_index, slot, x, y);
+    return slot;
+}
+
+void target_remove(int slot) {
+    g_targets[slot].active     = 0;
+    g_targets[slot].life_steps = 0;
+    pool_release(&g_tgt_pool, slot);
+    pointgrid_remove(&g_tgt_index, slot);
+}
 
 /**
  * @brief Run the Target Generator (T) process.
@@ -20,20 +64,27 @@ Target g_targets[NUM_TARGETS];
  * @details
  * Periodically spawns targets and sends them to the Server (B).
  * - **Generation Logic**:
- *   - Samples random positions using polar coordinates (r, theta) for uniform disk distribution.
+ *   - Samples positions in a central disk with a Poisson-disk sampler:
+ *     minimum spacing guaranteed, linear time.
  *   - Assigns a finite lifetime to each batch.
  *   - Server (B) performs the final validation (filtering unsafe targets) before accepting.
  * 
+ * - **Batch size**: `tgt_batch` in params.txt, sent as one variable-length
+ *   message (BatchHeader + specs).
+ * 
  * @param pipe_fd Write-end pipe to Server (B).
- * @param params  Simulation parameters (used for world boundaries).
+ * @param params  Simulation parameters (used for world boundaries and batch size).
+ * @param hb      Shared heartbeat counters: beats while waiting for the next batch.
  */
-void run_target_process(int write_fd, SimParams params) {
+void run_target_process(int write_fd, SimParams params, HeartbeatBoard *hb) {
     // opens log file
     FILE *log = open_process_log("targets", "T");
     if (!log) log = stderr;   // <-- don't die, just log to stderr
 
     fprintf(log, "[T] Targets started | PID = %d\n", getpid());
-    srand((unsigned)time(NULL) ^ (getpid() << 1));
+    // Own stream of the run seed: same seed, same targets
+    Rng rng;
+    rng_seed(&rng, params.seed, RNG_STREAM_TARGETS);
 
     double world_half = params.world_half;
 
@@ -48,92 +99,57 @@ void run_target_process(int write_fd, SimParams params) {
     // Defines minimum spacing between targets in the same batch.
     const double spacing_factor  = 0.12;   // 12% of world_half
     double min_spacing           = world_half * spacing_factor;
-    double min_spacing2          = min_spacing * min_spacing;
-
-    // Defines max attempts per target to find a non-overlapping position.
-    const int max_attempts       = 50;  // 50 attempts
 
     // Determines how often to *try* to spawn a new batch of targets (in seconds)
     const unsigned spawn_interval_sec = 50;   // 50 seconds
 
+    // Determines how many targets per batch (tgt_batch in params.txt)
+    int         batch_count = params.tgt_batch;
+    TargetSpec *specs       = malloc((size_t)(batch_count > 0 ? batch_count : 1) * sizeof(*specs));
+    if (!specs) die("[T] batch buffer");
+
+    // Poisson-disk sampler, buffers kept across batches
+    PoissonSampler sampler;
+    poisson_init(&sampler);
+
+    hb_watch(hb, HB_T, true);
     while (1) {
-        TargetSetMsg msg;
-
-        // Determines how many targets per batch. Can use MAX_TARGETS,
-        // or choose a smaller number if fewer are desired.
-        int batch_count = MAX_TARGETS;   // targets per a single batch
-        msg.count = batch_count;
-
-        for (int i = 0; i < batch_count; ++i) {
-            int attempts = 0;
-            int placed   = 0;
-
-            while (attempts < max_attempts) {
-                attempts++;
-
-                // Samples position in a central disk of radius max_r:
-                //
-                // - theta ∈ [0, 2π)
-                // - r ∈ [0, max_r], but to make uniform in area
-                //   samples sqrt(u) * max_r
-                double theta = rand_in_range(0.0, 2.0 * M_PI);
-                double u     = (double)rand() / (double)RAND_MAX; // [0,1]
-                double r     = sqrt(u) * max_r;   // area-uniform disk
-
-                double x = r * cos(theta);
-                double y = r * sin(theta);
-
-                // Checks spacing with already placed targets in this batch.
-                int ok = 1;
-                for (int j = 0; j < i; ++j) {
-                    double dx = x - msg.tgt[j].x;
-                    double dy = y - msg.tgt[j].y;
-                    double d2 = dx*dx + dy*dy;
-                    if (d2 < min_spacing2) {
-                        ok = 0;
-                        break;
-                    }
-                }
-
-                if (ok) {
-                    msg.tgt[i].x          = x;
-                    msg.tgt[i].y          = y;
-                    msg.tgt[i].life_steps = life_steps_default;
-                    placed = 1;
-                    break;
-                }
-            }
-
-            if (!placed) {
-                // Fallback: Picks some central point without spacing check
-                double theta = rand_in_range(0.0, 2.0 * M_PI);
-                double u     = (double)rand() / (double)RAND_MAX;
-                double r     = sqrt(u) * max_r;
-
-                double x = r * cos(theta);
-                double y = r * sin(theta);
-
-                msg.tgt[i].x          = x;
-                msg.tgt[i].y          = y;
-                msg.tgt[i].life_steps = life_steps_default;
-            }
+        // Samples positions in a central disk of radius max_r, at least
+        // min_spacing apart (area-uniform on average)
+        int placed = poisson_sample(&sampler, &rng, POISSON_DISK, max_r,
+                                    min_spacing, POISSON_K, batch_count);
+        if (placed < 0) die("[T] target sampling");
+
+        for (int i = 0; i < placed; ++i) {
+            specs[i].x          = sampler.x[i];
+            specs[i].y          = sampler.y[i];
+            specs[i].life_steps = life_steps_default;
+        }
+        if (placed < batch_count && BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(log, "[T] only %d of %d targets fit at spacing %.2f\n",
+                    placed, batch_count, min_spacing);
         }
 
         // Sends batch to B.
-        if (write(write_fd, &msg, sizeof(msg)) == -1) {
+        if (batch_write(write_fd, specs, (uint32_t)placed, sizeof(TargetSpec)) == -1) {
             perror("[T] write to B failed");
             break;
         }
 
         // Logs the sending event
-        fprintf(log, "[T] sending batch count=%d ...\n", msg.count);
-        fflush(log);
+        if (BLOG_ON(LOG_CAT_SPAWN, LOG_INFO)) {
+            fprintf(log, "[T] sending batch count=%d ...\n", placed);
+            fflush(log);
+        }
 
 
-        // Waits before generating the next batch.
-        sleep(spawn_interval_sec);
+        // Waits before generating the next batch (beating for W).
+        hb_sleep(hb, HB_T, spawn_interval_sec);
     }
     // Final cleanup
+    hb_watch(hb, HB_T, false);
+    poisson_free(&sampler);
+    free(specs);
     if (log) {
         fprintf(log, "[T] Exiting.\n");
         fclose(log);
@@ -0,0 +1,321 @@
+// ui.c
+// ncurses drawing for the server (B)
+//   - Left pane: drone world (drone, obstacles, targets)
+//   - Right pane: inspection panel (force, state, score)
+//   - Top rows: controls, pause state and the blinking watchdog banner
+// ======================================================================
+
+#include "headers/ui.h"
+
+#include <ncurses.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>   // TIOCGWINSZ
+
+static int g_ui_active = 0;
+
+// ---------------- Watchdog banner UI state ----------------
+// Shown (blinking) from the SIGUSR2 warning until heartbeats resume.
+static char watchdog_banner_msg[] = "WATCHDOG WARNING, system may be unstable";
+
+// ---------------- Damage tracking ----------------
+// The static layer (border, separators, help text, panel title) is drawn
+// once and rebuilt only after a resize or a status message. The world area
+// keeps a cell-level shadow of what is on screen, and the inspection panel
+// keeps the last text of each row, so a frame only touches changed cells.
+#define INSP_ROWS     16     // rows of the inspection panel (title + fields)
+#define INSP_TEXT_MAX 64
+
+typedef struct {
+    int max_y, max_x;
+    int top_info_y1, top_info_y2;
+    int sep_y;
+    int insp_start_x;
+    int world_top, world_bottom, world_height;
+    int main_width;
+} Layout;
+
+static Layout  g_lay;
+static bool    g_static_dirty = true;
+static chtype *g_shadow = NULL;      // world cells currently on screen
+static chtype *g_frame  = NULL;      // world cells wanted this frame
+static int     g_cells  = 0;
+static char    g_insp_cache[INSP_ROWS][INSP_TEXT_MAX];
+static char    g_top_cache[160];     // second top line (pause + banner)
+
+// Plans layout:
+//   - 2 top lines of info
+//   - horizontal separator
+//   - world area below
+//   - inspection panel on the right
+static void compute_layout(Layout *L) {
+    // Queries current terminal size (for resizing).
+    getmaxyx(stdscr, L->max_y, L->max_x);
+
+    int content_top    = 1;                 // first row inside border
+    int top_lines      = 2;                 // 2 text lines at top
+    L->top_info_y1     = content_top;
+    L->top_info_y2     = content_top + 1;
+    L->sep_y           = content_top + top_lines; // horizontal separator row
+    int content_bottom = L->max_y - 2;      // last row inside bottom border
+
+    if (L->sep_y >= content_bottom) {
+        L->sep_y = content_top; // in tiny terminals
+    }
+
+    // Defines right inspection panel width
+    int insp_width = 35;               // was 35
+    if (L->max_x < insp_width + 10) {
+        insp_width = L->max_x / 4;
+        if (insp_width < 10) insp_width = 10;
+    }
+    L->insp_start_x = L->max_x - insp_width;
+    if (L->insp_start_x < 1) L->insp_start_x = 1;
+
+    // Defines world area below separator.
+    L->world_top    = L->sep_y + 1;
+    if (L->world_top > content_bottom) L->world_top = content_top + 1;
+    L->world_bottom = content_bottom;
+    L->world_height = L->world_bottom - L->world_top + 1;
+    if (L->world_height < 1) L->world_height = 1;
+
+    // Defines left world width.
+    L->main_width = L->insp_start_x - 2;
+    if (L->main_width < 10) L->main_width = 10;
+}
+
+// Draws the static layer and resets all shadows to "blank".
+static void rebuild_static_layer(void) {
+    compute_layout(&g_lay);
+    const Layout *L = &g_lay;
+
+    int cells = L->main_width * L->world_height;
+    if (cells != g_cells) {
+        free(g_shadow);
+        free(g_frame);
+        g_shadow = malloc((size_t)cells * sizeof(chtype));
+        g_frame  = malloc((size_t)cells * sizeof(chtype));
+        if (!g_shadow || !g_frame) {
+            endwin();
+            fprintf(stderr, "[B] out of memory for the UI shadow buffer\n");
+            exit(EXIT_FAILURE);
+        }
+        g_cells = cells;
+    }
+    for (int i = 0; i < cells; ++i) g_shadow[i] = ' ';
+    memset(g_insp_cache, 0, sizeof(g_insp_cache));
+    g_top_cache[0] = '\0';
+
+    erase();
+    box(stdscr, 0, 0);
+
+    // Top info line (fixed help text)
+    mvprintw(L->top_info_y1, 2,
+             "Controls: w e r / s d f / x c v | d=brake, p=pause, O=reset, q=quit");
+
+    // Horizontal separator row (under top info)
+    if (L->sep_y >= 1 && L->sep_y <= L->max_y - 2) {
+        mvhline(L->sep_y, 1, '-', L->max_x - 2);
+    }
+
+    // Vertical separator between world and inspection
+    int sep_x = L->insp_start_x - 1;
+    if (sep_x > 1 && sep_x < L->max_x - 1) {
+        mvvline(L->world_top, sep_x, '|', L->world_height);
+    }
+
+    g_static_dirty = false;
+}
+
+void ui_init(void) {
+    initscr();      // Assignment-1 (previously was called inside loop which caused seldom window flickering issues)
+    cbreak();
+    noecho();
+    curs_set(0);  // hide cursor
+
+    // Assignment-1 (previously was defined inside loop casing uneccessary repeated calls)
+    // ---- ncurses color init (DO THIS ONCE) ----
+    if (has_colors()) {
+        start_color();
+
+        // Only attempt init_color if terminal supports changing colors.
+        if (can_change_color()) {
+            init_color(COLOR_YELLOW, 1000, 500, 0); // orange-ish
+            init_color(COLOR_GREEN,  0, 1000, 0);   // green
+        }
+
+        init_pair(1, COLOR_YELLOW, COLOR_BLACK); // obstacles
+        init_pair(2, COLOR_GREEN,  COLOR_BLACK); // targets
+        init_pair(3, COLOR_RED,    COLOR_BLACK); // watchdog warning
+        init_pair(4, COLOR_CYAN,   COLOR_BLACK); // swarm drones
+    } else {
+        // If cmd doesnot permit colors, then continue without colors.
+    }
+    g_ui_active = 1;
+}
+
+void ui_shutdown(void) {
+    if (!g_ui_active) return;
+    endwin();
+    g_ui_active = 0;
+}
+
+int ui_active(void) {
+    return g_ui_active;
+}
+
+void ui_status(int row, const char *msg) {
+    if (!g_ui_active) return;
+    mvprintw(row, 1, "%s", msg);
+    refresh();
+    g_static_dirty = true;   // the message is cleared with the next full layer
+}
+
+void ui_resize(void) {
+    if (!g_ui_active) return;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        resizeterm(ws.ws_row, ws.ws_col);
+    }
+    clearok(curscr, TRUE);   // repaint everything on the next refresh
+    g_static_dirty = true;
+}
+
+// Maps a world point into the world pane (clamped).
+static int world_cell(const Layout *L, double scale_x, double scale_y,
+                      double x, double y)
+{
+    int cx = (int)(x * scale_x) + L->main_width / 2 + 1;
+    int cy = (int)(-y * scale_y) + L->world_top + L->world_height / 2;
+
+    if (cx < 1) cx = 1;
+    if (cx > L->main_width) cx = L->main_width;
+    if (cy < L->world_top) cy = L->world_top;
+    if (cy > L->world_bottom) cy = L->world_bottom;
+
+    return (cy - L->world_top) * L->main_width + (cx - 1);
+}
+
+// Writes one inspection row only if its text changed (padded to clear leftovers).
+static void put_insp_row(int k, const char *text) {
+    const Layout *L = &g_lay;
+    if (strcmp(g_insp_cache[k], text) == 0) return;
+
+    int info_x = L->insp_start_x + 1;
+    int width  = L->max_x - 1 - info_x;
+    if (width <= 0) return;
+
+    mvprintw(L->world_top + k, info_x, "%-*.*s", width, width, text);
+    snprintf(g_insp_cache[k], INSP_TEXT_MAX, "%s", text);
+}
+
+// Draws UI (drone world + inspection panel), touching only changed cells
+// ----------------------------------------------------------------------
+void ui_draw(const WorldSnapshot *ws, const SimParams *params, double hb_age,
+             const double *swarm_x, const double *swarm_y, int swarm_n)
+{
+    if (!g_ui_active) return;
+
+    const Blackboard *bb = &ws->bb;
+
+    if (g_static_dirty) rebuild_static_layer();
+    const Layout *L = &g_lay;
+
+    // ---- Second top line: pause state + watchdog banner ----
+    // Watchdog blinking warning: visible only when active AND blink phase is ON
+    // --- Watchdog live timing info ---
+    double age = hb_age;  // seconds since last valid DroneStateMsg
+    double kill_in = (double)params->wd_kill_sec - age;
+    if (kill_in < 0) kill_in = 0;
+
+    bool banner = bb->wd_warning_active && bb->wd_blink_phase;
+    char top[sizeof(g_top_cache)];
+    snprintf(top, sizeof(top), "%d|%d|%.2f",
+             bb->paused ? 1 : 0, banner ? 1 : 0, banner ? kill_in : 0.0);
+
+    if (strcmp(top, g_top_cache) != 0) {
+        mvhline(L->top_info_y2, 1, ' ', L->max_x - 2);
+        mvprintw(L->top_info_y2, 2,
+                 "Paused: %s", bb->paused ? "YES" : "NO");
+
+        if (banner) {
+            // If colors exist, use a red-ish pair. Otherwise use reverse + bold.
+            attr_t a = has_colors() ? (COLOR_PAIR(3) | A_BOLD | A_REVERSE)
+                                    : (A_BOLD | A_REVERSE);
+            attron(a);
+            mvprintw(L->top_info_y2, 18, " %s ", watchdog_banner_msg);
+            mvprintw(L->top_info_y2, 60, "KILL IN: %.2fs", kill_in);
+            attroff(a);
+        }
+        memcpy(g_top_cache, top, sizeof(top));
+    }
+
+    // ---- WORLD (left): builds the wanted frame, then diffs against the shadow ----
+    double world_half = params->world_half;
+    double scale_x = L->main_width  / (2.0 * world_half);        // Maps world coordinates to the drone world on the display scree
+    double scale_y = L->world_height / (2.0 * world_half);
+    if (scale_x <= 0) scale_x = 1.0;
+    if (scale_y <= 0) scale_y = 1.0;
+
+    for (int i = 0; i < g_cells; ++i) g_frame[i] = ' ';
+
+    // Swarm drones as '.' (cyan), under everything else
+    for (int k = 0; k < swarm_n; ++k) {
+        g_frame[world_cell(L, scale_x, scale_y, swarm_x[k], swarm_y[k])] = '.' | COLOR_PAIR(4);
+    }
+
+    g_frame[world_cell(L, scale_x, scale_y, bb->cur_state.x, bb->cur_state.y)] = '+'; // drone
+
+    // Active obstacles as 'o' (orange), targets as 'T' (green)
+    for (int k = 0; k < ws->n_obs; ++k) {
+        g_frame[world_cell(L, scale_x, scale_y, ws->obs[k].x, ws->obs[k].y)] =
+            'o' | COLOR_PAIR(1);
+    }
+    for (int k = 0; k < ws->n_tgt; ++k) {
+        g_frame[world_cell(L, scale_x, scale_y, ws->tgt[k].x, ws->tgt[k].y)] =
+            'T' | COLOR_PAIR(2);
+    }
+
+    for (int i = 0; i < g_cells; ++i) {
+        if (g_frame[i] == g_shadow[i]) continue;
+        mvaddch(L->world_top + i / L->main_width, 1 + i % L->main_width, g_frame[i]);
+        g_shadow[i] = g_frame[i];
+    }
+
+    // ---- INSPECTION panel (right): rewrites only rows whose text changed ----
+    if (L->insp_start_x + 1 < L->max_x - 1) {
+        char row[INSP_ROWS][INSP_TEXT_MAX];
+        memset(row, 0, sizeof(row));
+
+        snprintf(row[0],  INSP_TEXT_MAX, "INSPECTION");
+        snprintf(row[2],  INSP_TEXT_MAX, "Last key: %c", bb->last_key);
+        snprintf(row[4],  INSP_TEXT_MAX, "Fx = %.2f", bb->cur_force.Fx);
+        snprintf(row[5],  INSP_TEXT_MAX, "Fy = %.2f", bb->cur_force.Fy);
+        snprintf(row[7],  INSP_TEXT_MAX, "x  = %.2f", bb->cur_state.x);
+        snprintf(row[8],  INSP_TEXT_MAX, "y  = %.2f", bb->cur_state.y);
+        snprintf(row[9],  INSP_TEXT_MAX, "vx = %.2f", bb->cur_state.vx);
+        snprintf(row[10], INSP_TEXT_MAX, "vy = %.2f", bb->cur_state.vy);
+
+        snprintf(row[12], INSP_TEXT_MAX, "Score: %d", bb->score);
+        snprintf(row[13], INSP_TEXT_MAX, "Targets collected: %d", bb->targets_collected);
+        if (bb->last_hit_step >= 0) {
+            double time_since_last_hit = (bb->step_counter - bb->last_hit_step) * params->dt;
+            snprintf(row[15], INSP_TEXT_MAX, "Since last hit: %.2f sec", time_since_last_hit);
+        } else {
+            snprintf(row[14], INSP_TEXT_MAX, "Last hit: none");
+        }
+        if (swarm_n > 0) {
+            snprintf(row[11], INSP_TEXT_MAX, "Swarm: %d drones, %d hits", swarm_n, bb->swarm_hits);
+        }
+
+        for (int k = 0; k < INSP_ROWS; ++k) {
+            if (L->world_top + k > L->world_bottom) break;
+            put_insp_row(k, row[k]);
+        }
+    }
+
+    refresh();
+}
@@ -7,6 +7,8 @@
 #include "headers/params.h"   // for SimParams
 #include "headers/obstacles.h"
 #include "headers/targets.h"
+#include "headers/shm_ipc.h"
+#include "headers/blog.h"
 
 #include <math.h>
 #include <stdbool.h>
@@ -20,6 +22,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>     // getpid
+#include <sys/uio.h>    // writev
 
 
 // Returns max of two ints.
@@ -107,34 +110,36 @@ void send_total_force_to_d(const ForceStateMsg *user_force,
                                   const SimParams     *params,
                                   const Obstacle      *obs,
                                   int                  num_obs,
-                                  int                  fd_to_d,
-                                  FILE                *logfile,
-                                  const char          *reason)
+                                  const ObsGrid       *grid,
+                                  RepField            *field,
+                                  const ForceLink     *link,
+                                  int                  reason)
 {
     // Computes repulsive force vector 
     double Px = 0.0, Py = 0.0;
-    compute_repulsive_P(cur_state,
-                        params,
-                        obs,
-                        num_obs,
-                        false,   // calculate repulsive force for obstacles here
-                        true,   // include_obstacles
-                        &Px, &Py);
+    if (field && grid &&
+        repfield_lookup(field, grid, params, cur_state->x, cur_state->y, &Px, &Py)) {
+        // Interpolated from the cached field
+    } else if (grid && grid->nx > 0) {
+        obsgrid_repulsion(grid, cur_state->x, cur_state->y, params, &Px, &Py);
+    } else {
+        compute_repulsive_P(cur_state,
+                            params,
+                            obs,
+                            num_obs,
+                            false,   // calculate repulsive force for obstacles here
+                            true,   // include_obstacles
+                            &Px, &Py);
+    }
 
     // Sends user_force alone if very small.
     double Pnorm2 = Px*Px + Py*Py;
     if (Pnorm2 < 1e-6) {
         ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
+        if (force_link_send(link, &out) == -1) {
             perror("[B] write to D failed (no rep)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P ~ 0 -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    out.Fx, out.Fy);
-            fflush(logfile);
+        } else {
+            blog_force(reason, user_force, Px, Py, '-', 0, &out);
         }
         return;
     }
@@ -144,17 +149,10 @@ void send_total_force_to_d(const ForceStateMsg *user_force,
     if (idx < 0) {
         // Falls back to user-only command if no good direction
         ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
+        if (force_link_send(link, &out) == -1) {
             perror("[B] write to D failed (no good dir)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P=(%.2f,%.2f), no good dir -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    Px, Py,
-                    out.Fx, out.Fy);
-            fflush(logfile);
+        } else {
+            blog_force(reason, user_force, Px, Py, '-', 0, &out);
         }
         return;
     }
@@ -165,17 +163,10 @@ void send_total_force_to_d(const ForceStateMsg *user_force,
     if (best_dot <= 0.0) {
         // Same: Falls back to user-only command if projection is not positive
         ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
+        if (force_link_send(link, &out) == -1) {
             perror("[B] write to D failed (best_dot<=0)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P=(%.2f,%.2f), best_dot<=0 -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    Px, Py,
-                    out.Fx, out.Fy);
-            fflush(logfile);
+        } else {
+            blog_force(reason, user_force, Px, Py, '-', 0, &out);
         }
         return;
     }
@@ -201,20 +192,10 @@ void send_total_force_to_d(const ForceStateMsg *user_force,
     out.Fy += Fvk_y;
 
     // Sends to D
-    if (write(fd_to_d, &out, sizeof(out)) == -1) {
+    if (force_link_send(link, &out) == -1) {
         perror("[B] write to D failed (virtual key rep)");
-    } else if (logfile) {
-        fprintf(logfile,
-                "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                "P=(%.2f,%.2f), best_key=%c, n_steps=%d "
-                "Fvk=(%.2f,%.2f) => Fx=%.2f Fy=%.2f\n",
-                reason ? reason : "?",
-                user_force->Fx, user_force->Fy,
-                Px, Py,
-                best_key, n_steps,
-                Fvk_x, Fvk_y,
-                out.Fx, out.Fy);
-        fflush(logfile);
+    } else {
+        blog_force(reason, user_force, Px, Py, best_key, n_steps, &out);
     }
 }
 
@@ -289,37 +270,43 @@ void compute_repulsive_P(const DroneStateMsg *s,
     // Uses fixed obstacle params derived from world size
     // ------------------ --------------------------------------------------------------
     if (include_obstacles && obs && num_obs > 0) {
-         const double obs_clearance = params->world_half * 0.30;
-        const double obs_gain      = 120.0;   // 120 behaved well
-        if (obs_clearance <= 0.0 || obs_gain <= 0.0) {
+        const double obs_clearance = params->world_half * OBS_CLEARANCE_FACTOR;
+        if (obs_clearance <= 0.0) {
             return;
         }
 
         for (int k = 0; k < num_obs; ++k) {
             if (!obs[k].active) continue;  // Skips inactive obstacles
 
-            double ox = obs[k].x;
-            double oy = obs[k].y;
+            add_obstacle_repulsion(s->x - obs[k].x, s->y - obs[k].y, obs_clearance, Px, Py);
+        }
+    }
+}
 
-            double dx  = s->x - ox;
-            double dy  = s->y - oy;
-            double rho = sqrt(dx*dx + dy*dy);
+// Adds the Khatib push of one obstacle, zero outside the clearance
+// ------------------ --------------------------------------------------------------
+void add_obstacle_repulsion(double dx, double dy, double obs_clearance,
+                            double *Px, double *Py)
+{
+    const double eps = 1e-3;
+    double d2  = dx*dx + dy*dy;
+    if (d2 >= obs_clearance * obs_clearance) return;   // out of reach: skips the sqrt
 
-            if (rho < eps) {
-                rho = eps;
-            }
+    double rho = sqrt(d2);
 
-            if (rho < obs_clearance) {
-                double mag = obs_gain * (1.0/rho - 1.0/obs_clearance);
-                if (mag < 0.0) mag = 0.0;
+    if (rho < eps) {
+        rho = eps;
+    }
 
-                double ux = dx / rho;
-                double uy = dy / rho;
+    if (rho < obs_clearance) {
+        double mag = OBS_GAIN * (1.0/rho - 1.0/obs_clearance);
+        if (mag < 0.0) mag = 0.0;
 
-                *Px += mag * ux;
-                *Py += mag * uy;
-            }
-        }
+        double ux = dx / rho;
+        double uy = dy / rho;
+
+        *Px += mag * ux;
+        *Py += mag * uy;
     }
 }
 
@@ -327,8 +314,6 @@ void compute_repulsive_P(const DroneStateMsg *s,
 // Returns: number of targets collected in this call (0 or more).
 // ------------------------------------------------------------------
 int check_target_hits(const DroneStateMsg *cur_state,
-                      Target              *targets,
-                      int                  num_targets,
                       const SimParams     *params,
                       int                 *score,
                       int                 *targets_collected,
@@ -336,26 +321,20 @@ int check_target_hits(const DroneStateMsg *cur_state,
                       int                  current_step)
 {
     // Hitting radius in world units
-    double R_hit  = params->world_half * 0.08;           // 8% of world half-range.
-    double R_hit2 = R_hit * R_hit;
-
-    double px = cur_state->x;
-    double py = cur_state->y;
+    double R_hit = params->world_half * HIT_RADIUS_FACTOR;   // 8% of world half-range.
 
     int hits = 0;
-
-    for (int i = 0; i < num_targets; ++i) {
-        if (!targets[i].active)
-            continue;
-
-        double dx = px - targets[i].x;
-        double dy = py - targets[i].y;
-        double d2 = dx*dx + dy*dy;
-
-        if (d2 <= R_hit2) {
-            // once target is hit, deactivate it
-            targets[i].active     = 0;
-            targets[i].life_steps = 0;
+    int found[16];
+    int n;
+
+    // Only the targets of the cells around the drone; queried again while
+    // the buffer comes back full (hit targets are gone from the index)
+    do {
+        n = pointgrid_within(&g_tgt_index, cur_state->x, cur_state->y, R_hit,
+                             found, (int)(sizeof(found) / sizeof(found[0])));
+        for (int k = 0; k < n; ++k) {
+            // once target is hit, deactivate it and free its slot
+            target_remove(found[k]);
 
             // Updates counters if pointers provided
             if (score)             (*score)++;
@@ -364,18 +343,85 @@ int check_target_hits(const DroneStateMsg *cur_state,
 
             hits++;
         }
-    }
+    } while (n == (int)(sizeof(found) / sizeof(found[0])));
 
     return hits;
 }
 
 
-// Helper to perform uniform random double : used in obs and target generation
-double rand_in_range(double min, double max) {
-    double u = (double)rand() / (double)RAND_MAX;  // b/n [0,1]
-    return min + u * (max - min);                  // linear interpolation
+// Writes a batch: header and specs in one writev(), then the rest if the
+// pipe took only part of it (batches above PIPE_BUF bytes).
+// ------------------ --------------------------------------------------------------
+int batch_write(int fd, const void *specs, uint32_t count, size_t spec_size) {
+    BatchHeader hdr = { count, (uint32_t)spec_size };
+    struct iovec iov[2] = {
+        { &hdr,          sizeof(hdr) },
+        { (void *)specs, (size_t)count * spec_size },
+    };
+    int iovcnt = 2;
+    struct iovec *v = iov;
+
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, v, iovcnt);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        // Skips what was written
+        while (iovcnt > 0 && (size_t)n >= v->iov_len) {
+            n -= (ssize_t)v->iov_len;
+            v++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            v->iov_base = (char *)v->iov_base + n;
+            v->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+// Reads exactly len bytes (the writer sends a batch in one go, so this only
+// waits for the rest of a batch already in flight). Returns 1, 0 on EOF, -1.
+static int read_exact(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n == 0) return 0;
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return 1;
 }
 
+// Reads one batch: header, then count * spec_size bytes into buf.
+// ------------------ --------------------------------------------------------------
+int batch_read(int fd, size_t spec_size, BatchBuf *buf) {
+    BatchHeader hdr;
+    int r = read_exact(fd, &hdr, sizeof(hdr));
+    if (r <= 0) return r;
+    if (hdr.spec_size != spec_size || hdr.count > BATCH_MAX_COUNT) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    size_t bytes = (size_t)hdr.count * spec_size;
+    if (bytes > buf->cap) {
+        void *p = realloc(buf->data, bytes);
+        if (!p) return -1;
+        buf->data = p;
+        buf->cap  = bytes;
+    }
+    if (bytes > 0) {
+        r = read_exact(fd, buf->data, bytes);
+        if (r <= 0) return r == 0 ? -1 : r;   // EOF inside a batch: truncated
+    }
+    return (int)hdr.count;
+}
 
 
 // ------------------ --------------------------------------------------------------
@@ -403,30 +449,6 @@ int target_too_close_to_wall(double x,
     return 0;
 }
 
-// Checks if position of target/obstacle is too close to any active obstacle/ target, respectively
-// (targets with too close obstacles are unattainable )
-// ------------------ --------------------------------------------------------------------------
-int too_close_to_any_pointlike(double px,
-                               double py,
-                               const PointLike *arr,
-                               int count,
-                               double min_dist)
-{
-    double min_d2 = min_dist * min_dist;
-
-    for (int i = 0; i < count; ++i) {
-        if (!arr[i].active)
-            continue;
-
-        double dx = px - arr[i].x;
-        double dy = py - arr[i].y;
-
-        if (dx*dx + dy*dy <= min_d2)
-            return 1;
-    }
-    return 0;
-}
-
 // ------------------ --------------------------------------------------------------
 // Logging utilities
 // ------------------ --------------------------------------------------------------
@@ -462,9 +484,8 @@ FILE *open_process_log(const char *name, const char *role_tag) {
         return NULL; // caller decides what to do
     }
 
-    // Line-buffered = each '\n' flushes automatically when output is a terminal,
-    // but for files we still want frequent flush behavior.
-    setvbuf(fp, NULL, _IOLBF, 0);
+    // Fully buffered: only cold-path messages are written here and they
+    // fflush() explicitly; per-tick telemetry goes to the binary log (blog.c).
 
     char ts[64];
     timestamp_now(ts, sizeof(ts));
@@ -0,0 +1,364 @@
+// util_bench.c
+// Microbenchmarks of B's per-tick kernels (make bench)
+//   - Synthetic worlds of N obstacles and N targets placed uniformly with a
+//     fixed seed; drone positions and repulsion vectors drawn the same way
+//   - Kernels, as B calls them on every state from D:
+//       repulsive_P   compute_repulsive_P(), walls and a scan of the obstacles
+//       best_dir8     best_dir8_for_vector() (independent of N)
+//       send_force    send_total_force_to_d() through the obstacle grid, to /dev/null
+//       send_field    the same through the cached repulsion field
+//       target_hits   check_target_hits() at positions clear of every target
+//                     (the usual tick: a hit happens on a few ticks only)
+//       spawn_check   pointgrid_any_within() at the spawn clearance (the
+//                     proximity test of every new obstacle / target)
+//   - Harness: warmup (WARMUP_SEC, which also sizes the batch), then `reps`
+//     timed batches of `calls` calls each; a batch lasts about BATCH_SEC so
+//     the clock reads cost nothing. ns/call is given per batch: median, p99
+//     and min over the batches (the spread is run-to-run noise, not the tail
+//     of single calls, which the clock cannot resolve)
+//   - The kernels run as built for arp1 (util.o has no -O): the numbers
+//     track what the program does, compare them between builds
+// Usage: ./util_bench [--csv] [--out FILE] [--tag TAG] [--reps N]
+//   --csv   CSV on stdout instead of the table
+//   --out   appends the CSV rows to FILE (header written when it is new)
+//   --tag   first CSV column, e.g. the commit (default: date and time)
+// ======================================================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "headers/util.h"
+#include "headers/params.h"
+#include "headers/obsgrid.h"
+#include "headers/repfield.h"
+#include "headers/pointgrid.h"
+#include "headers/targets.h"
+#include "headers/rng.h"
+#include "headers/blog.h"   // BLOG_REASON_STATE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define QUERIES     4096     // precomputed query points, cycled through
+#define WARMUP_SEC  0.02     // untimed calls before each kernel
+#define BATCH_SEC   1e-4     // target duration of one timed batch
+#define REPS        201      // timed batches (default of --reps)
+#define MISS_TRIES  4096     // draws per miss position before giving up
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// ---------------- Synthetic world ----------------
+typedef struct {
+    SimParams      p;
+    int            n;              // obstacles and targets
+    Obstacle      *obs;            // obs[0..n), all active
+    ObsGrid        grid;
+    RepField       field;
+    DroneStateMsg  q[QUERIES];     // drone states
+    double         vx[QUERIES], vy[QUERIES];   // repulsion vectors (best_dir8)
+    double         mx[QUERIES], my[QUERIES];   // positions clear of every target
+    int            n_miss;         // miss positions found (< QUERIES when crowded)
+    ForceLink      link;
+    ForceStateMsg  user;
+    volatile double sink;          // keeps the results alive
+} World;
+
+// Builds a world of n obstacles and n targets. Returns 0 or -1.
+// ----------------------------------------------------------------------
+static int world_build(World *w, int n, Rng *rng) {
+    double h = w->p.world_half;
+    w->n = n;
+
+    free(w->obs);
+    w->obs = malloc((size_t)(n > 0 ? n : 1) * sizeof(*w->obs));
+    if (!w->obs) return -1;
+    for (int k = 0; k < n; ++k) {
+        w->obs[k].x          = rng_range(rng, -h, h);
+        w->obs[k].y          = rng_range(rng, -h, h);
+        w->obs[k].active     = true;
+        w->obs[k].life_steps = 1000000;
+    }
+    if (obsgrid_build(&w->grid, w->obs, NULL, n, &w->p) == -1) return -1;
+
+    target_store_free();
+    if (target_store_init(n > 0 ? n : 1, h) == -1) return -1;
+    for (int k = 0; k < n; ++k) {
+        target_add(rng_range(rng, -h, h), rng_range(rng, -h, h), 1000000);
+    }
+
+    for (int i = 0; i < QUERIES; ++i) {
+        w->q[i] = (DroneStateMsg){ .x  = rng_range(rng, -h, h),     .y  = rng_range(rng, -h, h),
+                                   .vx = rng_range(rng, -1.0, 1.0), .vy = rng_range(rng, -1.0, 1.0) };
+        w->vx[i] = rng_range(rng, -100.0, 100.0);
+        w->vy[i] = rng_range(rng, -100.0, 100.0);
+    }
+
+    // Positions where check_target_hits() finds nothing
+    double r_hit = h * HIT_RADIUS_FACTOR;
+    w->n_miss = 0;
+    for (int i = 0; i < QUERIES; ++i) {
+        int t;
+        for (t = 0; t < MISS_TRIES; ++t) {
+            double x = rng_range(rng, -h, h), y = rng_range(rng, -h, h);
+            if (!pointgrid_any_within(&g_tgt_index, x, y, r_hit)) {
+                w->mx[w->n_miss] = x;
+                w->my[w->n_miss] = y;
+                w->n_miss++;
+                break;
+            }
+        }
+        if (t == MISS_TRIES) break;   // the hit disks cover the world
+    }
+    return 0;
+}
+
+// ---------------- Kernels ----------------
+// Each runs `calls` calls starting at query i0.
+typedef void (*KernelFn)(World *w, int i0, int calls);
+
+static void k_repulsive_P(World *w, int i0, int calls) {
+    double acc = 0.0;
+    for (int c = 0; c < calls; ++c) {
+        double Px, Py;
+        compute_repulsive_P(&w->q[(i0 + c) % QUERIES], &w->p, w->obs, w->n, true, true, &Px, &Py);
+        acc += Px + Py;
+    }
+    w->sink = acc;
+}
+
+static void k_best_dir8(World *w, int i0, int calls) {
+    int acc = 0;
+    for (int c = 0; c < calls; ++c) {
+        int i = (i0 + c) % QUERIES;
+        acc += best_dir8_for_vector(w->vx[i], w->vy[i]);
+    }
+    w->sink = acc;
+}
+
+static void send_force(World *w, int i0, int calls, RepField *field) {
+    for (int c = 0; c < calls; ++c) {
+        send_total_force_to_d(&w->user, &w->q[(i0 + c) % QUERIES], &w->p, w->obs, w->n,
+                              &w->grid, field, &w->link, BLOG_REASON_STATE);
+    }
+}
+
+static void k_send_force(World *w, int i0, int calls) {
+    send_force(w, i0, calls, NULL);
+}
+
+static void k_send_field(World *w, int i0, int calls) {
+    send_force(w, i0, calls, &w->field);
+}
+
+static void k_target_hits(World *w, int i0, int calls) {
+    int score = 0, collected = 0, last = -1;
+    for (int c = 0; c < calls; ++c) {
+        int i = (i0 + c) % w->n_miss;
+        DroneStateMsg s = { .x = w->mx[i], .y = w->my[i] };
+        check_target_hits(&s, &w->p, &score, &collected, &last, c);
+    }
+    w->sink = score;
+}
+
+static void k_spawn_check(World *w, int i0, int calls) {
+    double r   = w->p.world_half * SPAWN_CLEARANCE_FACTOR;
+    int    acc = 0;
+    for (int c = 0; c < calls; ++c) {
+        const DroneStateMsg *s = &w->q[(i0 + c) % QUERIES];
+        acc += pointgrid_any_within(&g_tgt_index, s->x, s->y, r);
+    }
+    w->sink = acc;
+}
+
+typedef struct {
+    const char *name;
+    KernelFn    fn;
+    bool        per_n;     // depends on the world size
+    bool        misses;    // needs miss positions
+} Kernel;
+
+static const Kernel g_kernels[] = {
+    { "repulsive_P", k_repulsive_P, true,  false },
+    { "best_dir8",   k_best_dir8,   false, false },
+    { "send_force",  k_send_force,  true,  false },
+    { "send_field",  k_send_field,  true,  false },
+    { "target_hits", k_target_hits, true,  true  },
+    { "spawn_check", k_spawn_check, true,  false },
+};
+
+// ---------------- Harness ----------------
+typedef struct {
+    int    calls;      // calls per batch
+    int    reps;       // batches
+    double median, p99, min, mean;   // ns per call
+} BenchResult;
+
+// Warms fn up, sizes the batch, then times `reps` batches.
+// ----------------------------------------------------------------------
+static void bench(const Kernel *k, World *w, int reps, double *samples, BenchResult *r) {
+    // First call alone: it may fill a cache (the field samples the grid)
+    k->fn(w, 0, 1);
+
+    // Warmup: doubling batches until WARMUP_SEC has passed (caches, branch
+    // predictors), timing the last one
+    int    calls = 1;
+    double dt    = 0.0;
+    double t_end = now_sec() + WARMUP_SEC;
+    for (;;) {
+        double t0 = now_sec();
+        k->fn(w, 0, calls);
+        dt = now_sec() - t0;
+        if (now_sec() >= t_end && dt >= BATCH_SEC / 4) break;
+        if (calls < (1 << 24)) calls *= 2;
+    }
+    double per_call = dt / calls;
+    calls = (int)(BATCH_SEC / (per_call > 1e-10 ? per_call : 1e-10)) + 1;
+
+    int i0 = 0;
+    for (int rep = 0; rep < reps; ++rep) {
+        double t0 = now_sec();
+        k->fn(w, i0, calls);
+        samples[rep] = 1e9 * (now_sec() - t0) / calls;
+        i0 = (i0 + calls) % QUERIES;
+    }
+
+    qsort(samples, (size_t)reps, sizeof(*samples), cmp_double);
+    double sum = 0.0;
+    for (int rep = 0; rep < reps; ++rep) sum += samples[rep];
+    int i99 = (int)(0.99 * (reps - 1) + 0.5);
+
+    r->calls  = calls;
+    r->reps   = reps;
+    r->median = samples[reps / 2];
+    r->p99    = samples[i99];
+    r->min    = samples[0];
+    r->mean   = sum / reps;
+}
+
+#define CSV_HEADER "tag,kernel,n,calls,reps,median_ns,p99_ns,min_ns,mean_ns\n"
+
+static void csv_row(FILE *out, const char *tag, const char *kernel, int n, const BenchResult *r) {
+    fprintf(out, "%s,%s,%d,%d,%d,%.2f,%.2f,%.2f,%.2f\n", tag, kernel, n,
+            r->calls, r->reps, r->median, r->p99, r->min, r->mean);
+}
+
+int main(int argc, char **argv) {
+    int         csv  = 0;
+    const char *out_path = NULL;
+    const char *tag  = NULL;
+    int         reps = REPS;
+    for (int i = 1; i < argc; ++i) {
+        if      (strcmp(argv[i], "--csv") == 0)                 csv = 1;
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)  out_path = argv[++i];
+        else if (strcmp(argv[i], "--tag") == 0 && i + 1 < argc)  tag = argv[++i];
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [--csv] [--out FILE] [--tag TAG] [--reps N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    char when[32];
+    if (!tag) {
+        time_t    t = time(NULL);
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", &tm);
+        tag = when;
+    }
+
+    FILE *out = NULL;
+    if (out_path) {
+        out = fopen(out_path, "a");
+        if (!out) {
+            perror("[BENCH] fopen --out");
+            return 1;
+        }
+        fseek(out, 0, SEEK_END);
+        if (ftell(out) == 0) fputs(CSV_HEADER, out);
+    }
+
+    static World w;
+    init_default_params(&w.p);
+    w.p.wall_gain = 100.0;   // params.txt value
+    obsgrid_init(&w.grid);
+    repfield_init(&w.field);
+    w.user.Fx = 1.0;
+    w.user.Fy = -2.0;
+    w.link.fd    = open("/dev/null", O_WRONLY);
+    w.link.mbox  = NULL;
+    w.link.latch = NULL;
+    if (w.link.fd == -1) {
+        perror("[BENCH] /dev/null");
+        return 1;
+    }
+
+    double *samples = malloc((size_t)reps * sizeof(*samples));
+    if (!samples) return 1;
+
+    Rng rng;
+    rng_seed(&rng, 12345, RNG_STREAM_BENCH);
+
+    const int sizes[]  = { 8, 32, 128, 512, 2048 };
+    const int nsizes   = (int)(sizeof(sizes) / sizeof(sizes[0]));
+    const int nkernels = (int)(sizeof(g_kernels) / sizeof(g_kernels[0]));
+
+    if (csv) {
+        fputs(CSV_HEADER, stdout);
+    } else {
+        printf("%d timed batches of ~%.0f us per kernel and size, after %.0f ms of warmup\n\n",
+               reps, BATCH_SEC * 1e6, WARMUP_SEC * 1e3);
+        printf("%-12s %6s %8s %10s %10s %10s\n", "kernel", "n", "calls", "median_ns", "p99_ns", "min_ns");
+    }
+
+    bool dir8_done = false;
+    for (int si = 0; si < nsizes; ++si) {
+        int n = sizes[si];
+        if (world_build(&w, n, &rng) == -1) {
+            fprintf(stderr, "[BENCH] out of memory at n=%d\n", n);
+            return 1;
+        }
+        for (int ki = 0; ki < nkernels; ++ki) {
+            const Kernel *k = &g_kernels[ki];
+            if (!k->per_n && dir8_done) continue;
+            if (k->misses && w.n_miss < QUERIES) {
+                if (!csv) printf("%-12s %6d   (skipped: the hit disks cover the world)\n", k->name, n);
+                continue;
+            }
+            BenchResult r;
+            bench(k, &w, reps, samples, &r);
+            int n_col = k->per_n ? n : 0;
+            if (!k->per_n) dir8_done = true;
+
+            if (csv) csv_row(stdout, tag, k->name, n_col, &r);
+            else     printf("%-12s %6d %8d %10.1f %10.1f %10.1f\n", k->name, n_col, r.calls,
+                            r.median, r.p99, r.min);
+            if (out) csv_row(out, tag, k->name, n_col, &r);
+        }
+        if (!csv) printf("\n");
+    }
+
+    if (out) {
+        fclose(out);
+        if (!csv) printf("results appended to %s (tag %s)\n", out_path, tag);
+    }
+    free(samples);
+    free(w.obs);
+    obsgrid_free(&w.grid);
+    repfield_free(&w.field);
+    target_store_free();
+    close(w.link.fd);
+    return 0;
+}
@@ -1,22 +1,27 @@
 // watchdog.c
-// Signal-based Watchdog (W)
+// Heartbeat-counter Watchdog (W)
 //
-// Heartbeat mechanism:
-//   - B sends SIGUSR1 to W whenever a new DroneStateMsg arrives.
-//   - W updates "last_beat_time" on SIGUSR1.
+// Heartbeat mechanism (heartbeat.h):
+//   - B, I, D, O and T each bump their own cache-line-padded counter in a
+//     shared segment (B once per DroneStateMsg it handles, D once per step,
+//     I, O and T at least every HB_IDLE_BEAT_NS while they wait).
+//   - W snapshots every counter on its own WD_POLL_NS timer; a counter that
+//     moved since the last snapshot is a heartbeat. No signal is sent per
+//     tick, so neither B nor W is interrupted on the hot path.
 //
 // Watchdog actions:
-//   - If no heartbeat for warn_sec: send SIGUSR2 to B (warning notification).
-//   - If no heartbeat for kill_sec: send SIGTERM to all processes (stop system).
-//
-// Why signals:
-//   - W is signal-based.
-//   - Heartbeat = "I'm alive" → classic SIGUSR1 usage.
+//   - B's counter is the heartbeat of the whole pipeline (it only moves
+//     while states flow from D):
+//       - no heartbeat for warn_sec: send SIGUSR2 to B (warning notification).
+//       - no heartbeat for kill_sec: send SIGTERM to all processes (stop system).
+//   - I, D, O and T, while they are watched: a stall of warn_sec and the
+//     recovery from it are written to the log, per process.
 
 #define _POSIX_C_SOURCE 200809L
 
 #include "headers/watchdog.h"
 #include "headers/util.h"   // die()
+#include "headers/blog.h"   // BLOG_ON
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,17 +31,16 @@
 #include <errno.h>
 #include <string.h>
 
-// Global/shared state inside watchdog process only
-static volatile sig_atomic_t g_got_beat = 0;
-
-// Store last heartbeat time (monotonic clock)
-static struct timespec g_last_beat_ts;
+// Period of the counter snapshots
+#define WD_POLL_NS 100000000ull   // 100 ms
 
-// Received heartbeat from B
-static void on_sigusr1(int signo) {
-    (void)signo;
-    g_got_beat = 1;
-}
+// What W knows about one counter.
+typedef struct {
+    uint64_t beats;      // value at the last change
+    double   t_beat;     // time of the last change (s)
+    int      watched;    // watched flag at the last snapshot
+    int      warned;     // stall already reported (cleared by the next beat)
+} HbView;
 
 // Helper: get monotonic time in seconds (double)
 static double now_monotonic_sec(void) {
@@ -45,12 +49,55 @@ static double now_monotonic_sec(void) {
     return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
 }
 
-// Helper: convert a timespec to seconds
-static double ts_to_sec(const struct timespec *ts) {
-    return (double)ts->tv_sec + (double)ts->tv_nsec * 1e-9;
+// Takes one snapshot of counter `who`. Returns 1 if it moved since the last one.
+// ----------------------------------------------------------------------
+static int hb_poll(HeartbeatBoard *hb, int who, HbView *v, double now) {
+    uint64_t beats = atomic_load_explicit(&hb->slot[who].beats, memory_order_relaxed);
+    if (beats == v->beats) return 0;
+    v->beats  = beats;
+    v->t_beat = now;
+    return 1;
+}
+
+// Reports stalls and recoveries of a watched process (I, D, O, T) to the log.
+// ----------------------------------------------------------------------
+static void check_process(FILE *log, HeartbeatBoard *hb, int who, HbView *v, double now,
+                          int warn_sec)
+{
+    int watched = (int)atomic_load_explicit(&hb->slot[who].watched, memory_order_acquire);
+    int moved   = hb_poll(hb, who, v, now);
+
+    if (watched != v->watched) {
+        if (log) {
+            fprintf(log, watched ? "[W] %s: watched (beats=%llu)\n"
+                                 : "[W] %s: stopped beating (exited, beats=%llu)\n",
+                    hb_name(who), (unsigned long long)v->beats);
+            fflush(log);
+        }
+        v->watched = watched;
+        v->t_beat  = now;
+        v->warned  = 0;
+        return;
+    }
+    if (!watched) return;
+
+    if (moved) {
+        if (v->warned && log) {
+            fprintf(log, "[W] %s: heartbeat resumed\n", hb_name(who));
+            fflush(log);
+        }
+        v->warned = 0;
+    } else if (!v->warned && now - v->t_beat >= (double)warn_sec) {
+        v->warned = 1;
+        if (log) {
+            fprintf(log, "[W] %s: no heartbeat for %.2f sec (beats=%llu)\n",
+                    hb_name(who), now - v->t_beat, (unsigned long long)v->beats);
+            fflush(log);
+        }
+    }
 }
 
-void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
+void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec, HeartbeatBoard *hb) {
     
     // 1) Open watchdog log file
     FILE *log = open_process_log("watchdog", "W");
@@ -80,38 +127,39 @@ void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
         fflush(log);
     }
 
-    // 3) Install signal handler for heartbeat (SIGUSR1)
-    struct sigaction sa; 
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = on_sigusr1; 
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART; // restart interrupted syscalls where possible
-
-    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
-        if (log) fprintf(log, "[W] sigaction(SIGUSR1) failed: %s\n", strerror(errno));
-        if (log) fclose(log);
-        exit(EXIT_FAILURE);
+    // 3) Starts every counter view from "now" (gives the system time to start)
+    HbView view[HB_COUNT];
+    double t0 = now_monotonic_sec();
+    for (int k = 0; k < HB_COUNT; ++k) {
+        view[k].beats   = atomic_load_explicit(&hb->slot[k].beats, memory_order_relaxed);
+        view[k].t_beat  = t0;
+        view[k].watched = 0;
+        view[k].warned  = 0;
     }
 
-    // Initialize last beat time to "now" (gives system time to start)
-    clock_gettime(CLOCK_MONOTONIC, &g_last_beat_ts);
-
-    // 4) Main loop: check heartbeat timing
+    // 4) Main loop: one snapshot of the counters per WD_POLL_NS (absolute deadlines)
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
     int warned = 0;
     while (1) {
-        // If we got heartbeat since last loop, update last_beat_ts
-        if (g_got_beat) {
-            g_got_beat = 0;
-            clock_gettime(CLOCK_MONOTONIC, &g_last_beat_ts);
+        double now = now_monotonic_sec();
+
+        // Per-process liveness of I, D, O and T (log only)
+        for (int k = 0; k < HB_COUNT; ++k) {
+            if (k != HB_B) check_process(log, hb, k, &view[k], now, warn_sec);
+        }
+
+        // B's counter moved since the last snapshot: heartbeat
+        if (hb_poll(hb, HB_B, &view[HB_B], now)) {
             warned = 0; // reset warning state once heartbeat resumes
         }
 
-        double elapsed = now_monotonic_sec() - ts_to_sec(&g_last_beat_ts);
+        double elapsed = now - view[HB_B].t_beat;
 
         // WARN stage: notify B (one-time per missing-heartbeat episode)
         if (!warned && elapsed >= (double)warn_sec) {
             warned = 1;
-            if (log) {
+            if (log && BLOG_ON(LOG_CAT_WATCHDOG, LOG_INFO)) {
                 fprintf(log, "[W] WARNING: no heartbeat for %.2f sec → SIGUSR2 to B\n", elapsed);
                 fflush(log);
             }
@@ -123,24 +171,32 @@ void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
         if (elapsed >= (double)kill_sec) {
             if (log) {
                 fprintf(log, "[W] TIMEOUT: no heartbeat for %.2f sec → stopping system (SIGTERM)\n", elapsed);
+                fprintf(log, "[W] beats: B=%llu I=%llu D=%llu O=%llu T=%llu\n",
+                        (unsigned long long)view[HB_B].beats, (unsigned long long)view[HB_I].beats,
+                        (unsigned long long)view[HB_D].beats, (unsigned long long)view[HB_O].beats,
+                        (unsigned long long)view[HB_T].beats);
                 fflush(log);
             }
 
             // Termination order: first tell B (so UI can exit), then the others active processes
+            // (O and T are not started in a replay: pid 0, which kill() must not see)
             kill(p.pid_B, SIGTERM);
             kill(p.pid_I, SIGTERM);
             kill(p.pid_D, SIGTERM);
-            kill(p.pid_O, SIGTERM);
-            kill(p.pid_T, SIGTERM);
+            if (p.pid_O > 0) kill(p.pid_O, SIGTERM);
+            if (p.pid_T > 0) kill(p.pid_T, SIGTERM);
 
             break;
         }
 
-        // Sleep a bit (low CPU usage)
-        struct timespec ts;
-        ts.tv_sec = 0;
-        ts.tv_nsec = 100 * 1000 * 1000; // 100 ms
-        nanosleep(&ts, NULL);
+        // Sleeps to the next snapshot time (low CPU usage, no drift)
+        next.tv_nsec += (long)WD_POLL_NS;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+        }
     }
 
     if (log) {